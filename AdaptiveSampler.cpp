@@ -0,0 +1,72 @@
+/*********************************************************************
+* AdaptiveSampler.cpp
+*
+* Description: Sampling interval driven by signal dynamics
+*
+* version :  V1.0
+* date    :  2026-10-19
+**********************************************************************/
+
+#include "AdaptiveSampler.h"
+
+AdaptiveSampler::AdaptiveSampler(const uint16_t *range)
+	: range(range), currentInterval(range[0]),
+	  lastAverage(0), noise(0), hold(ADAPTIVE_HOLD), primed(false) {}
+
+AdaptiveSampler::~AdaptiveSampler() {}
+
+//********************************************************************************************
+// function name: add ()
+// Function Description: Moves the interval according to the change of the window average
+//********************************************************************************************
+void AdaptiveSampler::add(int average, uint16_t spread)
+{
+	if (!this->primed)
+	{
+		this->primed = true;
+		this->lastAverage = average;
+		return;
+	}
+
+	// noise += (spread - noise) / 8, kept in Q4
+	this->noise = this->noise - (this->noise >> 3) + (spread << 1);
+
+	uint16_t change = abs(average - this->lastAverage);
+	this->lastAverage = average;
+
+	uint16_t minInterval = this->range[0];
+	uint16_t maxInterval = this->range[1];
+	this->currentInterval = interval(); // the range may have changed since the last window
+	if (change > ADAPTIVE_THRESHOLD + (this->noise >> 4))
+	{
+		this->currentInterval = minInterval;
+		this->hold = ADAPTIVE_HOLD;
+	}
+	else if (this->hold > 0)
+	{
+		this->hold--;
+	}
+	else if (this->currentInterval < maxInterval)
+	{
+		uint16_t step = (this->currentInterval >> 2) + 1;
+		if (maxInterval - this->currentInterval < step)
+			step = maxInterval - this->currentInterval;
+		this->currentInterval += step;
+	}
+}
+
+uint16_t AdaptiveSampler::interval()
+{
+	if (this->currentInterval < this->range[0])
+		return this->range[0];
+	if (this->currentInterval > this->range[1])
+		return this->range[1];
+	return this->currentInterval;
+}
+
+SamplingState AdaptiveSampler::state()
+{
+	if (this->hold > 0)
+		return SAMPLING_BURST;
+	return interval() < this->range[1] ? SAMPLING_TRACKING : SAMPLING_STABLE;
+}
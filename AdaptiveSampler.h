@@ -0,0 +1,51 @@
+/*********************************************************************
+* AdaptiveSampler.h
+*
+* Description: Adapts the sampling interval of an analog channel to
+* the signal. The driver feeds the average and spread (max - min) of
+* every completed averaging window. A move of the average beyond the
+* usual spread plus ADAPTIVE_THRESHOLD is taken as a change (dosing,
+* refill, probe moved) and drops the interval to the minimum for
+* ADAPTIVE_HOLD windows. While the signal stays put the interval grows
+* by a quarter per window up to the maximum. Minimum and maximum are
+* read from the interval table on every use, so a SET applies at once.
+*
+* version :  V1.0
+* date    :  2026-10-19
+**********************************************************************/
+
+#pragma once
+#include <Arduino.h>
+#include "config.h"
+
+// ordered so that the most active channel wins, see GravitySensorHub::samplingState()
+enum SamplingState
+{
+	SAMPLING_STABLE = 0, // interval at its maximum
+	SAMPLING_TRACKING,	 // backing off after a change
+	SAMPLING_BURST		 // change detected, interval at its minimum
+};
+
+class AdaptiveSampler
+{
+public:
+	// range points at the minimum and maximum interval in ms, see IntervalConfig
+	AdaptiveSampler(const uint16_t *range);
+	~AdaptiveSampler();
+
+	// feed the average and spread of a completed window, in ADC counts
+	void add(int average, uint16_t spread);
+
+	// ms until the next sample
+	uint16_t interval();
+
+	SamplingState state();
+
+private:
+	const uint16_t *range;
+	uint16_t currentInterval;
+	int lastAverage;
+	uint16_t noise; // moving average of the window spread, Q4
+	uint8_t hold;	// windows left at the minimum interval
+	bool primed;	// lastAverage is valid
+};
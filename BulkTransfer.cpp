@@ -0,0 +1,209 @@
+/*********************************************************************
+* BulkTransfer.cpp
+*
+* Description: Windowed download of SD card files over serial
+*
+* version :  V1.0
+* date    :  2026-10-19
+**********************************************************************/
+
+#include "BulkTransfer.h"
+
+#if ENABLE_BULK
+
+#include "Telemetry.h"
+#include "Crc.h"
+
+BulkTransfer::BulkTransfer() : blocksSent(0), blocksResent(0), directory(NULL), state(BULK_IDLE), size(0), first(0),
+							   acked(0), next(0), rejects(0), heardTime(0), progressTime(0) {}
+
+BulkTransfer::~BulkTransfer() {}
+
+void BulkTransfer::setup(SdFile *directory)
+{
+	this->directory = directory;
+}
+
+//********************************************************************************************
+// function name: update ()
+// Function Description: Sends a rejected block, else the next block inside the window. Goes
+// back to the acknowledged offset when the receiver stops making progress and gives the link
+// back when it went quiet.
+//********************************************************************************************
+void BulkTransfer::update()
+{
+	if (this->state == BULK_IDLE)
+		return;
+	if (millis() - this->heardTime > BULK_TIMEOUT)
+	{
+		end();
+		return;
+	}
+	if (this->state != BULK_SENDING)
+		return;
+
+	if (this->acked >= this->size)
+	{
+		telemetry.print(F("BULKEND@"));
+		telemetry.println(this->size);
+		finish();
+		return;
+	}
+	if (this->next > this->acked && millis() - this->progressTime > BULK_RETRY)
+	{
+		this->next = this->acked; // the tail of the window got lost
+		this->rejects = 0;
+		this->progressTime = millis();
+	}
+	if (!telemetry.beginFrame(BULK_FRAME_RESERVE))
+		return;
+
+	if (this->rejects > 0)
+	{
+		sendBlock(this->rejected[0]);
+		this->rejects--;
+		memmove(this->rejected, this->rejected + 1, this->rejects * sizeof(this->rejected[0]));
+		this->blocksResent++;
+	}
+	else if (this->next < this->size && this->next < this->acked + (unsigned long)BULK_WINDOW * BULK_BLOCK)
+	{
+		if (this->next < this->acked)
+			this->next = this->acked;
+		sendBlock(this->next);
+		this->next += BULK_BLOCK;
+		this->blocksSent++;
+	}
+}
+
+//********************************************************************************************
+// function name: start ()
+// Function Description: Opens a file and announces it, the first BULK of a session switches
+// the link to BULK_BAUD once the announcement is out
+//********************************************************************************************
+void BulkTransfer::start(const char *name, unsigned long offset)
+{
+	if (this->file.isOpen())
+		this->file.close();
+	if (name[0] == '\0')
+	{
+		end();
+		return;
+	}
+	if (!openFile(name))
+	{
+		telemetry.print(F("BULKERR@"));
+		telemetry.println(name);
+		return;
+	}
+	this->size = this->file.fileSize();
+	this->first = this->acked = this->next = offset < this->size ? offset : this->size;
+	this->rejects = 0;
+	this->heardTime = this->progressTime = millis();
+
+	telemetry.print(F("BULK@"));
+	telemetry.print(name);
+	telemetry.print(',');
+	telemetry.print(this->size);
+	telemetry.print(',');
+	telemetry.print(this->acked);
+	telemetry.print(',');
+	telemetry.println(BULK_BAUD);
+	if (this->state == BULK_IDLE)
+		telemetry.setBaud(BULK_BAUD);
+	this->state = BULK_WAITING;
+}
+
+bool BulkTransfer::openFile(const char *name)
+{
+	if (this->directory == NULL)
+		return false;
+	const char *slash = strchr(name, '/');
+	if (slash == NULL)
+		return this->file.open(this->directory, name, O_READ);
+	char folderName[13];
+	SdFile folder;
+	uint8_t length = slash - name;
+	if (length >= sizeof(folderName))
+		return false;
+	memcpy(folderName, name, length);
+	folderName[length] = '\0';
+	return folder.open(this->directory, folderName, O_READ) && this->file.open(&folder, slash + 1, O_READ);
+}
+
+void BulkTransfer::acknowledge(unsigned long offset)
+{
+	if (this->state == BULK_IDLE)
+		return;
+	this->heardTime = millis();
+	if (this->state == BULK_WAITING)
+		this->state = BULK_SENDING; // the receiver is listening at the new rate
+	if (this->state != BULK_SENDING || offset <= this->acked)
+		return;
+	this->acked = offset < this->size ? offset : this->size;
+	this->progressTime = millis();
+	// rejected blocks that arrived in the meantime
+	uint8_t kept = 0;
+	for (uint8_t i = 0; i < this->rejects; i++)
+	{
+		if (this->rejected[i] + BULK_BLOCK > this->acked)
+			this->rejected[kept++] = this->rejected[i];
+	}
+	this->rejects = kept;
+}
+
+void BulkTransfer::reject(unsigned long offset)
+{
+	if (this->state == BULK_IDLE)
+		return;
+	this->heardTime = millis();
+	if (this->state != BULK_SENDING || offset < this->acked || offset >= this->next || this->rejects >= BULK_NAKS)
+		return; // a full list is recovered by the timeout
+	offset -= (offset - this->first) % BULK_BLOCK;
+	for (uint8_t i = 0; i < this->rejects; i++)
+	{
+		if (this->rejected[i] == offset)
+			return;
+	}
+	this->rejected[this->rejects++] = offset;
+}
+
+bool BulkTransfer::active()
+{
+	return this->state != BULK_IDLE;
+}
+
+void BulkTransfer::sendBlock(unsigned long offset)
+{
+	uint8_t block[BULK_BLOCK];
+	int16_t length = this->file.seekSet(offset) ? this->file.read(block, BULK_BLOCK) : -1;
+	if (length < 0)
+		length = 0;
+	uint16_t crc = crc16(block, length);
+	telemetry.print(F("BLK@"));
+	telemetry.print(offset);
+	telemetry.print(',');
+	telemetry.printBase64(block, length);
+	telemetry.print(',');
+	for (int8_t shift = 12; shift >= 0; shift -= 4)
+	{
+		telemetry.print("0123456789ABCDEF"[(crc >> shift) & 0xF]);
+	}
+	telemetry.println();
+}
+
+void BulkTransfer::finish()
+{
+	this->file.close();
+	this->state = BULK_SESSION;
+}
+
+void BulkTransfer::end()
+{
+	if (this->file.isOpen())
+		this->file.close();
+	if (this->state != BULK_IDLE)
+		telemetry.setBaud(SERIAL_BAUD);
+	this->state = BULK_IDLE;
+}
+
+#endif
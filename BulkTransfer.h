@@ -0,0 +1,103 @@
+/*********************************************************************
+* BulkTransfer.h
+*
+* Description: Download of files from the SD card over the serial
+* link. "BULK name offset" (offset defaults to 0, name is a file of the
+* root or of a month directory, e.g. "2609/26092100.BIN") answers with
+* "BULK@name,size,offset,baud" at the normal rate, then switches the
+* UART to BULK_BAUD. The receiver follows and confirms the new rate
+* with "BACK offset", until then nothing is sent and after BULK_TIMEOUT
+* ms the node goes back to SERIAL_BAUD.
+*
+* The file is sent in blocks of BULK_BLOCK bytes:
+* "BLK@offset,<base64>,crc" with the CRC16 of the block in hex. At most
+* BULK_WINDOW blocks are in flight beyond the acknowledged offset.
+* "BACK offset" acknowledges every byte before offset, "BNAK offset"
+* asks for one block again, it goes out before any new block. Without
+* progress for BULK_RETRY ms the node goes back to the acknowledged
+* offset. Blocks are read back from the card, so a retransmit costs no
+* RAM. "BULKEND@size" ends a file, the link stays at BULK_BAUD for
+* the next BULK command until BULK_TIMEOUT ms pass without a command or
+* "BULK" comes without a name.
+*
+* Nothing is kept across a disconnect: the receiver resumes with
+* "BULK name offset" from the offset it holds. tools/bulk_download.py
+* is the receiver.
+*
+* version :  V1.0
+* date    :  2026-10-19
+**********************************************************************/
+
+#pragma once
+#include <Arduino.h>
+#include "config.h"
+
+#if ENABLE_BULK
+#include <SD.h>
+
+// "BLK@" offset "," base64 "," crc "\r\n"
+#define BULK_FRAME_RESERVE (4 + 10 + 1 + (BULK_BLOCK * 4 + 2) / 3 + 1 + 4 + 2)
+
+enum BulkState
+{
+	BULK_IDLE = 0, // link at SERIAL_BAUD
+	BULK_WAITING,  // link at BULK_BAUD, waiting for the first BACK
+	BULK_SENDING,  // blocks of the file going out
+	BULK_SESSION   // file done, link still at BULK_BAUD
+};
+
+class BulkTransfer
+{
+public:
+	// counters since boot
+	unsigned long blocksSent;	// blocks sent for the first time
+	unsigned long blocksResent; // blocks sent again after BNAK or a timeout
+
+public:
+	BulkTransfer();
+	~BulkTransfer();
+
+	// files are opened in directory, NULL without a card
+	void setup(SdFile *directory);
+
+	// switch the rate and send the next block
+	void update();
+
+	// start sending a file from offset, an empty name ends the session
+	void start(const char *name, unsigned long offset);
+
+	// every byte before offset arrived
+	void acknowledge(unsigned long offset);
+
+	// the block at offset has to be sent again
+	void reject(unsigned long offset);
+
+	// a session holds the link at BULK_BAUD
+	bool active();
+
+private:
+	SdFile *directory;
+	SdFile file;
+	BulkState state;
+	unsigned long size;
+	unsigned long first; // offset the file was started from, blocks are aligned to it
+	unsigned long acked; // every byte before it arrived
+	unsigned long next;	 // next block not sent yet
+	unsigned long rejected[BULK_NAKS];
+	uint8_t rejects;
+	unsigned long heardTime;	// last command of the receiver
+	unsigned long progressTime; // last time acked moved
+
+	// open name, which may be in a directory of the root
+	bool openFile(const char *name);
+	// send the block at offset
+	void sendBlock(unsigned long offset);
+	// close the file, the link stays at BULK_BAUD
+	void finish();
+	// back to SERIAL_BAUD
+	void end();
+};
+
+extern BulkTransfer bulkTransfer;
+
+#endif // ENABLE_BULK
@@ -0,0 +1,303 @@
+/*********************************************************************
+* CalibrationStore.cpp
+*
+* Description: Versioned, CRC protected calibration records in EEPROM
+*
+* version :  V1.0
+* date    :  2026-10-19
+**********************************************************************/
+
+#include "CalibrationStore.h"
+#include "Crc.h"
+#include <EEPROM.h>
+
+// addresses used before the store existed, read once to migrate old calibrations
+#define LEGACY_PH_NEUTRAL_ADDR 0x00
+#define LEGACY_PH_ACID_ADDR 0x04
+#define LEGACY_EC_FACTOR_ADDR 0x08
+#define LEGACY_TDS_KVALUE_ADDR 0x10
+
+static_assert(sizeof(PhCalibration) <= CALIBRATION_MAX_PAYLOAD, "PhCalibration too large");
+static_assert(sizeof(EcCalibration) <= CALIBRATION_MAX_PAYLOAD, "EcCalibration too large");
+static_assert(sizeof(TdsCalibration) <= CALIBRATION_MAX_PAYLOAD, "TdsCalibration too large");
+static_assert(sizeof(IntervalConfig) <= CALIBRATION_MAX_PAYLOAD, "IntervalConfig too large");
+
+// SET names of the intervals, by IntervalId
+static const char intervalNames[INTERVAL_COUNT][7] PROGMEM = {
+	"PHMIN", "PHMAX", "ORPMIN", "ORPMAX", "ECMIN", "ECMAX", "TDSMIN", "TDSMAX",
+	"TEMP", "REPORT", "BURST", "STABLE", "SDLOG"};
+
+CalibrationStore::CalibrationStore() : validMask(0)
+{
+	for (byte id = 0; id < CAL_COUNT; id++)
+	{
+		this->sequence[id] = 0;
+		this->crc[id] = 0;
+		this->slot[id] = CALIBRATION_SLOTS - 1;
+		loadDefaults(id);
+	}
+}
+
+CalibrationStore::~CalibrationStore() {}
+
+//********************************************************************************************
+// function name: setup ()
+// Function Description: Loads the newest valid slot of every record into RAM.
+// Records without a valid slot are migrated from the legacy addresses or keep their defaults.
+//********************************************************************************************
+void CalibrationStore::setup()
+{
+	uint8_t payload[CALIBRATION_MAX_PAYLOAD];
+	SlotHeader header;
+	uint16_t slotCrc;
+
+	for (byte id = 0; id < CAL_COUNT; id++)
+	{
+		uint8_t size;
+		void *data = recordData(id, size);
+
+		for (uint8_t i = 0; i < CALIBRATION_SLOTS; i++)
+		{
+			if (!readSlot(id, i, payload, header, slotCrc))
+				continue;
+			if ((this->validMask & (1 << id)) && (int16_t)(header.sequence - this->sequence[id]) <= 0)
+				continue;
+			memcpy(data, payload, size);
+			this->sequence[id] = header.sequence;
+			this->crc[id] = slotCrc;
+			this->slot[id] = i;
+			this->validMask |= (1 << id);
+		}
+
+		if (!(this->validMask & (1 << id)) && loadLegacy(id))
+		{
+			save(id);
+		}
+	}
+}
+
+//********************************************************************************************
+// function name: save ()
+// Function Description: Writes a record into the slot after the newest one.
+// Nothing is written when the record did not change.
+// Return Value: false if id is unknown
+//********************************************************************************************
+bool CalibrationStore::save(byte id)
+{
+	if (id >= CAL_COUNT)
+		return false;
+
+	uint8_t size;
+	const uint8_t *data = (const uint8_t *)recordData(id, size);
+
+	SlotHeader header;
+	header.version = CALIBRATION_VERSION;
+	header.id = id;
+	header.sequence = this->sequence[id] + 1;
+
+	// the sequence is part of the crc, so compare the payload with the stored one first
+	SlotHeader current = header;
+	current.sequence = this->sequence[id];
+	uint16_t currentCrc = crc16(data, size, crc16(&current, sizeof(current)));
+	if ((this->validMask & (1 << id)) && currentCrc == this->crc[id])
+		return true;
+
+	uint8_t index = (this->slot[id] + 1) % CALIBRATION_SLOTS;
+	uint16_t slotCrc = crc16(data, size, crc16(&header, sizeof(header)));
+	int address = slotAddress(id, index);
+
+	const uint8_t *p = (const uint8_t *)&header;
+	for (uint8_t i = 0; i < sizeof(header); i++)
+		EEPROM.update(address++, p[i]);
+	for (uint8_t i = 0; i < size; i++)
+		EEPROM.update(address++, data[i]);
+	EEPROM.update(address++, slotCrc & 0xFF);
+	EEPROM.update(address, slotCrc >> 8);
+
+	this->sequence[id] = header.sequence;
+	this->crc[id] = slotCrc;
+	this->slot[id] = index;
+	this->validMask |= (1 << id);
+	return true;
+}
+
+//********************************************************************************************
+// function name: setInterval ()
+// Function Description: Changes one entry of the interval table and saves the table
+// Parameters: name  SET name of the entry, see IntervalId
+// Return Value: false for an unknown name, 0, or a minimum above the maximum of its pair
+//********************************************************************************************
+bool CalibrationStore::setInterval(const char *name, uint16_t value)
+{
+	byte id = 0;
+	while (id < INTERVAL_COUNT && strcmp_P(name, intervalNames[id]) != 0)
+		id++;
+	if (id == INTERVAL_COUNT || value == 0)
+		return false;
+	if (id < INTERVAL_TEMPERATURE)
+	{
+		byte pair = id & ~1;
+		uint16_t minimum = id == pair ? value : this->intervals.value[pair];
+		uint16_t maximum = id == pair ? this->intervals.value[pair + 1] : value;
+		if (minimum > maximum)
+			return false;
+	}
+	this->intervals.value[id] = value;
+	return save(CAL_INTERVALS);
+}
+
+//********************************************************************************************
+// function name: recordData ()
+// Function Description: Returns the RAM copy of a record and its size
+//********************************************************************************************
+void *CalibrationStore::recordData(byte id, uint8_t &size)
+{
+	switch (id)
+	{
+	case CAL_PH:
+		size = sizeof(this->ph);
+		return &this->ph;
+	case CAL_EC:
+		size = sizeof(this->ec);
+		return &this->ec;
+	case CAL_INTERVALS:
+		size = sizeof(this->intervals);
+		return &this->intervals;
+	default:
+		size = sizeof(this->tds);
+		return &this->tds;
+	}
+}
+
+//********************************************************************************************
+// function name: slotAddress ()
+// Function Description: EEPROM address of a slot, records are laid out back to back
+//********************************************************************************************
+int CalibrationStore::slotAddress(byte id, uint8_t index)
+{
+	int address = CALIBRATION_EEPROM_BASE;
+	uint8_t size;
+	for (byte i = 0; i < id; i++)
+	{
+		recordData(i, size);
+		address += CALIBRATION_SLOTS * (sizeof(SlotHeader) + size + 2);
+	}
+	recordData(id, size);
+	return address + index * (sizeof(SlotHeader) + size + 2);
+}
+
+//********************************************************************************************
+// function name: readSlot ()
+// Function Description: Reads one slot, checks version, id and crc
+// Return Value: true if the slot holds a valid record
+//********************************************************************************************
+bool CalibrationStore::readSlot(byte id, uint8_t index, uint8_t *payload, SlotHeader &header, uint16_t &slotCrc)
+{
+	uint8_t size;
+	recordData(id, size);
+	int address = slotAddress(id, index);
+
+	uint8_t *p = (uint8_t *)&header;
+	for (uint8_t i = 0; i < sizeof(header); i++)
+		p[i] = EEPROM.read(address++);
+	if (header.version != CALIBRATION_VERSION || header.id != id)
+		return false;
+
+	for (uint8_t i = 0; i < size; i++)
+		payload[i] = EEPROM.read(address++);
+	uint16_t storedCrc = EEPROM.read(address) | (EEPROM.read(address + 1) << 8);
+
+	slotCrc = crc16(payload, size, crc16(&header, sizeof(header)));
+	return slotCrc == storedCrc;
+}
+
+//********************************************************************************************
+// function name: loadDefaults ()
+// Function Description: Typical values of a new probe
+//********************************************************************************************
+void CalibrationStore::loadDefaults(byte id)
+{
+	switch (id)
+	{
+	case CAL_PH:
+		this->ph.neutralVoltage = 2.0; //buffer solution 7.0 at 25C
+		this->ph.acidVoltage = 1.14;   //buffer solution 4.0 at 25C
+		break;
+	case CAL_EC:
+		this->ec.compensationFactor = 1.0;
+		break;
+	case CAL_TDS:
+		this->tds.kValue = 1.0;
+		break;
+	case CAL_INTERVALS:
+		this->intervals.value[INTERVAL_PH_MIN] = PH_SAMPLE_MIN;
+		this->intervals.value[INTERVAL_PH_MAX] = PH_SAMPLE_MAX;
+		this->intervals.value[INTERVAL_ORP_MIN] = ORP_SAMPLE_MIN;
+		this->intervals.value[INTERVAL_ORP_MAX] = ORP_SAMPLE_MAX;
+		this->intervals.value[INTERVAL_EC_MIN] = EC_SAMPLE_MIN;
+		this->intervals.value[INTERVAL_EC_MAX] = EC_SAMPLE_MAX;
+		this->intervals.value[INTERVAL_TDS_MIN] = TDS_SAMPLE_MIN;
+		this->intervals.value[INTERVAL_TDS_MAX] = TDS_SAMPLE_MAX;
+		this->intervals.value[INTERVAL_TEMPERATURE] = TEMP_SAMPLE_INTERVAL;
+		this->intervals.value[INTERVAL_REPORT] = REPORT_INTERVAL;
+		this->intervals.value[INTERVAL_REPORT_BURST] = REPORT_INTERVAL_BURST;
+		this->intervals.value[INTERVAL_REPORT_STABLE] = REPORT_INTERVAL_STABLE;
+		this->intervals.value[INTERVAL_SD_LOG] = SD_LOG_INTERVAL;
+		break;
+	}
+}
+
+//********************************************************************************************
+// function name: loadLegacy ()
+// Function Description: Imports a calibration written by the old per-driver EEPROM code
+// Return Value: true if at least one legacy value was found
+//********************************************************************************************
+bool CalibrationStore::loadLegacy(byte id)
+{
+	float value;
+	bool found = false;
+	switch (id)
+	{
+	case CAL_PH:
+		if (readLegacyFloat(LEGACY_PH_NEUTRAL_ADDR, value))
+		{
+			this->ph.neutralVoltage = value;
+			found = true;
+		}
+		if (readLegacyFloat(LEGACY_PH_ACID_ADDR, value))
+		{
+			this->ph.acidVoltage = value;
+			found = true;
+		}
+		break;
+	case CAL_EC:
+		if (readLegacyFloat(LEGACY_EC_FACTOR_ADDR, value))
+		{
+			this->ec.compensationFactor = value;
+			found = true;
+		}
+		break;
+	case CAL_TDS:
+		if (readLegacyFloat(LEGACY_TDS_KVALUE_ADDR, value))
+		{
+			this->tds.kValue = value;
+			found = true;
+		}
+		break;
+	}
+	return found;
+}
+
+bool CalibrationStore::readLegacyFloat(int address, float &value)
+{
+	float legacy;
+	uint8_t *p = (uint8_t *)&legacy;
+	for (uint8_t i = 0; i < sizeof(legacy); i++)
+		p[i] = EEPROM.read(address + i);
+
+	// a new EEPROM reads back 0xFF, which is a NaN
+	if (isnan(legacy) || isinf(legacy) || legacy <= 0)
+		return false;
+	value = legacy;
+	return true;
+}
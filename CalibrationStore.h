@@ -0,0 +1,130 @@
+/*********************************************************************
+* CalibrationStore.h
+*
+* Description: One place for every calibration value kept in EEPROM.
+* Each sensor owns a packed record protected by a version byte and a
+* CRC-16. Records are loaded into RAM once in setup(), drivers read the
+* RAM copy and call save() after a calibration to write it back.
+*
+* CAL_INTERVALS holds the sampling, report and SD intervals. Their
+* users read the RAM copy on every use, so "SET name value" takes
+* effect at once and is kept across resets, see setInterval(). "CONFIG"
+* prints the table as "CFG@v0,v1,..." in IntervalId order.
+*
+* EEPROM layout, starting at CALIBRATION_EEPROM_BASE:
+*   [CAL_PH  slot 0..CALIBRATION_SLOTS-1][CAL_EC slots][CAL_TDS slots]
+*   [CAL_INTERVALS slots]
+* slot = version(1) id(1) sequence(2) payload(n) crc16(2)
+* save() writes the slot after the newest one, so writes rotate through
+* the slots, and only bytes that differ are written (EEPROM.update).
+*
+* version :  V1.0
+* date    :  2026-10-19
+**********************************************************************/
+
+#pragma once
+#include <Arduino.h>
+#include "config.h"
+
+// bump when a record layout changes, records of another version fall back to defaults
+#define CALIBRATION_VERSION 1
+
+// largest payload of any record
+#define CALIBRATION_MAX_PAYLOAD 32
+
+enum CalibrationId
+{
+	CAL_PH = 0,
+	CAL_EC,
+	CAL_TDS,
+	CAL_INTERVALS,
+	CAL_COUNT
+};
+
+// entries of IntervalConfig with their SET name, defaults in config.h:
+// PHMIN, PHMAX, ORPMIN, ORPMAX, ECMIN, ECMAX, TDSMIN, TDSMAX : AdaptiveSampler range in ms
+// TEMP                                                       : ms between temperature readings
+// REPORT, BURST, STABLE                                      : ms between report frames
+// SDLOG                                                      : s between SD rows
+enum IntervalId
+{
+	INTERVAL_PH_MIN = 0,
+	INTERVAL_PH_MAX,
+	INTERVAL_ORP_MIN,
+	INTERVAL_ORP_MAX,
+	INTERVAL_EC_MIN,
+	INTERVAL_EC_MAX,
+	INTERVAL_TDS_MIN,
+	INTERVAL_TDS_MAX,
+	INTERVAL_TEMPERATURE,
+	INTERVAL_REPORT,
+	INTERVAL_REPORT_BURST,
+	INTERVAL_REPORT_STABLE,
+	INTERVAL_SD_LOG,
+	INTERVAL_COUNT
+};
+
+struct PhCalibration
+{
+	float neutralVoltage; // probe voltage in the 7.0 buffer solution
+	float acidVoltage;	  // probe voltage in the 4.0 buffer solution
+} __attribute__((packed));
+
+struct EcCalibration
+{
+	float compensationFactor;
+} __attribute__((packed));
+
+struct TdsCalibration
+{
+	float kValue;
+} __attribute__((packed));
+
+struct IntervalConfig
+{
+	uint16_t value[INTERVAL_COUNT]; // by IntervalId, a min and max pair starts at an even id
+} __attribute__((packed));
+
+class CalibrationStore
+{
+public:
+	PhCalibration ph;
+	EcCalibration ec;
+	TdsCalibration tds;
+	IntervalConfig intervals;
+
+public:
+	CalibrationStore();
+	~CalibrationStore();
+
+	// load every record from EEPROM into RAM
+	void setup();
+
+	// write the RAM copy of a record back to EEPROM
+	bool save(byte id);
+
+	// change and save the interval with the given SET name
+	bool setInterval(const char *name, uint16_t value);
+
+private:
+	struct SlotHeader
+	{
+		uint8_t version;
+		uint8_t id;
+		uint16_t sequence;
+	} __attribute__((packed));
+
+	uint16_t sequence[CAL_COUNT]; // sequence number of the newest slot
+	uint16_t crc[CAL_COUNT];	  // crc of the newest slot, used to skip unchanged saves
+	uint8_t slot[CAL_COUNT];	  // index of the newest slot
+	uint8_t validMask;			  // bit set when a record has a valid slot
+
+	void *recordData(byte id, uint8_t &size);
+	int slotAddress(byte id, uint8_t index);
+	bool readSlot(byte id, uint8_t index, uint8_t *payload, SlotHeader &header, uint16_t &slotCrc);
+	void loadDefaults(byte id);
+	bool loadLegacy(byte id);
+	bool readLegacyFloat(int address, float &value);
+};
+
+extern CalibrationStore calibrationStore;
@@ -0,0 +1,77 @@
+/*********************************************************************
+* ConductivityTables.h
+*
+* Description: Lookup tables for GravityEc and GravityTDS and the
+* temperature compensation tables used by GravityTemperature.
+* Generated by tools/gen_conductivity_tables.py, do not edit.
+**********************************************************************/
+
+#pragma once
+#include <Arduino.h>
+#include <avr/pgmspace.h>
+
+// curves are indexed by ADC code in steps of 2^CONDUCTIVITY_CODE_STEP_SHIFT
+#define CONDUCTIVITY_CODE_STEP_SHIFT 4
+#define CONDUCTIVITY_CODE_ENTRIES 65
+
+// compensation tables start at TEMP_COMP_MIN C, one entry per C, Q14 reciprocals
+#define TEMP_COMP_MIN 0
+#define TEMP_COMP_ENTRIES 51
+#define TEMP_COMP_FRAC_SHIFT 4
+#define TEMP_COMP_SHIFT 14
+
+// valid EC input range (150 mV .. 3300 mV) as compensated ADC code in Q14
+#define EC_LUT_MIN_INPUT 503316UL
+#define EC_LUT_MAX_INPUT 11072962UL
+
+// EC in us/cm at 25 C by ADC code
+static const uint16_t ecCurveTable[] PROGMEM = {
+	0, 470, 1004, 1539, 2073, 2608, 3145, 3690, 4236, 4781,
+	5326, 5871, 6417, 6962, 7507, 8053, 8598, 9143, 9689, 10145,
+	10559, 10973, 11387, 11801, 12216, 12630, 13044, 13458, 13872, 14286,
+	14700, 15114, 15528, 15942, 16356, 16770, 17184, 17598, 18012, 18426,
+	18840, 19255, 19669, 20083, 20497, 20911, 21325, 21739, 22153, 22567,
+	22981, 23395, 23809, 24223, 24637, 25051, 25466, 25880, 26294, 26708,
+	27122, 27536, 27950, 28364, 28778,
+};
+
+// EC in us/cm before compensation and k value by ADC code
+static const uint16_t tdsCurveTable[] PROGMEM = {
+	0, 65, 128, 189, 247, 304, 359, 414, 468, 523,
+	577, 633, 689, 747, 806, 868, 933, 1000, 1071, 1145,
+	1224, 1307, 1395, 1489, 1588, 1693, 1804, 1922, 2048, 2181,
+	2322, 2471, 2629, 2796, 2973, 3159, 3356, 3563, 3781, 4011,
+	4252, 4506, 4772, 5051, 5343, 5649, 5969, 6304, 6653, 7017,
+	7398, 7794, 8206, 8635, 9081, 9545, 10026, 10526, 11045, 11582,
+	12139, 12716, 13312, 13930, 14568,
+};
+
+// 1 / (1 + 0.0185 * (T - 25)) by temperature
+static const uint16_t ecCompensationTable[] PROGMEM = {
+	30482, 29468, 28519, 27629, 26793, 26006, 25264, 24564, 23901, 23273,
+	22677, 22111, 21572, 21059, 20570, 20103, 19657, 19230, 18821, 18430,
+	18054, 17693, 17347, 17013, 16693, 16384, 16086, 15799, 15523, 15255,
+	14997, 14747, 14506, 14272, 14045, 13826, 13614, 13408, 13208, 13014,
+	12825, 12642, 12464, 12291, 12123, 11959, 11800, 11645, 11494, 11346,
+	11203,
+};
+
+// 1 / (1 + 0.02 * (T - 25)) by temperature
+static const uint16_t tdsCompensationTable[] PROGMEM = {
+	32768, 31508, 30341, 29257, 28248, 27307, 26426, 25600, 24824, 24094,
+	23406, 22756, 22141, 21558, 21005, 20480, 19980, 19505, 19051, 18618,
+	18204, 17809, 17430, 17067, 16718, 16384, 16063, 15754, 15457, 15170,
+	14895, 14629, 14372, 14124, 13885, 13653, 13430, 13213, 13003, 12800,
+	12603, 12412, 12227, 12047, 11872, 11703, 11538, 11378, 11222, 11070,
+	10923,
+};
+
+// 298.15 / (T + 273.15) by temperature
+static const uint16_t nernstCompensationTable[] PROGMEM = {
+	17884, 17818, 17754, 17689, 17625, 17562, 17499, 17437, 17375, 17313,
+	17252, 17191, 17131, 17071, 17012, 16953, 16894, 16836, 16778, 16720,
+	16663, 16607, 16551, 16495, 16439, 16384, 16329, 16275, 16221, 16167,
+	16114, 16061, 16008, 15956, 15904, 15852, 15801, 15750, 15699, 15649,
+	15599, 15550, 15500, 15451, 15402, 15354, 15306, 15258, 15211, 15163,
+	15116,
+};
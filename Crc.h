@@ -0,0 +1,36 @@
+/*********************************************************************
+* Crc.h
+*
+* Description: CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF) used to
+* protect records stored in EEPROM and on the SD card.
+*
+* version :  V1.0
+* date    :  2026-10-19
+**********************************************************************/
+
+#pragma once
+#include <Arduino.h>
+
+#define CRC16_INIT 0xFFFF
+
+// feed one byte into a running CRC
+inline uint16_t crc16Update(uint16_t crc, uint8_t data)
+{
+	crc ^= (uint16_t)data << 8;
+	for (uint8_t i = 0; i < 8; i++)
+	{
+		crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+	}
+	return crc;
+}
+
+// CRC of a whole buffer, pass the previous result as crc to continue a running CRC
+inline uint16_t crc16(const void *data, size_t length, uint16_t crc = CRC16_INIT)
+{
+	const uint8_t *p = (const uint8_t *)data;
+	while (length--)
+	{
+		crc = crc16Update(crc, *p++);
+	}
+	return crc;
+}
@@ -23,32 +23,18 @@
 #include "GravityEc.h"
 #include "Arduino.h"
 
-#include <EEPROM.h>
-
-#define EEPROM_write(address, p)              \
-    {                                         \
-        int i = 0;                            \
-        byte *pp = (byte *)&(p);              \
-        for (; i < sizeof(p); i++)            \
-            EEPROM.write(address + i, pp[i]); \
-    }
-#define EEPROM_read(address, p)               \
-    {                                         \
-        int i = 0;                            \
-        byte *pp = (byte *)&(p);              \
-        for (; i < sizeof(p); i++)            \
-            pp[i] = EEPROM.read(address + i); \
-    }
-
-#define compensationFactorAddress 8 //the address of the factor stored in the EEPROM
+#include "CalibrationStore.h"
+#include "IdleManager.h"
+#include "LookupTable.h"
+#include "Telemetry.h"
 
-GravityEc::GravityEc(ISensor *temp) : ecSensorPin(A0), ECcurrent(0), index(0), AnalogAverage(0),
-                                      AnalogValueTotal(0), averageVoltage(0), AnalogSampleTime(0), printTime(0), sum(0),
-                                      tempSampleTime(0), AnalogSampleInterval(25), printInterval(700)
+GravityEc::GravityEc(GravityTemperature *temp) : ecSensorPin(A0), ECcurrent(0), index(0), AnalogAverage(0),
+                                      AnalogValueTotal(0), AnalogSampleTime(0), sum(0),
+                                      tempSampleTime(0), AnalogSampleInterval(calibrationStore.intervals.value[INTERVAL_EC_MIN]),
+                                      sampler(calibrationStore.intervals.value + INTERVAL_EC_MIN), samples(0), valueTime(0), clamped(false), calibrating(false), dirty(true), compensationVersion(0)
 {
     this->ecTemperature = temp;
     this->_cmdReceivedBufferIndex = 0;
-    readCharacteristicValues(); //read the compensationFactor
 }
 
 GravityEc::~GravityEc() {}
@@ -62,6 +48,7 @@ void GravityEc::setup()
     pinMode(ecSensorPin, INPUT);
     for (byte thisReading = 0; thisReading < numReadings; thisReading++)
         readings[thisReading] = 0;
+    readCharacteristicValues(); //read the compensationFactor
 }
 
 //********************************************************************************************
@@ -71,7 +58,6 @@ void GravityEc::setup()
 void GravityEc::update()
 {
     calculateAnalogAverage();
-    calculateEc();
 }
 
 //********************************************************************************************
@@ -80,9 +66,55 @@ void GravityEc::update()
 //********************************************************************************************
 double GravityEc::getValue()
 {
+    refresh();
     return ECcurrent;
 }
 
+//********************************************************************************************
+// function name: idleTime ()
+// Function Description: Returns the ms until update() takes the next sample
+//********************************************************************************************
+unsigned long GravityEc::idleTime()
+{
+    return timeUntil(this->AnalogSampleTime, this->AnalogSampleInterval);
+}
+
+SamplingState GravityEc::samplingState()
+{
+    return this->sampler.state();
+}
+
+//********************************************************************************************
+// function name: getReading ()
+// Function Description: Returns the value with its acquisition time and quality flags
+//********************************************************************************************
+SensorReading GravityEc::getReading()
+{
+    SensorReading reading;
+    reading.value = getValue();
+    reading.time = this->valueTime;
+    reading.samples = this->samples;
+    reading.flags = staleFlag(this->valueTime) | (this->clamped ? READING_CLAMPED : 0) |
+                    (this->calibrating ? READING_CALIBRATING : 0);
+    return reading;
+}
+
+//********************************************************************************************
+// function name: refresh ()
+// Function Description: Recalculates the conductivity only if a new average or a new
+// temperature arrived since the last calculation
+//********************************************************************************************
+void GravityEc::refresh()
+{
+    const TemperatureCompensation &compensation = this->ecTemperature->compensation();
+    if (this->dirty || compensation.version != this->compensationVersion)
+    {
+        this->dirty = false;
+        this->compensationVersion = compensation.version;
+        calculateEc(compensation.reciprocal[COMP_EC]);
+    }
+}
+
 //********************************************************************************************
 // function name: calculateAnalogAverage ()
 // Function Description: Calculates the average voltage
@@ -93,53 +125,53 @@ void GravityEc::calculateAnalogAverage()
     {
         AnalogSampleTime = millis();
         readings[index++] = analogRead(ecSensorPin);
+        this->samples++;
         if (index == numReadings)
         {
             index = 0;
+            unsigned int minimum = readings[0], maximum = readings[0];
             for (int i = 0; i < numReadings; i++)
+            {
                 this->sum += readings[i];
+                minimum = min(minimum, readings[i]);
+                maximum = max(maximum, readings[i]);
+            }
             AnalogAverage = this->sum / numReadings;
+            this->sampler.add(AnalogAverage, maximum - minimum);
+            AnalogSampleInterval = this->sampler.interval();
             this->sum = 0;
+            this->dirty = true;
+            this->valueTime = millis();
         }
     }
 }
 
 //********************************************************************************************
-// function name: calculateAnalogAverage ()
+// function name: calculateEc ()
 // Function Description: Calculate the conductivity
 //********************************************************************************************
-void GravityEc::calculateEc()
+void GravityEc::calculateEc(uint16_t compensation)
 {
-    if (millis() - printTime >= printInterval)
-    {
-        printTime = millis();
-        averageVoltage = AnalogAverage * 5000.0 / 1024.0;
-        TempCoefficient = 1.0 + 0.0185 * (this->ecTemperature->getValue() - 25.0); //temperature compensation formula: fFinalResult(25^C) = fFinalResult(current)/(1.0+0.0185*(fTP-25.0));
-
-        CoefficientVolatge = (double)averageVoltage / TempCoefficient;
+    // temperature compensation formula: fFinalResult(25^C) = fFinalResult(current)/(1.0+0.0185*(fTP-25.0));
+    // applied to the probe voltage, as compensated ADC code in Q14
+    uint32_t code = (uint32_t)AnalogAverage * compensation;
 
-        if (CoefficientVolatge < 150)
-        {
-            ECcurrent = 0;
-            return;
-        }
-        else if (CoefficientVolatge > 3300)
-        {
-            ECcurrent = 20;
-            return;
-        }
-        else
-        {
-            if (CoefficientVolatge <= 448)
-                ECcurrent = 6.84 * CoefficientVolatge - 64.32; //1ms/cm<EC<=3ms/cm
-            else if (CoefficientVolatge <= 1457)
-                ECcurrent = 6.98 * CoefficientVolatge - 127; //3ms/cm<EC<=10ms/cm
-            else
-                ECcurrent = 5.3 * CoefficientVolatge + 2278; //10ms/cm<EC<20ms/cm
-            //ECcurrent /= 1000;
-            ECvalueRaw = ECcurrent / 1000.0;                     //convert us/cm to ms/cm
-            ECcurrent = ECcurrent / compensationFactor / 1000.0; //after compensation,convert us/cm to ms/cm
-        }
+    clamped = code < EC_LUT_MIN_INPUT || code > EC_LUT_MAX_INPUT;
+    if (code < EC_LUT_MIN_INPUT) // below 150mV
+    {
+        ECcurrent = 0;
+        return;
+    }
+    else if (code > EC_LUT_MAX_INPUT) // above 3300mV
+    {
+        ECcurrent = 20;
+        return;
+    }
+    else
+    {
+        uint16_t ec = lookupTable(ecCurveTable, CONDUCTIVITY_CODE_ENTRIES, code, CONDUCTIVITY_CODE_STEP_SHIFT + TEMP_COMP_SHIFT); // us/cm
+        ECvalueRaw = ec / 1000.0; //convert us/cm to ms/cm
+        ECcurrent = ec * ecScale; //after compensation,convert us/cm to ms/cm
     }
 }
 
@@ -148,12 +180,8 @@ void GravityEc::calculateEc()
  *************************************/
 void GravityEc::readCharacteristicValues()
 {
-    EEPROM_read(compensationFactorAddress, compensationFactor);
-    if (EEPROM.read(compensationFactorAddress) == 0xFF && EEPROM.read(compensationFactorAddress + 1) == 0xFF && EEPROM.read(compensationFactorAddress + 2) == 0xFF && EEPROM.read(compensationFactorAddress + 3) == 0xFF)
-    {
-        compensationFactor = 1.0; // If the EEPROM is new, the compensationFactorAddress is 1.0(default).
-        EEPROM_write(compensationFactorAddress, compensationFactor);
-    }
+    compensationFactor = calibrationStore.ec.compensationFactor;
+    ecScale = 1.0 / compensationFactor / 1000.0;
 }
 
 void GravityEc::calibration(byte mode)
@@ -168,63 +196,66 @@ void GravityEc::ecCalibration(byte mode)
 {
     char *receivedBufferPtr;
     static boolean ecCalibrationFinish = 0;
-    static boolean enterCalibrationFlag = 0;
     // static float compECsolution;
     float factorTemp;
     switch (mode)
     {
     case 0:
-        if (enterCalibrationFlag)
+        if (this->calibrating)
         {
-            Serial.println(F(">>>EC Command Error<<<"));
+            telemetry.println(F(">>>EC Command Error<<<"));
         }
         break;
     case 1:
-        enterCalibrationFlag = 1;
+        this->calibrating = true;
         ecCalibrationFinish = 0;
-        Serial.println();
-        Serial.println(F(">>>Enter EC Calibration Mode<<<"));
-        Serial.println(F(">>>Please put the probe into the 1.413ms/cm buffer solution<<<"));
-        Serial.println();
+        telemetry.println();
+        telemetry.println(F(">>>Enter EC Calibration Mode<<<"));
+        telemetry.println(F(">>>Please put the probe into the 1.413ms/cm buffer solution<<<"));
+        telemetry.println();
         break;
     case 2:
-        if (enterCalibrationFlag)
+        if (this->calibrating)
         {
+            refresh();
             factorTemp = ECvalueRaw / 1.413;
             if ((factorTemp > 0) && (factorTemp < 1.15))
             {
-                Serial.println();
-                Serial.println(F(">>>Confirm Successful<<<"));
-                Serial.println();
+                telemetry.println();
+                telemetry.println(F(">>>Confirm Successful<<<"));
+                telemetry.println();
                 compensationFactor = factorTemp;
+                ecScale = 1.0 / compensationFactor / 1000.0;
+                dirty = true;
                 ecCalibrationFinish = 1;
             }
             else
             {
-                Serial.println();
-                Serial.println(F(">>>Confirm Failed,Try Again<<<"));
-                Serial.println();
+                telemetry.println();
+                telemetry.println(F(">>>Confirm Failed,Try Again<<<"));
+                telemetry.println();
                 ecCalibrationFinish = 0;
             }
         }
         break;
     case 3:
-        if (enterCalibrationFlag)
+        if (this->calibrating)
         {
-            Serial.println();
+            telemetry.println();
             if (ecCalibrationFinish)
             {
-                EEPROM_write(compensationFactorAddress, compensationFactor);
-                Serial.print(F(">>>Calibration Successful"));
+                calibrationStore.ec.compensationFactor = compensationFactor;
+                calibrationStore.save(CAL_EC);
+                telemetry.print(F(">>>Calibration Successful"));
             }
             else
             {
-                Serial.print(F(">>>Calibration Failed"));
+                telemetry.print(F(">>>Calibration Failed"));
             }
-            Serial.println(F(",Exit EC Calibration Mode<<<"));
-            Serial.println();
+            telemetry.println(F(",Exit EC Calibration Mode<<<"));
+            telemetry.println();
             ecCalibrationFinish = 0;
-            enterCalibrationFlag = 0;
+            this->calibrating = false;
         }
         break;
     }
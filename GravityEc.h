@@ -36,13 +36,11 @@ public:
 	// Conductivity values
 	double ECcurrent;
 	double ECvalueRaw;
-	double TempCoefficient;
 
-	double CoefficientVolatge;
 	float compensationFactor;
 
 public:
-	GravityEc(ISensor *);
+	GravityEc(GravityTemperature *);
 	~GravityEc();
 
 	// initialization
@@ -53,6 +51,12 @@ public:
 
 	// Get the sensor data
 	double getValue();
+	// ms until the next sample is due
+	unsigned long idleTime();
+	// sampling activity, see AdaptiveSampler
+	SamplingState samplingState();
+	// value with acquisition time and quality flags
+	SensorReading getReading();
 
 	// Added from DFRobot_EC
 	// void calibration(char *cmd); //calibration by Serial CMD
@@ -62,7 +66,7 @@ public:
 
 private:
 	// point to the temperature sensor pointer
-	ISensor *ecTemperature = NULL;
+	GravityTemperature *ecTemperature = NULL;
 
 	static const int numReadings = 5;
 	unsigned int readings[numReadings] = {0}; // the readings from the analog input
@@ -70,25 +74,35 @@ private:
 	double sum;
 	unsigned long AnalogValueTotal; // the running total
 	unsigned int AnalogAverage;
-	unsigned int averageVoltage;
 	unsigned long AnalogSampleTime;
-	unsigned long printTime;
 	unsigned long tempSampleTime;
 	unsigned long AnalogSampleInterval;
-	unsigned long printInterval;
+	AdaptiveSampler sampler; // drives AnalogSampleInterval
+	unsigned int samples;	 // samples taken since boot
+	unsigned long valueTime; // millis() of the last completed average
+	bool clamped;			 // the last average was outside the EC curve
+	bool calibrating;		 // between ENTEREC and EXITEC
+
+	// the conductivity is calculated on demand, see refresh()
+	bool dirty;				// a new analog average is waiting to be converted
+	uint8_t compensationVersion; // temperature compensation used by the last calculation
 
 	// Added from DFRobot_EC
 	float _kvalue;
 	float _kvalueLow;
 	float _kvalueHigh;
+	float ecScale; // 1 / compensationFactor / 1000, converts us/cm to calibrated ms/cm
 	char _cmdReceivedBuffer[ReceivedBufferLength]; //store the Serial CMD
 	byte _cmdReceivedBufferIndex;
 
 	// Calculate the average
 	void calculateAnalogAverage();
 
-	// Calculate the conductivity
-	void calculateEc();
+	// Calculate the conductivity, compensation is the Q14 reciprocal of the temperature factor
+	void calculateEc(uint16_t compensation);
+
+	// Calculate the conductivity if its inputs changed
+	void refresh();
 
 	//Added from DFRobot_EC
 	//boolean cmdSerialDataAvailable();
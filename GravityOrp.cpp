@@ -20,8 +20,11 @@
 **********************************************************************/
 
 #include "GravityOrp.h"
+#include "CalibrationStore.h"
+#include "IdleManager.h"
 
-GravityOrp::GravityOrp() : orpSensorPin(A3), voltage(5.0), offset(0), orpValue(0.0), sum(0) {}
+GravityOrp::GravityOrp() : orpSensorPin(A3), voltage(5.0), offset(0), orpValue(0.0), sum(0), orpTimer(0),
+						   sampler(calibrationStore.intervals.value + INTERVAL_ORP_MIN), samples(0), valueTime(0) {}
 
 GravityOrp::~GravityOrp() {}
 
@@ -37,23 +40,29 @@ void GravityOrp::setup() {}
 //********************************************************************************************
 void GravityOrp::update()
 {
-	static unsigned long orpTimer = millis(); //analog sampling interval
-	static unsigned long printTime = millis();
 	static int orpArrayIndex = 0;
-	if (millis() >= orpTimer)
+	if ((long)(millis() - orpTimer) >= 0)
 	{
-		orpTimer = millis() + 20;
-		orpArray[orpArrayIndex++] = analogRead(orpSensorPin); //read an analog value every 20ms
+		orpTimer = millis() + this->sampler.interval();
+		orpArray[orpArrayIndex++] = analogRead(orpSensorPin); //read an analog value every interval
+		this->samples++;
 
-		if (orpArrayIndex == arrayLength) // 5 * 20 = 100ms calculated once
+		if (orpArrayIndex == arrayLength) // 5 samples calculated once
 		{
 			orpArrayIndex = 0;
+			int minimum = orpArray[0], maximum = orpArray[0];
 			for (int i = 0; i < arrayLength; i++)
+			{
 				this->sum += orpArray[i];
+				minimum = min(minimum, orpArray[i]);
+				maximum = max(maximum, orpArray[i]);
+			}
 			averageOrp = this->sum / arrayLength;
+			this->sampler.add(averageOrp, maximum - minimum);
 			this->sum = 0;
 			//convert the analog value to orp according the circuit
 			this->orpValue = ((30 * this->voltage * 1000) - (75 * averageOrp * this->voltage * 1000 / 1024)) / 75 - this->offset;
+			this->valueTime = millis();
 		}
 	}
 }
@@ -67,4 +76,33 @@ double GravityOrp::getValue()
 	return this->orpValue;
 }
 
+//********************************************************************************************
+// function name: idleTime ()
+// Function Description: Returns the ms until update() takes the next sample
+//********************************************************************************************
+unsigned long GravityOrp::idleTime()
+{
+	long remaining = (long)(this->orpTimer - millis());
+	return remaining > 0 ? remaining : 0;
+}
+
+SamplingState GravityOrp::samplingState()
+{
+	return this->sampler.state();
+}
+
+//********************************************************************************************
+// function name: getReading ()
+// Function Description: Returns the value with its acquisition time and quality flags
+//********************************************************************************************
+SensorReading GravityOrp::getReading()
+{
+	SensorReading reading;
+	reading.value = this->orpValue;
+	reading.time = this->valueTime;
+	reading.samples = this->samples;
+	reading.flags = staleFlag(this->valueTime);
+	return reading;
+}
+
 void GravityOrp::calibration(byte mode) {}
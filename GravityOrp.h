@@ -45,6 +45,12 @@ private:
 	double previousOrp;
 	double currentOrp;
 	double averageOrp;
+	// time of the next sample
+	unsigned long orpTimer;
+	// drives the interval between samples
+	AdaptiveSampler sampler;
+	unsigned int samples;	 // samples taken since boot
+	unsigned long valueTime; // millis() of the last completed window
 
 public:
 	GravityOrp();
@@ -58,6 +64,12 @@ public:
 
 	// Get the sensor data
 	double getValue();
+	// ms until the next sample is due
+	unsigned long idleTime();
+	// sampling activity, see AdaptiveSampler
+	SamplingState samplingState();
+	// value with acquisition time and quality flags
+	SensorReading getReading();
 
 	void calibration(byte mode);
 };
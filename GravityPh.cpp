@@ -25,31 +25,18 @@
 #include "GravityPh.h"
 #include "Arduino.h"
 
-#include <EEPROM.h>
-
-#define EEPROM_write(address, p)              \
-    {                                         \
-        int i = 0;                            \
-        byte *pp = (byte *)&(p);              \
-        for (; i < sizeof(p); i++)            \
-            EEPROM.write(address + i, pp[i]); \
-    }
-#define EEPROM_read(address, p)               \
-    {                                         \
-        int i = 0;                            \
-        byte *pp = (byte *)&(p);              \
-        for (; i < sizeof(p); i++)            \
-            pp[i] = EEPROM.read(address + i); \
-    }
-
-#define PHVALUEADDR 0x00 //the start address of the pH calibration parameters stored in the EEPROM
-
-GravityPh::GravityPh() : phSensorPin(A2), offset(0.0f),
-                         samplingInterval(30), pHValue(0), voltage(0), sum(0)
+#include "CalibrationStore.h"
+#include "IdleManager.h"
+#include "LookupTable.h"
+#include "Telemetry.h"
+
+GravityPh::GravityPh(GravityTemperature *temp) : phSensorPin(A2), offset(0.0f),
+                                                samplingInterval(calibrationStore.intervals.value[INTERVAL_PH_MIN]), samplingTime(0), pHValue(0), voltage(0), sum(0),
+                                                sampler(calibrationStore.intervals.value + INTERVAL_PH_MIN), samples(0), valueTime(0), calibrating(false)
 {
+    this->phTemperature = temp;
     this->_acidVoltage = 1.14;   //buffer solution 4.0 at 25C
     this->_neutralVoltage = 2.0; //buffer solution 7.0 at 25C
-    readCharacteristicValues();
 }
 
 //********************************************************************************************
@@ -59,6 +46,7 @@ GravityPh::GravityPh() : phSensorPin(A2), offset(0.0f),
 void GravityPh::setup()
 {
     pinMode(phSensorPin, INPUT);
+    readCharacteristicValues();
 }
 
 //********************************************************************************************
@@ -67,23 +55,30 @@ void GravityPh::setup()
 //********************************************************************************************
 void GravityPh::update()
 {
-    static unsigned long samplingTime = millis();
-    static unsigned long printTime = millis();
     static int pHArrayIndex = 0;
     if (millis() - samplingTime > samplingInterval)
     {
         samplingTime = millis();
         pHArray[pHArrayIndex++] = analogRead(this->phSensorPin);
+        this->samples++;
 
-        if (pHArrayIndex == arrayLength) // 5 * 20 = 100ms
+        if (pHArrayIndex == arrayLength) // 5 samples per value
         {
             pHArrayIndex = 0;
+            this->sum = 0;
+            int minimum = pHArray[0], maximum = pHArray[0];
             for (int i = 0; i < arrayLength; i++)
+            {
                 this->sum += pHArray[i];
-            averageVoltage = this->sum / arrayLength;
-            this->sum = 0;
-            voltage = averageVoltage * 5.0 / 1024.0;
-            pHValue = 3.5 * voltage + this->offset;
+                minimum = min(minimum, pHArray[i]);
+                maximum = max(maximum, pHArray[i]);
+            }
+            this->sampler.add(this->sum / arrayLength, maximum - minimum);
+            this->samplingInterval = this->sampler.interval();
+            if (this->phTemperature != NULL && this->phTemperature->compensation().version != this->_compensationVersion)
+                updateSlope();
+            pHValue = this->_slope * this->sum + this->_intercept;
+            this->valueTime = millis();
         }
     }
 }
@@ -97,20 +92,70 @@ double GravityPh::getValue()
     return this->pHValue;
 }
 
+//********************************************************************************************
+// function name: idleTime ()
+// Function Description: Returns the ms until update() takes the next sample
+//********************************************************************************************
+unsigned long GravityPh::idleTime()
+{
+    return timeUntil(this->samplingTime, this->samplingInterval + 1);
+}
+
+SamplingState GravityPh::samplingState()
+{
+    return this->sampler.state();
+}
+
+//********************************************************************************************
+// function name: getReading ()
+// Function Description: Returns the value with its acquisition time and quality flags
+//********************************************************************************************
+SensorReading GravityPh::getReading()
+{
+    SensorReading reading;
+    reading.value = getValue();
+    reading.time = this->valueTime;
+    reading.samples = this->samples;
+    reading.flags = staleFlag(this->valueTime) | (this->calibrating ? READING_CALIBRATING : 0);
+    return reading;
+}
+
+//********************************************************************************************
+// function name: readCharacteristicValues ()
+// Function Description: Takes the calibration voltages from the calibration store
+//********************************************************************************************
 void GravityPh::readCharacteristicValues()
 {
+    this->_neutralVoltage = calibrationStore.ph.neutralVoltage;
+    this->_acidVoltage = calibrationStore.ph.acidVoltage;
+    updateSlope();
+}
 
-    if (EEPROM.read(PHVALUEADDR) == 0xFF && EEPROM.read(PHVALUEADDR + 1) == 0xFF && EEPROM.read(PHVALUEADDR + 2) == 0xFF && EEPROM.read(PHVALUEADDR + 3) == 0xFF)
+//********************************************************************************************
+// function name: updateSlope ()
+// Function Description: Derives slope and intercept from the two calibration points so that
+// update() only has to do pH = slope * sum + intercept on the raw sum of a sampling window.
+// The slope follows the Nernst equation and is scaled to the current temperature.
+//********************************************************************************************
+void GravityPh::updateSlope()
+{
+    double neutralVoltage = this->_neutralVoltage;
+    double acidVoltage = this->_acidVoltage;
+    if (neutralVoltage - acidVoltage < 0.1)
     {
-        this->_neutralVoltage = 2.0; // new EEPROM, write typical voltage
-        EEPROM_write(PHVALUEADDR, this->_neutralVoltage);
+        neutralVoltage = 2.0; // unusable calibration, fall back to the typical probe
+        acidVoltage = 1.14;
     }
 
-    if (EEPROM.read(PHVALUEADDR + 4) == 0xFF && EEPROM.read(PHVALUEADDR + 5) == 0xFF && EEPROM.read(PHVALUEADDR + 6) == 0xFF && EEPROM.read(PHVALUEADDR + 7) == 0xFF)
+    double slope = (7.0 - 4.0) / (neutralVoltage - acidVoltage); // pH per volt at 25C
+    if (this->phTemperature != NULL)
     {
-        this->_acidVoltage = 1.14; // new EEPROM, write typical voltage
-        EEPROM_write(PHVALUEADDR + 4, this->_acidVoltage);
+        const TemperatureCompensation &compensation = this->phTemperature->compensation();
+        this->_compensationVersion = compensation.version;
+        slope *= compensation.reciprocal[COMP_NERNST] / (double)(1 << TEMP_COMP_SHIFT); // 298.15 / (T + 273.15)
     }
+    this->_intercept = 7.0 - slope * neutralVoltage + this->offset;
+    this->_slope = slope * 5.0 / 1024.0 / arrayLength;
 }
 
 void GravityPh::calibration(byte mode)
@@ -122,80 +167,76 @@ void GravityPh::phCalibration(byte mode)
 {
     char *receivedBufferPtr;
     static boolean phCalibrationFinish = 0;
-    static boolean enterCalibrationFlag = 0;
+    voltage = this->sum * 5.0 / 1024.0 / arrayLength;
     switch (mode)
     {
     case 0:
-        if (enterCalibrationFlag)
+        if (this->calibrating)
         {
-            Serial.println(F(">>>PH Command Error<<<"));
+            telemetry.println(F(">>>PH Command Error<<<"));
         }
         break;
 
     case 1:
-        enterCalibrationFlag = 1;
+        this->calibrating = true;
         phCalibrationFinish = 0;
-        Serial.println();
-        Serial.println(F(">>>Enter PH Calibration Mode<<<"));
-        Serial.println(F(">>>Please put the probe into the 4.0 or 7.0 standard buffer solution<<<"));
-        Serial.println();
+        telemetry.println();
+        telemetry.println(F(">>>Enter PH Calibration Mode<<<"));
+        telemetry.println(F(">>>Please put the probe into the 4.0 or 7.0 standard buffer solution<<<"));
+        telemetry.println();
         break;
 
     case 2:
-        if (enterCalibrationFlag)
+        if (this->calibrating)
         {
             if ((voltage > 1.7) && (voltage < 2.7))
             { // buffer solution:7.0{
-                Serial.println();
-                Serial.print(F(">>>PH Buffer Solution:7.0"));
+                telemetry.println();
+                telemetry.print(F(">>>PH Buffer Solution:7.0"));
                 this->_neutralVoltage = voltage;
-                Serial.println(F(",Send EXITPH to Save and Exit<<<"));
-                Serial.println();
+                telemetry.println(F(",Send EXITPH to Save and Exit<<<"));
+                telemetry.println();
                 phCalibrationFinish = 1;
             }
             else if ((voltage > 0.7) && (voltage < 1.7))
             { //buffer solution:4.0
-                Serial.println();
-                Serial.print(F(">>>PH Buffer Solution:4.0"));
+                telemetry.println();
+                telemetry.print(F(">>>PH Buffer Solution:4.0"));
                 this->_acidVoltage = voltage;
-                Serial.println(F(",Send EXITPH to Save and Exit<<<"));
-                Serial.println();
+                telemetry.println(F(",Send EXITPH to Save and Exit<<<"));
+                telemetry.println();
                 phCalibrationFinish = 1;
             }
             else
             {
-                Serial.println();
-                Serial.print(F(">>>PH Buffer Solution Error Try Again<<<"));
-                Serial.println(); // not buffer solution or faulty operation
+                telemetry.println();
+                telemetry.print(F(">>>PH Buffer Solution Error Try Again<<<"));
+                telemetry.println(); // not buffer solution or faulty operation
                 phCalibrationFinish = 0;
             }
         }
         break;
 
     case 3:
-        if (enterCalibrationFlag)
+        if (this->calibrating)
         {
-            Serial.println();
+            telemetry.println();
             if (phCalibrationFinish)
             {
-                if ((voltage > 1.7) && (voltage < 2.7))
-                {
-                    EEPROM_write(PHVALUEADDR, this->_neutralVoltage);
-                }
-                else if ((voltage > 0.7) && (voltage < 1.7))
-                {
-                    EEPROM_write(PHVALUEADDR + 4, this->_acidVoltage);
-                }
-                Serial.print(F(">>>PH Calibration Successful"));
+                calibrationStore.ph.neutralVoltage = this->_neutralVoltage;
+                calibrationStore.ph.acidVoltage = this->_acidVoltage;
+                calibrationStore.save(CAL_PH);
+                updateSlope();
+                telemetry.print(F(">>>PH Calibration Successful"));
             }
             else
             {
-                Serial.print(F(">>>PH Calibration Failed"));
+                telemetry.print(F(">>>PH Calibration Failed"));
             }
-            Serial.println(F(",Exit PH Calibration Mode<<<"));
-            Serial.println();
+            telemetry.println(F(",Exit PH Calibration Mode<<<"));
+            telemetry.println();
             phCalibrationFinish = 0;
-            enterCalibrationFlag = 0;
+            this->calibrating = false;
         }
         break;
     }
@@ -22,6 +22,7 @@
 #pragma once
 #include <Arduino.h>
 #include "ISensor.h"
+#include "GravityTemperature.h"
 
 #define ReceivedBufferLength 10 //length of the Serial CMD buffer
 
@@ -37,16 +38,32 @@ public:
 	// Take the sample interval
 	int samplingInterval;
 
+	// time of the last sample
+	unsigned long samplingTime;
+
 private:
 	static const int arrayLength = 5;
 	int pHArray[arrayLength]; // stores the average value of the sensor return data
 	double pHValue, voltage;
-	double averageVoltage;
 	double sum;
 
+	// point to the temperature sensor pointer
+	GravityTemperature *phTemperature = NULL;
+
 	double _acidVoltage;
 	double _neutralVoltage;
 
+	// pH = _slope * sum + _intercept, derived from the calibration voltages
+	double _slope;
+	double _intercept;
+	uint8_t _compensationVersion; // temperature compensation the slope was scaled with
+
+	// drives samplingInterval
+	AdaptiveSampler sampler;
+	unsigned int samples;	 // samples taken since boot
+	unsigned long valueTime; // millis() of the last completed window
+	bool calibrating;		 // between ENTERPH and EXITPH
+
 	char _cmdReceivedBuffer[ReceivedBufferLength]; //store the Serial CMD
 	byte _cmdReceivedBufferIndex;
 
@@ -54,9 +71,10 @@ private:
 	void phCalibration(byte mode); // calibration process, wirte key parameters to EEPROM
 								   //byte    cmdParse(const char* cmd);
 								   //byte    cmdParse();
+	void updateSlope();
 
 public:
-	GravityPh();
+	GravityPh(GravityTemperature *);
 	~GravityPh(){};
 	// initialization
 	void setup();
@@ -67,6 +85,13 @@ public:
 	// Get the sensor data
 	double getValue();
 
+	// ms until the next sample is due
+	unsigned long idleTime();
+	// sampling activity, see AdaptiveSampler
+	SamplingState samplingState();
+	// value with acquisition time and quality flags
+	SensorReading getReading();
+
 	void readCharacteristicValues();
 	//void calibration();
 	//void calibration(char* cmd);
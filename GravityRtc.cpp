@@ -22,8 +22,10 @@
 #include "GravityRtc.h"
 #include "Arduino.h"
 #include <Wire.h>
+#include "IdleManager.h"
 
-GravityRtc::GravityRtc() : year(2017), month(4), day(17), week(4), hour(14), minute(5), second(0) {}
+GravityRtc::GravityRtc() : year(2017), month(4), day(17), week(4), hour(14), minute(5), second(0),
+						   epoch(0), epochMillis(0), timeUpdate(0) {}
 
 GravityRtc::~GravityRtc() {}
 
@@ -51,6 +53,15 @@ void GravityRtc::update()
 	}
 }
 
+//********************************************************************************************
+// function name: idleTime ()
+// Function Description: Returns the ms until the next RTC read
+//********************************************************************************************
+unsigned long GravityRtc::idleTime()
+{
+	return timeUntil(timeUpdate, 1001);
+}
+
 //********************************************************************************************
 // function name: initRtc ()
 // Function Description: Initializes the RTC clock
@@ -120,6 +131,87 @@ void GravityRtc::processRtc()
 	hour = date[2];
 	minute = date[1];
 	second = date[0];
+
+	epoch = toEpoch(year, month, day, hour, minute, second);
+	epochMillis = millis();
+}
+
+//********************************************************************************************
+// function name: now ()
+// Function Description: Current epoch time in seconds
+//********************************************************************************************
+unsigned long GravityRtc::now()
+{
+	return epochAt(millis());
+}
+
+//********************************************************************************************
+// function name: epochAt ()
+// Function Description: Converts a millis() timestamp into epoch seconds
+//********************************************************************************************
+unsigned long GravityRtc::epochAt(unsigned long ms)
+{
+	long elapsed = (long)(ms - epochMillis);
+	if (elapsed >= 0)
+		return epoch + elapsed / 1000;
+	return epoch - (unsigned long)(-elapsed + 999) / 1000;
+}
+
+//********************************************************************************************
+// function name: toEpoch ()
+// Function Description: Seconds since 1970-01-01 00:00:00 of a calendar date
+//********************************************************************************************
+unsigned long GravityRtc::toEpoch(unsigned int year, unsigned char month, unsigned char day,
+								  unsigned char hour, unsigned char minute, unsigned char second)
+{
+	static const unsigned int daysBeforeMonth[12] PROGMEM = {0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334};
+	if (month < 1 || month > 12)
+		month = 1;
+
+	unsigned long days = (year - 1970) * 365UL + (year - 1969) / 4 - (year - 1901) / 100 + (year - 1601) / 400;
+	days += pgm_read_word(&daysBeforeMonth[month - 1]) + day - 1;
+	if (month > 2 && (year % 4 == 0 && (year % 100 != 0 || year % 400 == 0)))
+		days++;
+	return ((days * 24 + hour) * 60 + minute) * 60 + second;
+}
+
+//********************************************************************************************
+// function name: fromEpoch ()
+// Function Description: Splits epoch seconds into the calendar date, inverse of toEpoch()
+//********************************************************************************************
+void GravityRtc::fromEpoch(unsigned long epoch, RtcTime &time)
+{
+	static const unsigned char daysInMonth[12] PROGMEM = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+	time.second = epoch % 60;
+	epoch /= 60;
+	time.minute = epoch % 60;
+	epoch /= 60;
+	time.hour = epoch % 24;
+	unsigned long days = epoch / 24;
+
+	unsigned int year = 1970;
+	for (;;)
+	{
+		unsigned int yearDays = (year % 4 == 0 && (year % 100 != 0 || year % 400 == 0)) ? 366 : 365;
+		if (days < yearDays)
+			break;
+		days -= yearDays;
+		year++;
+	}
+	time.year = year;
+
+	bool leap = year % 4 == 0 && (year % 100 != 0 || year % 400 == 0);
+	unsigned char month = 0;
+	for (;;)
+	{
+		unsigned char monthDays = pgm_read_byte(&daysInMonth[month]) + (month == 1 && leap ? 1 : 0);
+		if (days < monthDays)
+			break;
+		days -= monthDays;
+		month++;
+	}
+	time.month = month + 1;
+	time.day = days + 1;
 }
 
 //********************************************************************************************
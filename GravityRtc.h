@@ -23,6 +23,17 @@
 
 #define RTC_Address 0x32 //RTC_Address
 
+// calendar fields of an epoch time, see GravityRtc::fromEpoch()
+struct RtcTime
+{
+	unsigned int year;
+	unsigned char month;
+	unsigned char day;
+	unsigned char hour;
+	unsigned char minute;
+	unsigned char second;
+};
+
 class GravityRtc
 {
 public:
@@ -47,13 +58,30 @@ public:
 
 	// update the sensor data
 	void update();
+	// ms until update() reads the clock again
+	unsigned long idleTime();
 	// read the clock data
 	void readRtc();
 
 	// parse RTC data
 	void processRtc();
 
+	// seconds since 1970-01-01 00:00:00 (RTC local time), advanced with millis() between RTC reads
+	unsigned long now();
+
+	// epoch time of an earlier or later millis() timestamp
+	unsigned long epochAt(unsigned long ms);
+
+	// seconds since 1970-01-01 00:00:00 of a calendar date
+	static unsigned long toEpoch(unsigned int year, unsigned char month, unsigned char day,
+								 unsigned char hour, unsigned char minute, unsigned char second);
+	// calendar date of an epoch time
+	static void fromEpoch(unsigned long epoch, RtcTime &time);
+
 private:
+	unsigned long epoch;	   // epoch time of the last RTC read
+	unsigned long epochMillis; // millis() of the last RTC read
+
 	unsigned char date[7];
 
 	// decimal to BCD
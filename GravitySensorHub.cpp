@@ -22,6 +22,18 @@
 #include "GravityTDS.h"
 #include "GravityTemperature.h"
 #include "SensorDo.h"
+#include "Telemetry.h"
+#include "Profiler.h"
+#include "IdleManager.h"
+#include "Watchdog.h"
+#include "GravityRtc.h"
+#include "HistoryLog.h"
+#include "ReportLog.h"
+#include "SdService.h"
+#include "BulkTransfer.h"
+#include "CalibrationStore.h"
+
+extern GravityRtc rtc;
 
 //********************************************************************************************
 // function name: sensors []
@@ -40,13 +52,22 @@ GravitySensorHub::GravitySensorHub()
 		this->sensors[i] = NULL;
 	}
 
-	this->sensors[0] = new GravityPh();
-	this->sensors[1] = new GravityTemperature(5);
+	GravityTemperature *temperature = new GravityTemperature(5);
+	this->sensors[0] = new GravityPh(temperature);
+	this->sensors[1] = temperature;
 	//this->sensors[2] = new SensorDo();
-	this->sensors[2] = new GravityTDS(this->sensors[1]);
-	this->sensors[3] = new GravityEc(this->sensors[1]);
+	this->sensors[2] = new GravityTDS(temperature);
+	this->sensors[3] = new GravityEc(temperature);
 	this->sensors[4] = new GravityOrp();
 	this->_cmdReceivedBufferIndex = 0;
+
+	memset(this->snapshots, 0, sizeof(this->snapshots));
+	memset(this->sampleCounts, 0, sizeof(this->sampleCounts));
+	this->front = 0;
+	this->snapshotTime = 0;
+#if ENABLE_STATS
+	memset(this->statsTime, 0, sizeof(this->statsTime));
+#endif
 }
 
 //********************************************************************************************
@@ -89,9 +110,150 @@ void GravitySensorHub::update()
 	{
 		if (this->sensors[i])
 		{
+			PROFILE_SCOPE(PROFILE_SENSOR0 + i);
+			WATCHDOG_STEP(i);
 			this->sensors[i]->update();
 		}
 	}
+
+	if (millis() - this->snapshotTime >= SNAPSHOT_INTERVAL)
+	{
+		this->snapshotTime = millis();
+		publishSnapshot();
+	}
+}
+
+//********************************************************************************************
+// function name: publishSnapshot ()
+// Function Description: Reads every channel once into the back buffer, then makes it the
+// front buffer with a single byte write
+//********************************************************************************************
+void GravitySensorHub::publishSnapshot()
+{
+	const SensorSnapshot &current = this->snapshots[this->front];
+	SensorSnapshot &next = this->snapshots[this->front ^ 1];
+
+	unsigned long now = millis();
+	next.sequence = current.sequence + 1;
+	next.time = rtc.epochAt(now);
+	for (byte i = 0; i < SNAPSHOT_CHANNELS; i++)
+	{
+		ISensor *sensor = this->sensors[i];
+		if (sensor == NULL)
+		{
+			next.value[i] = 0;
+			next.age[i] = 0xFFFF;
+			next.samples[i] = 0;
+			next.flags[i] = READING_MISSING;
+			continue;
+		}
+
+		SensorReading reading = sensor->getReading();
+		unsigned long age = now - reading.time;
+		next.value[i] = reading.value;
+		next.age[i] = age > 0xFFFF ? 0xFFFF : age;
+		next.samples[i] = reading.samples - this->sampleCounts[i];
+		this->sampleCounts[i] = reading.samples;
+		next.flags[i] = reading.flags;
+		if (sensor->samplingState() == SAMPLING_BURST)
+			next.flags[i] |= READING_BURST;
+#if ENABLE_STATS
+		collectStats(i, reading);
+#endif
+	}
+
+	this->front ^= 1;
+}
+
+#if ENABLE_STATS
+//********************************************************************************************
+// function name: collectStats ()
+// Function Description: Adds the reading taken for the snapshot if the sensor completed it
+// since the previous snapshot, values of a missing sensor are left out. Riding on the
+// snapshot keeps getReading() off the sensor loop, at the cost of values a bursting channel
+// completes in between.
+//********************************************************************************************
+void GravitySensorHub::collectStats(byte channel, const SensorReading &reading)
+{
+	if (reading.time == this->statsTime[channel] || (reading.flags & READING_MISSING))
+		return;
+	this->statsTime[channel] = reading.time;
+	for (byte w = 0; w < STATS_WINDOWS; w++)
+	{
+		this->stats[w][channel].add(reading.value);
+	}
+}
+
+RunningStats &GravitySensorHub::windowStats(byte window, byte channel)
+{
+	return this->stats[window][channel];
+}
+
+//********************************************************************************************
+// function name: printStats ()
+// Function Description: STAT@channel,count,min,max,mean,stddev
+//********************************************************************************************
+void GravitySensorHub::printStats(byte window, byte channel)
+{
+	RunningStats &s = this->stats[window][channel];
+	telemetry.print(F("STAT@"));
+	telemetry.print(channel);
+	telemetry.print(',');
+	telemetry.print(s.count());
+	telemetry.print(',');
+	telemetry.print(s.minValue());
+	telemetry.print(',');
+	telemetry.print(s.maxValue());
+	telemetry.print(',');
+	telemetry.print(s.mean());
+	telemetry.print(',');
+	telemetry.println(s.stddev());
+	s.reset();
+}
+#endif
+
+//********************************************************************************************
+// function name: snapshot ()
+// Function Description: Returns the latest complete snapshot
+//********************************************************************************************
+const SensorSnapshot &GravitySensorHub::snapshot()
+{
+	return this->snapshots[this->front];
+}
+
+//********************************************************************************************
+// function name: idleTime ()
+// Function Description: Returns the shortest idle time of all sensors
+//********************************************************************************************
+unsigned long GravitySensorHub::idleTime()
+{
+	unsigned long idle = timeUntil(this->snapshotTime, SNAPSHOT_INTERVAL);
+	for (size_t i = 0; i < SensorCount; i++)
+	{
+		if (this->sensors[i])
+		{
+			unsigned long sensorIdle = this->sensors[i]->idleTime();
+			if (sensorIdle < idle)
+				idle = sensorIdle;
+		}
+	}
+	return idle;
+}
+
+//********************************************************************************************
+// function name: samplingState ()
+// Function Description: Returns SAMPLING_BURST if any sensor bursts, SAMPLING_STABLE only if
+// all sensors settled at their longest interval
+//********************************************************************************************
+SamplingState GravitySensorHub::samplingState()
+{
+	SamplingState state = SAMPLING_STABLE;
+	for (size_t i = 0; i < SensorCount; i++)
+	{
+		if (this->sensors[i] && this->sensors[i]->samplingState() > state)
+			state = this->sensors[i]->samplingState();
+	}
+	return state;
 }
 
 //********************************************************************************************
@@ -117,49 +279,154 @@ void GravitySensorHub::calibrate()
 {
 	if (cmdSerialDataAvailable() > 0)
 	{
-		if (strstr(this->_cmdReceivedBuffer, "ENTERPH") != NULL)
+		char *argument;
+		if (strstr_P(this->_cmdReceivedBuffer, PSTR("ENTERPH")) != NULL)
 		{
 			this->sensors[0]->calibration(1);
 		}
-		else if (strstr(this->_cmdReceivedBuffer, "EXITPH") != NULL)
+		else if (strstr_P(this->_cmdReceivedBuffer, PSTR("EXITPH")) != NULL)
 		{
 			this->sensors[0]->calibration(3);
 		}
-		else if (strstr(this->_cmdReceivedBuffer, "CALPH") != NULL)
+		else if (strstr_P(this->_cmdReceivedBuffer, PSTR("CALPH")) != NULL)
 		{
 			this->sensors[0]->calibration(2);
 		}
-		else if (strstr(this->_cmdReceivedBuffer, "ENTERTDS") != NULL)
+		else if (strstr_P(this->_cmdReceivedBuffer, PSTR("ENTERTDS")) != NULL)
 		{
 			this->sensors[2]->calibration(1);
 		}
-		else if (strstr(this->_cmdReceivedBuffer, "EXITTDS") != NULL)
+		else if (strstr_P(this->_cmdReceivedBuffer, PSTR("EXITTDS")) != NULL)
 		{
 			this->sensors[2]->calibration(3);
 		}
-		else if (strstr(this->_cmdReceivedBuffer, "CALTDS") != NULL)
+		else if (strstr_P(this->_cmdReceivedBuffer, PSTR("CALTDS")) != NULL)
 		{
 			this->sensors[2]->calibration(2);
 		}
-		else if (strstr(this->_cmdReceivedBuffer, "ENTEREC") != NULL)
+		else if (strstr_P(this->_cmdReceivedBuffer, PSTR("ENTEREC")) != NULL)
 		{
 			this->sensors[3]->calibration(1);
 		}
-		else if (strstr(this->_cmdReceivedBuffer, "EXITEC") != NULL)
+		else if (strstr_P(this->_cmdReceivedBuffer, PSTR("EXITEC")) != NULL)
 		{
 			this->sensors[3]->calibration(3);
 		}
-		else if (strstr(this->_cmdReceivedBuffer, "CALEC") != NULL)
+		else if (strstr_P(this->_cmdReceivedBuffer, PSTR("CALEC")) != NULL)
 		{
 			this->sensors[3]->calibration(2);
 		}
+#if ENABLE_HISTORY
+		else if ((argument = strstr_P(this->_cmdReceivedBuffer, PSTR("REPLAY"))) != NULL)
+		{
+			history.replay(strtoul(argument + 6, NULL, 10));
+		}
+#endif
+#if ENABLE_RANGE
+		else if ((argument = strstr_P(this->_cmdReceivedBuffer, PSTR("RANGE"))) != NULL)
+		{
+			// RANGE from to, epochs, to defaults to now
+			char *end;
+			unsigned long from = strtoul(argument + 5, &end, 10);
+			unsigned long to = strtoul(end, NULL, 10);
+			sdService.range(from, to != 0 ? to : 0xFFFFFFFFUL);
+		}
+#endif
+#if ENABLE_BULK
+		else if ((argument = strstr_P(this->_cmdReceivedBuffer, PSTR("BULK"))) != NULL)
+		{
+			// BULK name offset, BULK alone ends the session
+			char *name = argument + 4;
+			while (*name == ' ')
+				name++;
+			char *end = name;
+			while (*end != '\0' && *end != ' ' && *end != '\r')
+				end++;
+			unsigned long offset = *end != '\0' ? strtoul(end + 1, NULL, 10) : 0;
+			*end = '\0';
+			bulkTransfer.start(name, offset);
+		}
+		// before ACK, which BACK contains
+		else if ((argument = strstr_P(this->_cmdReceivedBuffer, PSTR("BACK"))) != NULL)
+		{
+			bulkTransfer.acknowledge(strtoul(argument + 4, NULL, 10));
+		}
+		else if ((argument = strstr_P(this->_cmdReceivedBuffer, PSTR("BNAK"))) != NULL)
+		{
+			bulkTransfer.reject(strtoul(argument + 4, NULL, 10));
+		}
+#endif
+		else if ((argument = strstr_P(this->_cmdReceivedBuffer, PSTR("RESEND"))) != NULL)
+		{
+			reportLog.resend(strtoul(argument + 6, NULL, 10));
+		}
+		else if ((argument = strstr_P(this->_cmdReceivedBuffer, PSTR("ACK"))) != NULL)
+		{
+			reportLog.acknowledge(strtoul(argument + 3, NULL, 10));
+		}
+		else if ((argument = strstr_P(this->_cmdReceivedBuffer, PSTR("COMPACT"))) != NULL)
+		{
+			reportLog.setCompact(atoi(argument + 7) != 0);
+		}
+		else if (strstr_P(this->_cmdReceivedBuffer, PSTR("LINK")) != NULL)
+		{
+			telemetry.printCounters();
+			reportLog.printCounters();
+		}
+		else if ((argument = strstr_P(this->_cmdReceivedBuffer, PSTR("SET"))) != NULL)
+		{
+			// SET name value, names in CalibrationStore.h
+			char *name = argument + 3;
+			while (*name == ' ')
+				name++;
+			char *end = name;
+			while (*end != '\0' && *end != ' ')
+				end++;
+			unsigned long value = *end != '\0' ? strtoul(end + 1, NULL, 10) : 0;
+			*end = '\0';
+			if (value > 0xFFFF || !calibrationStore.setInterval(name, value))
+				telemetry.println(F(">>>SET Error<<<"));
+			printIntervals();
+		}
+		else if (strstr_P(this->_cmdReceivedBuffer, PSTR("CONFIG")) != NULL)
+		{
+			printIntervals();
+		}
+#if ENABLE_SLEEP
+		else if (strstr_P(this->_cmdReceivedBuffer, PSTR("POWER")) != NULL)
+		{
+			idle.printCounters();
+		}
+#endif
+#if ENABLE_PROFILER
+		else if (strstr_P(this->_cmdReceivedBuffer, PSTR("PROFILE")) != NULL)
+		{
+			profiler.requestReport();
+		}
+#endif
 		else
 		{
-			Serial.println(F(">>>Arduino Command Error<<<"));
+			telemetry.println(F(">>>Arduino Command Error<<<"));
 		}
 	}
 }
 
+//********************************************************************************************
+// function name: printIntervals ()
+// Function Description: CFG@ with the interval table in IntervalId order
+//********************************************************************************************
+void GravitySensorHub::printIntervals()
+{
+	telemetry.print(F("CFG@"));
+	for (byte i = 0; i < INTERVAL_COUNT; i++)
+	{
+		if (i > 0)
+			telemetry.print(',');
+		telemetry.print(calibrationStore.intervals.value[i]);
+	}
+	telemetry.println();
+}
+
 boolean GravitySensorHub::cmdSerialDataAvailable()
 {
 	cmdReceivedTimeOut = millis();
@@ -167,15 +434,16 @@ boolean GravitySensorHub::cmdSerialDataAvailable()
 	{
 		if (millis() - cmdReceivedTimeOut > 500U)
 		{
-			Serial.println(F("CLEARED"));
+			telemetry.println(F("CLEARED"));
 			this->_cmdReceivedBufferIndex = 0;
-			memset(this->_cmdReceivedBuffer, 0, (ReceivedBufferLength));
-			Serial.println(F("CLEARED2"));
+			memset(this->_cmdReceivedBuffer, 0, (CommandBufferLength));
+			telemetry.println(F("CLEARED2"));
 		}
 		cmdReceivedTimeOut = millis();
 		cmdReceivedChar = Serial.read();
-		if (cmdReceivedChar == '\n' || this->_cmdReceivedBufferIndex == ReceivedBufferLength - 1)
+		if (cmdReceivedChar == '\n' || this->_cmdReceivedBufferIndex == CommandBufferLength - 1)
 		{
+			this->_cmdReceivedBuffer[this->_cmdReceivedBufferIndex] = '\0'; // drop what is left of a longer command
 			this->_cmdReceivedBufferIndex = 0;
 			strupr(this->_cmdReceivedBuffer);
 			return true;
@@ -17,23 +17,72 @@
 
 #pragma once
 #include "ISensor.h"
-#define ReceivedBufferLength 10 //length of the Serial CMD buffer
+#include "RunningStats.h"
+#if ENABLE_RANGE || ENABLE_BULK
+#define CommandBufferLength 32 //length of the Serial CMD buffer, RANGE and BULK carry two arguments
+#else
+#define CommandBufferLength 24 //length of the Serial CMD buffer, commands may carry an argument
+#endif
+#define SNAPSHOT_CHANNELS 5		 // sensors[0..4] are published in the snapshot
+#define SNAPSHOT_INTERVAL 1000	 // ms between snapshots
+#define STATS_FRAME_RESERVE 64
+
+// consumer windows of the channel statistics
+enum StatsWindow
+{
+	STATS_REPORT = 0, // between two report frames
+#if !SD_COMPRESSED && !SD_RAW_LOG
+	STATS_LOG, // between two SD rows, only csv rows have columns for them
+#endif
+	STATS_WINDOWS
+};
+
 /*
 sensors :
 0,ph
 1,ec
 2.orp
 */
+
+//********************************************************************************************
+// One coherent data point. The hub fills the back buffer once per SNAPSHOT_INTERVAL and swaps
+// it with the front, consumers only ever see a complete snapshot.
+//********************************************************************************************
+struct SensorSnapshot
+{
+	unsigned long sequence;				  // snapshots published since boot
+	unsigned long time;					  // epoch seconds when the values were taken
+	float value[SNAPSHOT_CHANNELS];		  // getReading() of sensors[n]
+	uint16_t age[SNAPSHOT_CHANNELS];	  // ms between acquisition and snapshot, saturates
+	uint16_t samples[SNAPSHOT_CHANNELS];  // samples taken since the previous snapshot
+	uint8_t flags[SNAPSHOT_CHANNELS];	  // READING_*, missing sensors are READING_MISSING
+};
 class GravitySensorHub
 {
 private:
-	static const int SensorCount = 10;
+	static const int SensorCount = SNAPSHOT_CHANNELS;
 	char cmdReceivedChar;
 	unsigned long cmdReceivedTimeOut;
 	//long cmdReceivedTimeOut;
-	char _cmdReceivedBuffer[ReceivedBufferLength]; //store the Serial CMD
+	char _cmdReceivedBuffer[CommandBufferLength]; //store the Serial CMD
 	byte _cmdReceivedBufferIndex;
 	boolean cmdSerialDataAvailable();
+	// print the interval table as a CFG frame
+	void printIntervals();
+
+	SensorSnapshot snapshots[2];
+	volatile uint8_t front;	// index of the published snapshot
+	unsigned long snapshotTime;
+	uint16_t sampleCounts[SNAPSHOT_CHANNELS]; // SensorReading::samples at the previous snapshot
+	// fill the back buffer and swap it to the front
+	void publishSnapshot();
+
+#if ENABLE_STATS
+	RunningStats stats[STATS_WINDOWS][SNAPSHOT_CHANNELS];
+	unsigned long statsTime[SNAPSHOT_CHANNELS]; // SensorReading::time of the last value added
+	// add the reading of a channel to all windows if it is new
+	void collectStats(byte channel, const SensorReading &reading);
+#endif
 
 public:
 	void calibration(byte mode);
@@ -57,6 +106,20 @@ public:
 
 	// update all sensor values
 	void update();
+	// ms until the first sensor needs update() again
+	unsigned long idleTime();
+	// most active sampling state of all sensors
+	SamplingState samplingState();
+
+	// latest published snapshot
+	const SensorSnapshot &snapshot();
+
+#if ENABLE_STATS
+	// statistics of a channel since the window was last reset
+	RunningStats &windowStats(byte window, byte channel);
+	// print a channel of a window as a STAT frame and start a new window for it
+	void printStats(byte window, byte channel);
+#endif
 
 	// Get the sensor data
 	double getValueBySensorNumber(int num);
@@ -16,33 +16,27 @@
 
 #include "GravityTDS.h"
 #include "Arduino.h"
-#include <EEPROM.h>
+#include "CalibrationStore.h"
+#include "IdleManager.h"
+#include "LookupTable.h"
+#include "Telemetry.h"
 // #define TdsFactor 0.5 // tds = ec / 2
-#define EEPROM_write(address, p)        \
-  {                                     \
-    int i = 0;                          \
-    byte *pp = (byte *)&(p);            \
-    for (; i < sizeof(p); i++)          \
-      EEPROM.write(address + i, pp[i]); \
-  }
-#define EEPROM_read(address, p)         \
-  {                                     \
-    int i = 0;                          \
-    byte *pp = (byte *)&(p);            \
-    for (; i < sizeof(p); i++)          \
-      pp[i] = EEPROM.read(address + i); \
-  }
 
-GravityTDS::GravityTDS(ISensor *temp) //: pin(A5),  aref(5.0), adcRange(1024.0), kValueAddress(8), kValue(1.0)
+GravityTDS::GravityTDS(GravityTemperature *temp) : sampler(calibrationStore.intervals.value + INTERVAL_TDS_MIN) //: pin(A5),  aref(5.0), adcRange(1024.0), kValueAddress(8), kValue(1.0)
 {
   this->ecTemperature = temp;
   this->pin = A1;
   // this->temperature = 25.0;
   this->aref = 5.0;
   this->adcRange = 1024.0;
-  // this->kValueAddress = 8;
-  this->kValueAddress = 16;
   this->kValue = 1.0;
+  this->sampleInterval = calibrationStore.intervals.value[INTERVAL_TDS_MIN];
+  this->analogValue = 0;
+  this->samples = 0;
+  this->calibrating = false;
+  this->sampleTime = 0;
+  this->dirty = true;
+  this->compensationVersion = 0;
 }
 
 GravityTDS::~GravityTDS() {}
@@ -58,33 +52,88 @@ float GravityTDS::getKvalue()
   return this->kValue;
 }
 
+//********************************************************************************************
+// function name: update ()
+// Function Description: Only records the ADC sample, the value is calculated in getValue()
+//********************************************************************************************
 void GravityTDS::update()
 {
-  analogValue = analogRead(pin);
-  voltage = analogValue / adcRange * aref;
-  ecValue = (133.42 * voltage * voltage * voltage - 255.86 * voltage * voltage + 857.39 * voltage) * kValue;
-  ecValue25 = ecValue / (1.0 + 0.02 * (this->ecTemperature->getValue() - 25.0)); //temperature compensation
+  if (millis() - sampleTime >= sampleInterval)
+  {
+    sampleTime = millis();
+    int previous = analogValue;
+    analogValue = analogRead(pin);
+    samples++;
+    dirty = true;
+    // single samples, the step from the previous sample stands in for the window spread
+    sampler.add(analogValue, abs(analogValue - previous));
+    sampleInterval = sampler.interval();
+  }
+}
+
+//********************************************************************************************
+// function name: refresh ()
+// Function Description: Recalculates TDS only if a new sample or a new temperature arrived
+// since the last calculation
+//********************************************************************************************
+void GravityTDS::refresh()
+{
+  const TemperatureCompensation &compensation = this->ecTemperature->compensation();
+  if (!dirty && compensation.version == compensationVersion)
+    return;
+  dirty = false;
+  compensationVersion = compensation.version;
+
+  // 133.42 * V^3 - 255.86 * V^2 + 857.39 * V, tabulated by ADC code in ConductivityTables.h
+  uint32_t ecValue = lookupTable(tdsCurveTable, CONDUCTIVITY_CODE_ENTRIES, analogValue, CONDUCTIVITY_CODE_STEP_SHIFT);
+  ecValue = (ecValue * compensation.reciprocal[COMP_TDS]) >> TEMP_COMP_SHIFT; //temperature compensation
+  ecValue25 = ecValue * kValue;
   tdsValue = ecValue25 * 0.5;
 }
 
 double GravityTDS::getValue()
 {
+  refresh();
   return tdsValue;
 }
 
+//********************************************************************************************
+// function name: idleTime ()
+// Function Description: Returns the ms until update() takes the next sample
+//********************************************************************************************
+unsigned long GravityTDS::idleTime()
+{
+  return timeUntil(this->sampleTime, this->sampleInterval);
+}
+
+SamplingState GravityTDS::samplingState()
+{
+  return this->sampler.state();
+}
+
+//********************************************************************************************
+// function name: getReading ()
+// Function Description: Returns the value with its acquisition time and quality flags
+//********************************************************************************************
+SensorReading GravityTDS::getReading()
+{
+  SensorReading reading;
+  reading.value = getValue();
+  reading.time = this->sampleTime;
+  reading.samples = this->samples;
+  reading.flags = staleFlag(this->sampleTime) | (this->calibrating ? READING_CALIBRATING : 0);
+  return reading;
+}
+
 float GravityTDS::getEcValue()
 {
+  refresh();
   return ecValue25;
 }
 
 void GravityTDS::readKValues()
 {
-  EEPROM_read(this->kValueAddress, this->kValue);
-  if (EEPROM.read(this->kValueAddress) == 0xFF && EEPROM.read(this->kValueAddress + 1) == 0xFF && EEPROM.read(this->kValueAddress + 2) == 0xFF && EEPROM.read(this->kValueAddress + 3) == 0xFF)
-  {
-    this->kValue = 1.0; // default value: K = 1.0
-    EEPROM_write(this->kValueAddress, this->kValue);
-  }
+  this->kValue = calibrationStore.tds.kValue;
 }
 
 void GravityTDS::calibration(byte mode)
@@ -96,22 +145,21 @@ void GravityTDS::ecCalibration(byte mode)
 {
   // char *cmdReceivedBufferPtr;
   static boolean ecCalibrationFinish = 0;
-  static boolean enterCalibrationFlag = 0;
   float KValueTemp, rawECsolution;
   switch (mode)
   {
   case 0:
-    if (enterCalibrationFlag)
-      Serial.println(F("TDS Command Error"));
+    if (this->calibrating)
+      telemetry.println(F("TDS Command Error"));
     break;
 
   case 1:
-    enterCalibrationFlag = 1;
+    this->calibrating = true;
     ecCalibrationFinish = 0;
-    Serial.println();
-    Serial.println(F(">>>Enter TDS Calibration Mode<<<"));
-    Serial.println(F(">>>Please put the probe into the standard buffer solution : 707ppm(1413us/cm)@25^c <<<"));
-    Serial.println();
+    telemetry.println();
+    telemetry.println(F(">>>Enter TDS Calibration Mode<<<"));
+    telemetry.println(F(">>>Please put the probe into the standard buffer solution : 707ppm(1413us/cm)@25^c <<<"));
+    telemetry.println();
     break;
 
   case 2:
@@ -119,44 +167,46 @@ void GravityTDS::ecCalibration(byte mode)
     //cmdReceivedBufferPtr+=strlen("CALTDS");
     // rawECsolution = /*strtod(cmdReceivedBufferPtr,NULL)*/707/(float)(0.5);
     rawECsolution = 707 / (float)(0.5);
-    rawECsolution = rawECsolution * (1.0 + 0.02 * (this->ecTemperature->getValue() - 25.0));
-    if (enterCalibrationFlag)
+    rawECsolution = rawECsolution * this->ecTemperature->compensation().factor[COMP_TDS];
+    if (this->calibrating)
     {
-      KValueTemp = rawECsolution / (133.42 * voltage * voltage * voltage - 255.86 * voltage * voltage + 857.39 * voltage); //calibrate in the  buffer solution, such as 707ppm(1413us/cm)@25^c
+      KValueTemp = rawECsolution / lookupTable(tdsCurveTable, CONDUCTIVITY_CODE_ENTRIES, analogValue, CONDUCTIVITY_CODE_STEP_SHIFT); //calibrate in the  buffer solution, such as 707ppm(1413us/cm)@25^c
       if ((rawECsolution > 0) && (rawECsolution < 2000) && (KValueTemp > 0.25) && (KValueTemp < 4.0))
       {
-        Serial.println();
-        Serial.print(F(">>>TDS Confirm Successful,K:"));
-        Serial.print(KValueTemp);
-        Serial.println(F(", Send EXITTDS to Save and Exit<<<"));
+        telemetry.println();
+        telemetry.print(F(">>>TDS Confirm Successful,K:"));
+        telemetry.print(KValueTemp);
+        telemetry.println(F(", Send EXITTDS to Save and Exit<<<"));
         kValue = KValueTemp;
+        dirty = true;
         ecCalibrationFinish = 1;
       }
       else
       {
-        Serial.println();
-        Serial.println(F(">>>TDS Confirm Failed,Try Again<<<"));
-        Serial.println();
+        telemetry.println();
+        telemetry.println(F(">>>TDS Confirm Failed,Try Again<<<"));
+        telemetry.println();
         ecCalibrationFinish = 0;
       }
     }
     break;
 
   case 3:
-    if (enterCalibrationFlag)
+    if (this->calibrating)
     {
-      Serial.println();
+      telemetry.println();
       if (ecCalibrationFinish)
       {
-        EEPROM_write(kValueAddress, kValue);
-        Serial.print(F(">>>TDS Calibration Successful,K Value Saved"));
+        calibrationStore.tds.kValue = kValue;
+        calibrationStore.save(CAL_TDS);
+        telemetry.print(F(">>>TDS Calibration Successful,K Value Saved"));
       }
       else
-        Serial.print(F(">>>TDS Calibration Failed"));
-      Serial.println(F(",Exit TDS Calibration Mode<<<"));
-      Serial.println();
+        telemetry.print(F(">>>TDS Calibration Failed"));
+      telemetry.println(F(",Exit TDS Calibration Mode<<<"));
+      telemetry.println();
       ecCalibrationFinish = 0;
-      enterCalibrationFlag = 0;
+      this->calibrating = false;
     }
     break;
   }
@@ -15,6 +15,7 @@
  ****************************************************/
 #pragma once
 #include "ISensor.h"
+#include "GravityTemperature.h"
 #include <Arduino.h>
 
 #define ReceivedBufferLength 10
@@ -22,7 +23,7 @@
 class GravityTDS : public ISensor
 {
 public:
-    GravityTDS(ISensor *);
+    GravityTDS(GravityTemperature *);
     ~GravityTDS();
 
     void setup();  //initialization
@@ -31,32 +32,40 @@ public:
     //void setTemperature(float temp);  //set the temperature and execute temperature compensation
     //void setAref(float value);  //reference voltage on ADC, default 5.0V on Arduino UNO
     //void setAdcRange(float range);  //1024 for 10bit ADC;4096 for 12bit ADC
-    //void setKvalueAddress(int address); //set the EEPROM address to store the k value,default address:0x08
     float getKvalue();
     double getValue();
+    unsigned long idleTime(); // ms until the next sample is due
+    SamplingState samplingState(); // sampling activity, see AdaptiveSampler
+    SensorReading getReading();    // value with acquisition time and quality flags
     float getEcValue();
     //void calibration();
     void calibration(byte mode);
 
 private:
     //point to the temperature sensor pointer
-    ISensor *ecTemperature = NULL;
+    GravityTemperature *ecTemperature = NULL;
     int pin;
     float aref; // default 5.0V on Arduino UNO
     float adcRange;
     float temperature;
-    int kValueAddress;                                //the address of the K value stored in the EEPROM
     char cmdReceivedBuffer[ReceivedBufferLength + 1]; // store the serial cmd from the serial monitor
     byte cmdReceivedBufferIndex;
     char *cmdReceivedBufferPtr;
     float kValue; // k value of the probe,you can calibrate in buffer solution ,such as 706.5ppm(1413us/cm)@25^C
-    float analogValue;
-    float voltage;
-    float ecValue;   //before temperature compensation
+    int analogValue;
     float ecValue25; //after temperature compensation
     float tdsValue;
 
+    unsigned long sampleInterval;
+    AdaptiveSampler sampler; // drives sampleInterval
+    unsigned int samples;    // samples taken since boot
+    bool calibrating;        // between ENTERTDS and EXITTDS
+    unsigned long sampleTime;
+    bool dirty;             // a new sample is waiting to be converted
+    uint8_t compensationVersion; // temperature compensation used by the last calculation
+
     void readKValues();
+    void refresh(); // calculate tds if its inputs changed
     //boolean cmdSerialDataAvailable();
     // byte cmdParse();
     void ecCalibration(byte mode);
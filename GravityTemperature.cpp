@@ -17,11 +17,19 @@
 
 #include "GravityTemperature.h"
 #include <OneWire.h>
+#include "CalibrationStore.h"
 #include "Debug.h"
+#include "IdleManager.h"
+#include "LookupTable.h"
 
-GravityTemperature::GravityTemperature(int pin)
+// k of each compensation, in TemperatureCompensationId order
+static const float compensationCoefficient[COMP_COUNT] PROGMEM = {0.0185, 0.02, 1 / 298.15};
+
+GravityTemperature::GravityTemperature(int pin) : temperature(0), samples(0), valueTime(0), missing(true)
 {
 	this->oneWire = new OneWire(pin);
+	this->_compensation.version = 0;
+	publishCompensation();
 }
 
 GravityTemperature::~GravityTemperature() {}
@@ -38,11 +46,49 @@ void GravityTemperature::setup() {}
 //********************************************************************************************
 void GravityTemperature::update()
 {
-	if (millis() - tempSampleTime >= tempSampleInterval)
+	if (millis() - tempSampleTime >= calibrationStore.intervals.value[INTERVAL_TEMPERATURE])
 	{
 		tempSampleTime = millis();
-		temperature = TempProcess(ReadTemperature); // read the current temperature from the  DS18B20
-		TempProcess(StartConvert);					//after the reading,start the convert for next reading
+		double reading = TempProcess(ReadTemperature); // read the current temperature from the  DS18B20
+		if (!missing)
+		{
+			// a failed read keeps the last good temperature instead of 0
+			valueTime = millis();
+			if (reading != temperature)
+			{
+				temperature = reading;
+				publishCompensation();
+			}
+		}
+		TempProcess(StartConvert); //after the reading,start the convert for next reading
+		samples++;
+	}
+}
+
+//********************************************************************************************
+// function name: compensation ()
+// Function Description: Returns the compensation record of the current temperature.
+// Consumers keep the version they used and only recalculate when it changes.
+//********************************************************************************************
+const TemperatureCompensation &GravityTemperature::compensation()
+{
+	return this->_compensation;
+}
+
+//********************************************************************************************
+// function name: publishCompensation ()
+// Function Description: Calculates every compensation factor once per new temperature
+//********************************************************************************************
+void GravityTemperature::publishCompensation()
+{
+	static const uint16_t *const tables[COMP_COUNT] = {ecCompensationTable, tdsCompensationTable, nernstCompensationTable};
+
+	this->_compensation.version++;
+	this->_compensation.temperature = temperature;
+	for (byte i = 0; i < COMP_COUNT; i++)
+	{
+		this->_compensation.factor[i] = 1.0 + pgm_read_float(&compensationCoefficient[i]) * (temperature - 25.0);
+		this->_compensation.reciprocal[i] = temperatureCompensation(tables[i], temperature);
 	}
 }
 
@@ -55,6 +101,29 @@ double GravityTemperature::getValue()
 	return temperature;
 }
 
+//********************************************************************************************
+// function name: idleTime ()
+// Function Description: Returns the ms until update() takes the next sample
+//********************************************************************************************
+unsigned long GravityTemperature::idleTime()
+{
+	return timeUntil(this->tempSampleTime, calibrationStore.intervals.value[INTERVAL_TEMPERATURE]);
+}
+
+//********************************************************************************************
+// function name: getReading ()
+// Function Description: Returns the temperature with its acquisition time and quality flags
+//********************************************************************************************
+SensorReading GravityTemperature::getReading()
+{
+	SensorReading reading;
+	reading.value = this->temperature;
+	reading.time = this->valueTime;
+	reading.samples = this->samples;
+	reading.flags = staleFlag(this->valueTime) | (this->missing ? READING_MISSING : 0);
+	return reading;
+}
+
 //********************************************************************************************
 // function name: TempProcess ()
 // Function Description: Analyze the temperature data
@@ -70,16 +139,19 @@ double GravityTemperature::TempProcess(bool ch)
 		{
 			Debug::println("no temperature sensors on chain, reset search!");
 			oneWire->reset_search();
+			missing = true;
 			return 0;
 		}
 		if (OneWire::crc8(addr, 7) != addr[7])
 		{
 			Debug::println("CRC is not valid!");
+			missing = true;
 			return 0;
 		}
 		if (addr[0] != 0x10 && addr[0] != 0x28)
 		{
 			Debug::println("Device is not recognized!");
+			missing = true;
 			return 0;
 		}
 		oneWire->reset();
@@ -96,6 +168,9 @@ double GravityTemperature::TempProcess(bool ch)
 			data[i] = oneWire->read();
 		}
 		oneWire->reset_search();
+		missing = !present || OneWire::crc8(data, 8) != data[8];
+		if (missing)
+			return TemperatureSum;
 		byte MSB = data[1];
 		byte LSB = data[0];
 		float tempRead = ((MSB << 8) | LSB); //using two's compliment
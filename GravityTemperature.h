@@ -21,6 +21,23 @@
 #define StartConvert 0
 #define ReadTemperature 1
 
+// temperature compensations published with every new reading
+enum TemperatureCompensationId
+{
+	COMP_EC = 0, // conductivity, k = 0.0185
+	COMP_TDS,	 // tds probe, k = 0.02
+	COMP_NERNST, // pH probe slope, k = 1 / 298.15
+	COMP_COUNT
+};
+
+struct TemperatureCompensation
+{
+	uint8_t version;				 // changes whenever the temperature changes
+	float temperature;				 // C
+	float factor[COMP_COUNT];		 // 1 + k * (T - 25)
+	uint16_t reciprocal[COMP_COUNT]; // 1 / factor in Q14 (TEMP_COMP_SHIFT)
+};
+
 class GravityTemperature : public ISensor
 {
 public:
@@ -40,14 +57,28 @@ public:
 
 	// Get the sensor data
 	double getValue();
+	// ms until the next sample is due
+	unsigned long idleTime();
+	// value with acquisition time and quality flags
+	SensorReading getReading();
 
 	void calibration(byte mode);
 
+	// compensation factors for the current temperature, shared by all compensated sensors
+	const TemperatureCompensation &compensation();
+
 private:
+	TemperatureCompensation _compensation;
+
 	OneWire *oneWire;
-	unsigned long tempSampleInterval = 850;
 	unsigned long tempSampleTime;
+	unsigned int samples;	 // readings taken since boot
+	unsigned long valueTime; // millis() of the last good reading
+	bool missing;			 // the last conversion could not be started or read
 
 	// Analyze temperature data
 	double TempProcess(bool ch);
+
+	// recalculate the compensation record
+	void publishCompensation();
 };
@@ -0,0 +1,301 @@
+/*********************************************************************
+* HistoryLog.cpp
+*
+* Description: Per-minute history ring with replay
+*
+* version :  V1.0
+* date    :  2026-10-19
+**********************************************************************/
+
+#include "HistoryLog.h"
+
+#if ENABLE_HISTORY
+
+#include "Telemetry.h"
+
+#define HISTORY_FILE "HISTORY.BIN"
+#define HISTORY_SNAPSHOTS (60000UL / SNAPSHOT_INTERVAL) // snapshots per minute record
+
+// fixed point factor of each channel: pH, temperature, TDS, EC, ORP
+static const int16_t historyScale[SNAPSHOT_CHANNELS] PROGMEM = {100, 100, 1, 100, 1};
+static const uint8_t historyDecimals[SNAPSHOT_CHANNELS] PROGMEM = {2, 2, 0, 2, 0};
+
+// mean of a channel in fixed point, HISTORY_NO_DATA without values
+static int16_t toFixed(float sum, uint8_t count, byte channel)
+{
+	if (count == 0)
+		return HISTORY_NO_DATA;
+	float value = sum / count * (int16_t)pgm_read_word(&historyScale[channel]);
+	if (value > 32767)
+		return 32767;
+	if (value < -32767)
+		return -32767;
+	return (int16_t)(value < 0 ? value - 0.5f : value + 0.5f);
+}
+
+HistoryLog::HistoryLog(GravitySensorHub *hub) : sensorHub(hub), snapshotSequence(0), nextSequence(0),
+												minutesHead(0), minutesUsed(0), blocksHead(0), blocksUsed(0),
+												replayActive(false), replaySequence(0)
+{
+	resetMinute();
+	this->block.minutes = 0;
+}
+
+HistoryLog::~HistoryLog() {}
+
+//********************************************************************************************
+// function name: setup ()
+// Function Description: Continues the sequence of HISTORY.BIN when a card is present
+//********************************************************************************************
+void HistoryLog::setup(SdFile *directory)
+{
+#if ENABLE_SD_LOG
+	if (directory == NULL || !this->file.open(directory, HISTORY_FILE, O_RDWR | O_CREAT))
+		return;
+	this->nextSequence = this->file.fileSize() / sizeof(HistoryRecord);
+#endif
+}
+
+//********************************************************************************************
+// function name: update ()
+// Function Description: Takes in every new snapshot and sends the next replay frame
+//********************************************************************************************
+void HistoryLog::update()
+{
+	const SensorSnapshot &snapshot = this->sensorHub->snapshot();
+	if (snapshot.sequence != this->snapshotSequence)
+	{
+		this->snapshotSequence = snapshot.sequence;
+		addSnapshot(snapshot);
+	}
+
+	if (!this->replayActive || !telemetry.beginFrame(HISTORY_FRAME_RESERVE))
+		return;
+
+	if (this->replaySequence >= this->nextSequence)
+	{
+		telemetry.print(F("HISTEND@"));
+		telemetry.println(this->nextSequence);
+		this->replayActive = false;
+		return;
+	}
+
+	HistoryRecord record;
+	if (findRecord(this->replaySequence, record))
+	{
+		printRecord(record);
+		this->replaySequence = record.sequence + record.minutes;
+	}
+	else
+	{
+		this->replaySequence = nextAvailable(this->replaySequence);
+	}
+}
+
+void HistoryLog::replay(unsigned long sequence)
+{
+	this->replaySequence = sequence;
+	this->replayActive = true;
+}
+
+bool HistoryLog::replaying()
+{
+	return this->replayActive;
+}
+
+void HistoryLog::addSnapshot(const SensorSnapshot &snapshot)
+{
+	if (this->minuteSnapshots == 0)
+		this->minuteTime = snapshot.time;
+	for (byte i = 0; i < SNAPSHOT_CHANNELS; i++)
+	{
+		this->minuteFlags |= snapshot.flags[i];
+		if (snapshot.flags[i] & READING_MISSING)
+			continue;
+		this->minuteSum[i] += snapshot.value[i];
+		this->minuteCount[i]++;
+	}
+	if (++this->minuteSnapshots >= HISTORY_SNAPSHOTS)
+		closeMinute();
+}
+
+//********************************************************************************************
+// function name: closeMinute ()
+// Function Description: Stores the minute in the ring and on the card, the minute it pushes
+// out of the ring is folded into the current block
+//********************************************************************************************
+void HistoryLog::closeMinute()
+{
+	HistoryRecord record;
+	record.sequence = this->nextSequence;
+	record.time = this->minuteTime;
+	for (byte i = 0; i < SNAPSHOT_CHANNELS; i++)
+	{
+		record.value[i] = toFixed(this->minuteSum[i], this->minuteCount[i], i);
+	}
+	record.minutes = 1;
+	record.flags = this->minuteFlags;
+
+	if (this->minutesUsed == HISTORY_MINUTES)
+		foldMinute(this->minutes[this->minutesHead]);
+	else
+		this->minutesUsed++;
+	this->minutes[this->minutesHead] = record;
+	this->minutesHead = (this->minutesHead + 1) % HISTORY_MINUTES;
+
+#if ENABLE_SD_LOG
+	if (this->file.isOpen() && this->file.seekSet(record.sequence * sizeof(HistoryRecord)))
+	{
+		this->file.write((const uint8_t *)&record, sizeof(record));
+		this->file.sync();
+	}
+#endif
+
+	this->nextSequence++;
+	resetMinute();
+}
+
+void HistoryLog::resetMinute()
+{
+	for (byte i = 0; i < SNAPSHOT_CHANNELS; i++)
+	{
+		this->minuteSum[i] = 0;
+		this->minuteCount[i] = 0;
+	}
+	this->minuteSnapshots = 0;
+	this->minuteFlags = 0;
+	this->minuteTime = 0;
+}
+
+//********************************************************************************************
+// function name: foldMinute ()
+// Function Description: Averages a minute into the block of HISTORY_BLOCK_MINUTES it belongs
+// to, blocks are aligned to multiples of HISTORY_BLOCK_MINUTES
+//********************************************************************************************
+void HistoryLog::foldMinute(const HistoryRecord &minute)
+{
+	if (this->block.minutes > 0 &&
+		minute.sequence / HISTORY_BLOCK_MINUTES != this->block.sequence / HISTORY_BLOCK_MINUTES)
+		closeBlock();
+
+	if (this->block.minutes == 0)
+	{
+		this->block.sequence = minute.sequence;
+		this->block.time = minute.time;
+		this->block.flags = 0;
+		for (byte i = 0; i < SNAPSHOT_CHANNELS; i++)
+		{
+			this->blockSum[i] = 0;
+			this->blockCount[i] = 0;
+		}
+	}
+
+	for (byte i = 0; i < SNAPSHOT_CHANNELS; i++)
+	{
+		if (minute.value[i] == HISTORY_NO_DATA)
+			continue;
+		this->blockSum[i] += minute.value[i];
+		this->blockCount[i]++;
+	}
+	this->block.minutes++;
+	this->block.flags |= minute.flags;
+}
+
+void HistoryLog::closeBlock()
+{
+	blockRecord(this->blocks[this->blocksHead]);
+	this->blocksHead = (this->blocksHead + 1) % HISTORY_BLOCKS;
+	if (this->blocksUsed < HISTORY_BLOCKS)
+		this->blocksUsed++;
+	this->block.minutes = 0;
+}
+
+void HistoryLog::blockRecord(HistoryRecord &record)
+{
+	record = this->block;
+	for (byte i = 0; i < SNAPSHOT_CHANNELS; i++)
+	{
+		record.value[i] = this->blockCount[i] ? this->blockSum[i] / this->blockCount[i] : HISTORY_NO_DATA;
+	}
+}
+
+//********************************************************************************************
+// function name: findRecord ()
+// Function Description: Looks a sequence up in the minute ring, on the card and in the blocks
+//********************************************************************************************
+bool HistoryLog::findRecord(unsigned long sequence, HistoryRecord &record)
+{
+	if (sequence < this->nextSequence && this->nextSequence - sequence <= this->minutesUsed)
+	{
+		record = this->minutes[(this->minutesHead + HISTORY_MINUTES - (this->nextSequence - sequence)) % HISTORY_MINUTES];
+		return true;
+	}
+
+#if ENABLE_SD_LOG
+	if (this->file.isOpen() && this->file.seekSet(sequence * sizeof(HistoryRecord)) &&
+		this->file.read(&record, sizeof(HistoryRecord)) == sizeof(HistoryRecord) && record.sequence == sequence)
+	{
+		return true;
+	}
+#endif
+
+	if (this->block.minutes > 0 && sequence >= this->block.sequence &&
+		sequence < this->block.sequence + this->block.minutes)
+	{
+		blockRecord(record);
+		return true;
+	}
+
+	for (byte i = 0; i < this->blocksUsed; i++)
+	{
+		const HistoryRecord &candidate = this->blocks[i];
+		if (sequence >= candidate.sequence && sequence < candidate.sequence + candidate.minutes)
+		{
+			record = candidate;
+			return true;
+		}
+	}
+	return false;
+}
+
+//********************************************************************************************
+// function name: nextAvailable ()
+// Function Description: Skips the part of a replay that is no longer kept
+//********************************************************************************************
+unsigned long HistoryLog::nextAvailable(unsigned long sequence)
+{
+	unsigned long next = this->nextSequence - this->minutesUsed;
+	if (this->block.minutes > 0 && this->block.sequence > sequence && this->block.sequence < next)
+		next = this->block.sequence;
+	for (byte i = 0; i < this->blocksUsed; i++)
+	{
+		if (this->blocks[i].sequence > sequence && this->blocks[i].sequence < next)
+			next = this->blocks[i].sequence;
+	}
+	return next > sequence ? next : sequence + 1;
+}
+
+//********************************************************************************************
+// function name: printRecord ()
+// Function Description: HIST@sequence,epoch,minutes,pH,temp,tds,ec,orp,flags
+//********************************************************************************************
+void HistoryLog::printRecord(const HistoryRecord &record)
+{
+	telemetry.print(F("HIST@"));
+	telemetry.print(record.sequence);
+	telemetry.print(',');
+	telemetry.print(record.time);
+	telemetry.print(',');
+	telemetry.print(record.minutes);
+	for (byte i = 0; i < SNAPSHOT_CHANNELS; i++)
+	{
+		telemetry.print(',');
+		if (record.value[i] != HISTORY_NO_DATA)
+			telemetry.print((float)record.value[i] / (int16_t)pgm_read_word(&historyScale[i]),
+							pgm_read_byte(&historyDecimals[i]));
+	}
+	telemetry.print(',');
+	telemetry.println(record.flags, HEX);
+}
+
+#endif // ENABLE_HISTORY
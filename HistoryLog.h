@@ -0,0 +1,118 @@
+/*********************************************************************
+* HistoryLog.h
+*
+* Description: On-device history for store-and-forward after a link
+* outage. Every snapshot is averaged into a per-minute record with a
+* sequence number. The last HISTORY_MINUTES records stay in RAM, older
+* minutes are folded into HISTORY_BLOCK_MINUTES blocks so the RAM ring
+* covers an hour with the defaults at a coarser resolution. With a card present every
+* minute record is also appended to HISTORY.BIN, indexed by sequence,
+* and the sequence continues across resets. The file stays open.
+*
+* "REPLAY n" streams every record from sequence n on, one frame per
+* loop pass, at the best resolution still available:
+* "HIST@sequence,epoch,minutes,pH,temp,tds,ec,orp,flags"
+* minutes is 1 for a minute record and HISTORY_BLOCK_MINUTES for a
+* block, which covers sequence .. sequence + minutes - 1. flags are the
+* READING_* flags of all channels in that time or'ed together.
+* "HISTEND@next" ends the replay with the next sequence to be written.
+*
+* version :  V1.0
+* date    :  2026-10-19
+**********************************************************************/
+
+#pragma once
+#include <Arduino.h>
+#include "config.h"
+#include "GravitySensorHub.h"
+#if ENABLE_SD_LOG
+#include <SD.h>
+#else
+class SdFile;
+#endif
+
+// "HIST@" sequence "," epoch "," minutes, "," value per channel, "," flags "\r\n",
+// a value is at most "-327.67" or "-32767"
+#define HISTORY_FRAME_RESERVE (5 + 10 + 1 + 10 + 1 + 3 + SNAPSHOT_CHANNELS * (1 + 7) + 1 + 2 + 2)
+
+#if ENABLE_HISTORY
+
+#define HISTORY_NO_DATA (-32768) // HistoryRecord::value of a channel without any reading
+
+struct HistoryRecord
+{
+	unsigned long sequence;			  // first minute covered
+	unsigned long time;				  // epoch of the first snapshot
+	int16_t value[SNAPSHOT_CHANNELS]; // mean in fixed point, see historyScale
+	uint8_t minutes;				  // minutes covered
+	uint8_t flags;					  // READING_* of all channels
+};
+
+class HistoryLog
+{
+public:
+	HistoryLog(GravitySensorHub *hub);
+	~HistoryLog();
+
+	// take up the sequence of HISTORY.BIN, directory is NULL without a card
+	void setup(SdFile *directory);
+
+	// average new snapshots and stream a running replay
+	void update();
+
+	// start a replay from the given sequence
+	void replay(unsigned long sequence);
+
+	// a replay is being streamed
+	bool replaying();
+
+private:
+	GravitySensorHub *sensorHub;
+	unsigned long snapshotSequence; // last snapshot taken in
+	unsigned long nextSequence;		// sequence of the minute being accumulated
+#if ENABLE_SD_LOG
+	SdFile file; // HISTORY.BIN, open while a card is present
+#endif
+
+	// minute being accumulated from snapshots
+	unsigned long minuteTime;
+	float minuteSum[SNAPSHOT_CHANNELS];
+	uint8_t minuteCount[SNAPSHOT_CHANNELS];
+	uint8_t minuteSnapshots;
+	uint8_t minuteFlags;
+
+	// last minutes at full resolution, the newest is nextSequence - 1
+	HistoryRecord minutes[HISTORY_MINUTES];
+	uint8_t minutesHead;
+	uint8_t minutesUsed;
+
+	// block being folded from the minutes that leave the ring, empty while block.minutes is 0
+	HistoryRecord block;
+	long blockSum[SNAPSHOT_CHANNELS];
+	uint8_t blockCount[SNAPSHOT_CHANNELS];
+
+	// closed blocks, oldest first from blocksHead once the ring is full
+	HistoryRecord blocks[HISTORY_BLOCKS];
+	uint8_t blocksHead;
+	uint8_t blocksUsed;
+
+	bool replayActive;
+	unsigned long replaySequence; // next sequence to send
+
+	void addSnapshot(const SensorSnapshot &snapshot);
+	void closeMinute();
+	void resetMinute();
+	void foldMinute(const HistoryRecord &minute);
+	void closeBlock();
+	// the block folded so far as a record
+	void blockRecord(HistoryRecord &record);
+	// record covering a sequence at the best resolution available, false if it is gone
+	bool findRecord(unsigned long sequence, HistoryRecord &record);
+	// first sequence after the given one that is still available
+	unsigned long nextAvailable(unsigned long sequence);
+	void printRecord(const HistoryRecord &record);
+};
+
+extern HistoryLog history;
+
+#endif // ENABLE_HISTORY
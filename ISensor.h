@@ -16,6 +16,25 @@
 **********************************************************************/
 #pragma once
 #include <Arduino.h>
+#include "AdaptiveSampler.h"
+#include "config.h"
+
+// SensorReading::flags
+#define READING_STALE 0x01		 // no new value for SENSOR_STALE_TIME
+#define READING_CLAMPED 0x02	 // the input was outside the conversion range, value is the limit
+#define READING_MISSING 0x04	 // the sensor did not answer, value is the last good one
+#define READING_CALIBRATING 0x08 // calibration mode is active
+#define READING_BURST 0x10		 // the channel samples at its burst rate
+
+// a value together with what the driver knows about it
+struct SensorReading
+{
+	float value;
+	unsigned long time; // millis() when the value was acquired
+	uint16_t samples;	// samples taken since boot, wraps around
+	uint8_t flags;		// READING_*
+};
+
 class ISensor
 {
 public:
@@ -23,4 +42,25 @@ public:
 	virtual void update() = 0;
 	virtual void calibration(byte mode) = 0;
 	virtual double getValue() = 0;
+	// ms until update() has work to do again, 0 if it has to be called on every pass
+	virtual unsigned long idleTime() { return 0; }
+	// how actively the sensor samples, fixed rate sensors count as stable
+	virtual SamplingState samplingState() { return SAMPLING_STABLE; }
+	// value with acquisition time, sample count and quality flags
+	virtual SensorReading getReading()
+	{
+		SensorReading reading;
+		reading.value = getValue();
+		reading.time = millis();
+		reading.samples = 0;
+		reading.flags = 0;
+		return reading;
+	}
+
+protected:
+	// READING_STALE if the value acquired at time is too old
+	static uint8_t staleFlag(unsigned long time)
+	{
+		return millis() - time > SENSOR_STALE_TIME ? READING_STALE : 0;
+	}
 };
@@ -0,0 +1,93 @@
+/*********************************************************************
+* IdleManager.cpp
+*
+* Description: Sleep between scheduled work
+*
+* version :  V1.0
+* date    :  2026-10-19
+**********************************************************************/
+
+#include "IdleManager.h"
+
+#if ENABLE_SLEEP
+
+#include "Telemetry.h"
+#if defined(__AVR__)
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+#endif
+
+IdleManager::IdleManager() : sleptTime(0), awakeTime(0), sleeps(0), woken(false),
+							 lastWake(0), sleptMicros(0), awakeMicros(0) {}
+
+IdleManager::~IdleManager() {}
+
+//********************************************************************************************
+// function name: sleep ()
+// Function Description: Sleeps in idle mode until ms have passed, a serial byte arrived or
+// wake() was called. Every interrupt wakes the CPU, the Timer0 tick included, so the
+// deadline is checked again after each one.
+//********************************************************************************************
+void IdleManager::sleep(unsigned long ms)
+{
+	unsigned long start = micros();
+	this->awakeMicros += start - this->lastWake;
+
+	if (ms > 0 && Serial.available() == 0)
+	{
+		this->woken = false;
+		this->sleeps++;
+		unsigned long begin = millis();
+		while (!this->woken && millis() - begin < ms && Serial.available() == 0)
+		{
+#if defined(__AVR__)
+			set_sleep_mode(SLEEP_MODE_IDLE);
+			cli();
+			if (!this->woken)
+			{
+				sleep_enable();
+				sei(); // the instruction after sei is executed before any interrupt, no wake is lost
+				sleep_cpu();
+				sleep_disable();
+			}
+			sei();
+#endif
+		}
+	}
+
+	this->lastWake = micros();
+	this->sleptMicros += this->lastWake - start;
+
+	this->sleptTime += this->sleptMicros / 1000;
+	this->sleptMicros %= 1000;
+	this->awakeTime += this->awakeMicros / 1000;
+	this->awakeMicros %= 1000;
+}
+
+//********************************************************************************************
+// function name: wake ()
+// Function Description: Makes the running sleep() return after the current interrupt
+//********************************************************************************************
+void IdleManager::wake()
+{
+	this->woken = true;
+}
+
+//********************************************************************************************
+// function name: printCounters ()
+// Function Description: POWER@slept ms,awake ms,sleeps,duty cycle in 0.1%
+//********************************************************************************************
+void IdleManager::printCounters()
+{
+	unsigned long total = this->sleptTime + this->awakeTime;
+	telemetry.print(F("POWER@"));
+	telemetry.print(this->sleptTime);
+	telemetry.print(',');
+	telemetry.print(this->awakeTime);
+	telemetry.print(',');
+	telemetry.print(this->sleeps);
+	telemetry.print(',');
+	telemetry.println(total ? (unsigned long)((uint64_t)this->awakeTime * 1000 / total) : 1000UL);
+}
+
+#endif // ENABLE_SLEEP
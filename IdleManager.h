@@ -0,0 +1,68 @@
+/*********************************************************************
+* IdleManager.h
+*
+* Description: Puts the MCU to sleep while every task waits for a
+* future deadline. Each task reports how long it can stay idle (ms),
+* loop() passes the shortest time to sleep() at the end of a pass.
+*
+* The AVR sleeps in idle mode, so Timer0 keeps running and millis()
+* needs no correction. The CPU wakes on the Timer0 tick, USART RX/TX,
+* the water level pin change or any other enabled interrupt, and goes
+* back to sleep until the deadline unless a byte arrived or wake() was
+* called. ADC noise reduction mode is not used: it stops Timer0 and the
+* USART, so millis() would fall behind and serial commands would be lost.
+*
+* Off target there is no sleep instruction, sleep() waits for the
+* deadline the same way and the POWER counters give the modelled duty
+* cycle.
+*
+* version :  V1.0
+* date    :  2026-10-19
+**********************************************************************/
+
+#pragma once
+#include <Arduino.h>
+#include "config.h"
+
+#define IDLE_FOREVER 0xFFFFFFFFUL // no deadline, only an event ends the sleep
+
+// ms until interval has passed since start, 0 once it has
+inline unsigned long timeUntil(unsigned long start, unsigned long interval)
+{
+	unsigned long elapsed = millis() - start;
+	return elapsed >= interval ? 0 : interval - elapsed;
+}
+
+#if ENABLE_SLEEP
+
+class IdleManager
+{
+public:
+	// counters since boot
+	unsigned long sleptTime; // ms spent asleep
+	unsigned long awakeTime; // ms spent running loop()
+	unsigned long sleeps;	 // sleep() calls that actually slept
+
+public:
+	IdleManager();
+	~IdleManager();
+
+	// sleep for up to ms, returns early on serial input or wake()
+	void sleep(unsigned long ms);
+
+	// end the current sleep, safe from interrupt context
+	void wake();
+
+	// print the counters as a POWER frame
+	void printCounters();
+
+private:
+	volatile bool woken;
+	unsigned long lastWake;	 // micros() when loop() resumed
+	unsigned long sleptMicros; // below 1 ms, carried to the next sleep
+	unsigned long awakeMicros;
+};
+
+extern IdleManager idle;
+
+#endif // ENABLE_SLEEP
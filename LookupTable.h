@@ -0,0 +1,44 @@
+/*********************************************************************
+* LookupTable.h
+*
+* Description: Linear interpolation in uint16_t tables stored in PROGMEM
+*
+* version :  V1.0
+* date    :  2026-10-19
+**********************************************************************/
+
+#pragma once
+#include <Arduino.h>
+#include <avr/pgmspace.h>
+#include "ConductivityTables.h"
+
+//********************************************************************************************
+// function name: lookupTable ()
+// Function Description: Interpolates a table whose entries are 2^shift input units apart.
+// Inputs past the last entry return the last entry.
+// Parameters: table  PROGMEM table
+// Parameters: count  number of entries
+// Parameters: x      input in table units, fixed point with shift fractional bits
+//********************************************************************************************
+inline uint16_t lookupTable(const uint16_t *table, uint8_t count, uint32_t x, uint8_t shift)
+{
+	uint32_t index = x >> shift;
+	if (index >= (uint32_t)(count - 1))
+		return pgm_read_word(&table[count - 1]);
+	int32_t a = pgm_read_word(&table[index]);
+	int32_t b = pgm_read_word(&table[index + 1]);
+	uint32_t frac = x & (((uint32_t)1 << shift) - 1);
+	return a + (((b - a) * (int32_t)frac) >> shift);
+}
+
+//********************************************************************************************
+// function name: temperatureCompensation ()
+// Function Description: Q14 reciprocal of a (1 + k * (T - 25)) compensation table
+//********************************************************************************************
+inline uint16_t temperatureCompensation(const uint16_t *table, double temperature)
+{
+	int16_t t = (int16_t)(temperature * (1 << TEMP_COMP_FRAC_SHIFT)) - (TEMP_COMP_MIN << TEMP_COMP_FRAC_SHIFT);
+	if (t < 0)
+		t = 0;
+	return lookupTable(table, TEMP_COMP_ENTRIES, t, TEMP_COMP_FRAC_SHIFT);
+}
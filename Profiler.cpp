@@ -0,0 +1,98 @@
+/*********************************************************************
+* Profiler.cpp
+*
+* Description: Per-stage loop profiler
+*
+* version :  V1.0
+* date    :  2026-10-19
+**********************************************************************/
+
+#include "Profiler.h"
+
+#if ENABLE_PROFILER
+
+#include "Telemetry.h"
+
+Profiler::Profiler() : reportStage(-1)
+{
+	reset();
+}
+
+Profiler::~Profiler() {}
+
+//********************************************************************************************
+// function name: record ()
+// Function Description: Adds one duration to the statistics of a stage
+// Parameters: stage     ProfileStage
+// Parameters: duration  us
+//********************************************************************************************
+void Profiler::record(byte stage, unsigned long duration)
+{
+	if (stage >= PROFILE_STAGE_COUNT)
+		return;
+	StageStats &s = this->stats[stage];
+	if (s.count == 0 || duration < s.min)
+		s.min = duration;
+	if (duration > s.max)
+		s.max = duration;
+	s.count++;
+	s.sum += duration;
+
+	byte bucket = 0;
+	for (unsigned long d = duration >> 3; d > 1 && bucket < PROFILE_BUCKETS - 1; d >>= 1)
+		bucket++;
+	if (s.histogram[bucket] < 255)
+		s.histogram[bucket]++;
+}
+
+void Profiler::requestReport()
+{
+	this->reportStage = 0;
+}
+
+bool Profiler::reporting()
+{
+	return this->reportStage >= 0;
+}
+
+//********************************************************************************************
+// function name: update ()
+// Function Description: Streams one PROFILE frame per call while a report is requested,
+// the statistics are reset after the last stage
+//********************************************************************************************
+void Profiler::update()
+{
+	if (this->reportStage < 0 || !telemetry.beginFrame(PROFILE_FRAME_RESERVE))
+		return;
+
+	StageStats &s = this->stats[this->reportStage];
+	telemetry.print(F("PROFILE@"));
+	telemetry.print(this->reportStage);
+	telemetry.print(',');
+	telemetry.print(s.count);
+	telemetry.print(',');
+	telemetry.print(s.min);
+	telemetry.print(',');
+	telemetry.print(s.max);
+	telemetry.print(',');
+	telemetry.print(s.count ? (unsigned long)(s.sum / s.count) : 0UL);
+	for (byte i = 0; i < PROFILE_BUCKETS; i++)
+	{
+		telemetry.print(i == 0 ? ',' : '/');
+		telemetry.print(s.histogram[i]);
+	}
+	telemetry.println();
+
+	if (++this->reportStage == PROFILE_STAGE_COUNT)
+	{
+		this->reportStage = -1;
+		reset();
+	}
+}
+
+void Profiler::reset()
+{
+	memset(this->stats, 0, sizeof(this->stats));
+}
+
+#endif // ENABLE_PROFILER
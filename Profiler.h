@@ -0,0 +1,98 @@
+/*********************************************************************
+* Profiler.h
+*
+* Description: Per-stage loop profiler. Every stage of loop() and every
+* ISensor::update() is timed with micros() (Timer0, 4us resolution) and
+* keeps min/max/mean and a log2 latency histogram. The PROFILE command
+* streams one PROFILE frame per stage and then starts a new window:
+* "PROFILE@stage,count,min,max,mean,h0/h1/.../h15" (us)
+* Histogram bucket 0 counts durations below 16us, bucket n durations in
+* [2^(n+3), 2^(n+4)) us and bucket 15 everything from 262ms up.
+*
+* Everything expands to nothing unless ENABLE_PROFILER is set in config.h.
+*
+* version :  V1.0
+* date    :  2026-10-19
+**********************************************************************/
+
+#pragma once
+#include <Arduino.h>
+#include "config.h"
+
+#define PROFILE_SENSOR_COUNT 5 // sensors timed individually, see GravitySensorHub::sensors
+#define PROFILE_BUCKETS 16
+#define PROFILE_FRAME_RESERVE 120
+
+enum ProfileStage
+{
+	PROFILE_LOOP = 0,
+	PROFILE_RTC,
+	PROFILE_SENSORS,
+	PROFILE_SD,
+	PROFILE_REPORT,
+	PROFILE_CALIBRATE,
+	PROFILE_SENSOR0, // PROFILE_SENSOR0 + n times sensors[n]->update()
+	PROFILE_STAGE_COUNT = PROFILE_SENSOR0 + PROFILE_SENSOR_COUNT
+};
+
+#if ENABLE_PROFILER
+
+class Profiler
+{
+public:
+	Profiler();
+	~Profiler();
+
+	// add one measurement
+	void record(byte stage, unsigned long duration);
+
+	// start streaming the report
+	void requestReport();
+
+	// send the next report frame when telemetry has room
+	void update();
+
+	// a report is being streamed
+	bool reporting();
+
+private:
+	struct StageStats
+	{
+		unsigned long count;
+		unsigned long min;
+		unsigned long max;
+		uint64_t sum;
+		uint8_t histogram[PROFILE_BUCKETS]; // saturates at 255
+	};
+
+	StageStats stats[PROFILE_STAGE_COUNT];
+	int8_t reportStage; // next stage to report, -1 when idle
+
+	void reset();
+};
+
+extern Profiler profiler;
+
+// times the rest of the enclosing block
+class ProfileScope
+{
+public:
+	ProfileScope(byte stage) : stage(stage), start(micros()) {}
+	~ProfileScope() { profiler.record(this->stage, micros() - this->start); }
+
+private:
+	byte stage;
+	unsigned long start;
+};
+
+#define PROFILE_BEGIN(stage) unsigned long profileStart_##stage = micros()
+#define PROFILE_END(stage) profiler.record(stage, micros() - profileStart_##stage)
+#define PROFILE_SCOPE(stage) ProfileScope profileScope(stage)
+
+#else
+
+#define PROFILE_BEGIN(stage)
+#define PROFILE_END(stage)
+#define PROFILE_SCOPE(stage)
+
+#endif // ENABLE_PROFILER
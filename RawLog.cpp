@@ -0,0 +1,133 @@
+/*********************************************************************
+* RawLog.cpp
+*
+* Description: Raw block log for SdService
+*
+* version :  V1.0
+* date    :  2026-10-19
+**********************************************************************/
+
+#include "RawLog.h"
+
+#if SD_RAW_LOG
+
+#include "Crc.h"
+#include "Debug.h"
+
+static_assert(sizeof(RawSector) == RAW_BLOCK_SIZE, "RawSector must fill one block");
+
+RawLog::RawLog() : card(NULL), head(0) {}
+
+RawLog::~RawLog() {}
+
+//********************************************************************************************
+// function name: begin ()
+// Function Description: Checks the region against the partition table and finds the head.
+// The first block and the blocks after it carry consecutive sequences up to the head, a
+// binary search finds the last of them. An invalid first block with a valid last block
+// means the first block was torn while the ring wrapped around.
+//********************************************************************************************
+bool RawLog::begin(Sd2Card *card)
+{
+	this->card = card;
+	if (!regionFree())
+	{
+		Debug::println(F("raw log region overlaps a partition"));
+		return false;
+	}
+
+	unsigned long first = sequenceAt(0);
+	if (first == 0)
+	{
+		unsigned long last = sequenceAt(SD_RAW_BLOCKS - 1);
+		this->head = SD_RAW_BLOCKS - 1;
+		if (last == 0)
+		{
+			this->head = 0;
+			startSector(1);
+			return true;
+		}
+	}
+	else
+	{
+		unsigned long low = 0, high = SD_RAW_BLOCKS - 1;
+		while (low < high)
+		{
+			unsigned long middle = (low + high + 1) / 2;
+			if (sequenceAt(middle) == first + middle)
+				low = middle;
+			else
+				high = middle - 1;
+		}
+		this->head = low;
+	}
+
+	if (!readSector(this->head))
+		return false;
+	if (this->sector.count >= RAW_RECORDS)
+	{
+		this->head = (this->head + 1) % SD_RAW_BLOCKS;
+		startSector(this->sector.sequence + 1);
+	}
+	return true;
+}
+
+//********************************************************************************************
+// function name: append ()
+// Function Description: Adds a record to the head block and writes it, a full block moves the
+// head on to the next one
+//********************************************************************************************
+bool RawLog::append(const RawRecord &record)
+{
+	this->sector.record[this->sector.count++] = record;
+	this->sector.crc = crc16(&this->sector, offsetof(RawSector, crc));
+	bool written = this->card->writeBlock(SD_RAW_FIRST_BLOCK + this->head, (const uint8_t *)&this->sector);
+	if (this->sector.count >= RAW_RECORDS)
+	{
+		this->head = (this->head + 1) % SD_RAW_BLOCKS;
+		startSector(this->sector.sequence + 1);
+	}
+	return written;
+}
+
+//********************************************************************************************
+// function name: regionFree ()
+// Function Description: Reads the MBR, the region has to end before the first partition
+//********************************************************************************************
+bool RawLog::regionFree()
+{
+	uint8_t *mbr = (uint8_t *)&this->sector;
+	if (!this->card->readBlock(0, mbr))
+		return false;
+	// a card formatted without partition table starts with the FAT boot sector jump
+	if (mbr[510] != 0x55 || mbr[511] != 0xAA || mbr[0] == 0xEB || mbr[0] == 0xE9)
+		return false;
+	unsigned long start = 0;
+	for (int8_t i = 3; i >= 0; i--)
+	{
+		start = start << 8 | mbr[0x1C6 + i]; // first LBA of partition 1
+	}
+	return SD_RAW_FIRST_BLOCK >= 1 && (mbr[0x1C2] == 0 || SD_RAW_FIRST_BLOCK + SD_RAW_BLOCKS <= start);
+}
+
+bool RawLog::readSector(unsigned long index)
+{
+	return this->card->readBlock(SD_RAW_FIRST_BLOCK + index, (uint8_t *)&this->sector) &&
+		   this->sector.magic == RAW_MAGIC && this->sector.version == RAW_VERSION &&
+		   this->sector.count <= RAW_RECORDS && crc16(&this->sector, offsetof(RawSector, crc)) == this->sector.crc;
+}
+
+unsigned long RawLog::sequenceAt(unsigned long index)
+{
+	return readSector(index) ? this->sector.sequence : 0;
+}
+
+void RawLog::startSector(unsigned long sequence)
+{
+	memset(&this->sector, 0, sizeof(this->sector));
+	this->sector.magic = RAW_MAGIC;
+	this->sector.version = RAW_VERSION;
+	this->sector.sequence = sequence;
+}
+
+#endif // SD_RAW_LOG
@@ -0,0 +1,85 @@
+/*********************************************************************
+* RawLog.h
+*
+* Description: Raw block log for SdService (SD_RAW_LOG), written with
+* Sd2Card block writes and no FAT, directory or file objects.
+*
+* The log claims SD_RAW_BLOCKS blocks from SD_RAW_FIRST_BLOCK on, which
+* must lie in the unused gap in front of the first partition. begin()
+* reads the partition table and refuses a region that overlaps a
+* partition or a card without one.
+*
+* Every block holds a RawSector: magic, a sequence number that counts
+* the blocks written since the region was first used, up to
+* RAW_RECORDS fixed size records and a CRC16 over the rest. The block
+* at the head is rewritten with every record, once it is full the next
+* block follows with the next sequence. The region is a ring, the
+* oldest block is overwritten when it is full.
+*
+* The blocks from the start of the region up to the head carry
+* consecutive sequence numbers, so begin() finds the head with a binary
+* search for the last block whose sequence still follows the first one.
+* tools/raw_extract.py reads the region from a card image.
+*
+* version :  V1.0
+* date    :  2026-10-19
+**********************************************************************/
+
+#pragma once
+#include <Arduino.h>
+#include "config.h"
+#include "GravitySensorHub.h"
+
+#if SD_RAW_LOG
+#include <SD.h>
+
+#define RAW_MAGIC 0x5752 // "RW"
+#define RAW_VERSION 1
+#define RAW_RECORDS 16
+#define RAW_BLOCK_SIZE 512
+
+struct RawRecord
+{
+	uint32_t time; // epoch
+	float value[SNAPSHOT_CHANNELS];
+	uint8_t flags[SNAPSHOT_CHANNELS];
+	uint8_t levels; // water levels, bit i for switch i
+} __attribute__((packed));
+
+struct RawSector
+{
+	uint16_t magic;
+	uint8_t version;
+	uint8_t count; // records in use
+	uint32_t sequence;
+	RawRecord record[RAW_RECORDS];
+	uint8_t reserved[RAW_BLOCK_SIZE - 8 - RAW_RECORDS * sizeof(RawRecord) - 2];
+	uint16_t crc; // CRC16 of everything before it
+} __attribute__((packed));
+
+class RawLog
+{
+public:
+	RawLog();
+	~RawLog();
+
+	// check the region and find the head, false if the region cannot be used
+	bool begin(Sd2Card *card);
+
+	// add a record and write the head block
+	bool append(const RawRecord &record);
+
+private:
+	Sd2Card *card;
+	RawSector sector;	  // the head block, also the read buffer of begin()
+	unsigned long head; // block of the region being filled
+
+	bool regionFree();
+	// the block holds a valid sector, it is left in sector
+	bool readSector(unsigned long index);
+	// sequence of a block, 0 if it holds no valid sector
+	unsigned long sequenceAt(unsigned long index);
+	void startSector(unsigned long sequence);
+};
+
+#endif // SD_RAW_LOG
@@ -0,0 +1,243 @@
+/*********************************************************************
+* ReportLog.cpp
+*
+* Description: Sequence numbered, acknowledged report frames
+*
+* version :  V1.0
+* date    :  2026-10-19
+**********************************************************************/
+
+#include "ReportLog.h"
+#include "Telemetry.h"
+#include "WaterLevelMonitor.h"
+
+ReportLog::ReportLog() : framesResent(0), framesEvicted(0), nextSequence(1), ackedSequence(0),
+						 resendActive(false), resendSequence(0), compact(REPORT_COMPACT) {}
+
+ReportLog::~ReportLog() {}
+
+#if REPORT_SPOOL
+#define REPORT_SPOOL_FILE "REPORTS.BIN"
+
+//********************************************************************************************
+// function name: setup ()
+// Function Description: Opens REPORTS.BIN empty, the frames of the previous run carry
+// sequences that start over with this one
+//********************************************************************************************
+void ReportLog::setup(SdFile *directory)
+{
+	if (directory != NULL)
+		this->spool.open(directory, REPORT_SPOOL_FILE, O_RDWR | O_CREAT | O_TRUNC);
+}
+#endif
+
+//********************************************************************************************
+// function name: send ()
+// Function Description: Takes the snapshot and the water levels as the next report, keeps it
+// until it is acknowledged and prints it
+//********************************************************************************************
+void ReportLog::send(const SensorSnapshot &snapshot)
+{
+	if (this->nextSequence - this->ackedSequence > capacity())
+		this->framesEvicted++; // the slot still holds a frame nobody confirmed
+
+	Report &report = this->reports[this->nextSequence % REPORT_UNACKED];
+	report.sequence = this->nextSequence++;
+	report.levels = 0;
+	for (byte i = 0; i < SNAPSHOT_CHANNELS; i++)
+	{
+		report.value[i] = snapshot.value[i];
+		report.flags[i] = snapshot.flags[i];
+	}
+	for (byte i = 0; i < WATER_LEVEL_PIN_COUNT; i++)
+	{
+		if (waterLevel.level(i))
+			report.levels |= 1 << i;
+	}
+#if REPORT_SPOOL
+	// the slots are written in order up to the end of the file, then overwritten
+	if (this->spool.isOpen() &&
+		(!this->spool.seekSet((report.sequence - 1) % REPORT_SPOOL * sizeof(Report)) ||
+		 this->spool.write((const uint8_t *)&report, sizeof(report)) != sizeof(report)))
+		this->spool.close(); // card gone, RAM only from here on
+#endif
+	print(report, false);
+}
+
+//********************************************************************************************
+// function name: update ()
+// Function Description: Sends one kept frame per call while a RESEND runs
+//********************************************************************************************
+void ReportLog::update()
+{
+	if (!this->resendActive || !telemetry.beginFrame(TELEMETRY_REPORT_RESERVE))
+		return;
+
+	unsigned long oldest = oldestKept();
+	if (this->resendSequence < oldest)
+	{
+		telemetry.print(F("GAP@"));
+		telemetry.print(this->resendSequence);
+		telemetry.print(',');
+		telemetry.println(oldest - 1);
+		this->resendSequence = oldest;
+	}
+	else if (this->resendSequence < this->nextSequence)
+	{
+		Report report;
+		if (findReport(this->resendSequence, report))
+		{
+			print(report, true);
+			this->framesResent++;
+		}
+		else
+		{
+			telemetry.print(F("GAP@"));
+			telemetry.print(this->resendSequence);
+			telemetry.print(',');
+			telemetry.println(this->resendSequence);
+		}
+		this->resendSequence++;
+	}
+	else
+	{
+		this->resendActive = false;
+	}
+}
+
+void ReportLog::acknowledge(unsigned long sequence)
+{
+	if (sequence >= this->nextSequence)
+		sequence = this->nextSequence - 1;
+	if (sequence > this->ackedSequence)
+		this->ackedSequence = sequence;
+}
+
+void ReportLog::resend(unsigned long sequence)
+{
+	if (sequence <= this->ackedSequence)
+		sequence = this->ackedSequence + 1;
+	this->resendSequence = sequence;
+	this->resendActive = true;
+}
+
+bool ReportLog::resending()
+{
+	return this->resendActive;
+}
+
+void ReportLog::setCompact(bool compact)
+{
+	this->compact = compact;
+	this->codec.restart();
+}
+
+//********************************************************************************************
+// function name: printCounters ()
+// Function Description: SEQ@next,acknowledged,kept,resent,evicted
+//********************************************************************************************
+void ReportLog::printCounters()
+{
+	telemetry.print(F("SEQ@"));
+	telemetry.print(this->nextSequence);
+	telemetry.print(',');
+	telemetry.print(this->ackedSequence);
+	telemetry.print(',');
+	telemetry.print(this->nextSequence - oldestKept());
+	telemetry.print(',');
+	telemetry.print(this->framesResent);
+	telemetry.print(',');
+	telemetry.println(this->framesEvicted);
+}
+
+unsigned long ReportLog::capacity()
+{
+#if REPORT_SPOOL
+	if (this->spool.isOpen() && REPORT_SPOOL > REPORT_UNACKED)
+		return REPORT_SPOOL;
+#endif
+	return REPORT_UNACKED;
+}
+
+unsigned long ReportLog::oldestKept()
+{
+	unsigned long oldest = this->ackedSequence + 1;
+	if (this->nextSequence - oldest > capacity())
+		oldest = this->nextSequence - capacity();
+	return oldest;
+}
+
+bool ReportLog::findReport(unsigned long sequence, Report &report)
+{
+	if (this->nextSequence - sequence <= REPORT_UNACKED)
+	{
+		report = this->reports[sequence % REPORT_UNACKED];
+		return true;
+	}
+#if REPORT_SPOOL
+	return this->spool.isOpen() && this->spool.seekSet((sequence - 1) % REPORT_SPOOL * sizeof(Report)) &&
+		   this->spool.read(&report, sizeof(report)) == sizeof(report) && report.sequence == sequence;
+#else
+	return false;
+#endif
+}
+
+//********************************************************************************************
+// function name: print ()
+// Function Description: PH@..#TEMP@..#TDS@..#EC@..#ORP@..#WLVL1@..#FLG@..#SEQ@n
+//********************************************************************************************
+void ReportLog::print(const Report &report, bool resent)
+{
+	if (this->compact)
+	{
+		printCompact(report, resent);
+		return;
+	}
+	telemetry.print(F("PH@"));
+	telemetry.print(report.value[0]);
+	telemetry.print(F("#TEMP@"));
+	telemetry.print(report.value[1]);
+	telemetry.print(F("#TDS@"));
+	telemetry.print(report.value[2]);
+	telemetry.print(F("#EC@"));
+	telemetry.print(report.value[3]);
+	telemetry.print(F("#ORP@"));
+	telemetry.print(report.value[4]);
+	for (byte i = 0; i < WATER_LEVEL_PIN_COUNT; i++)
+	{
+		telemetry.print(F("#WLVL"));
+		telemetry.print(i + 1);
+		telemetry.print('@');
+		telemetry.print((report.levels >> i) & 1);
+	}
+	telemetry.print(F("#FLG@")); // READING_* flags per channel in hex
+	for (byte i = 0; i < SNAPSHOT_CHANNELS; i++)
+	{
+		if (i > 0)
+			telemetry.print('/');
+		telemetry.print(report.flags[i], HEX);
+	}
+	telemetry.print(F("#SEQ@"));
+	telemetry.println(report.sequence);
+}
+
+//********************************************************************************************
+// function name: printCompact ()
+// Function Description: Z@n,<base64 SampleCodec record>
+//********************************************************************************************
+void ReportLog::printCompact(const Report &report, bool keyframe)
+{
+	CodecSample sample;
+	sample.stamp = report.sequence;
+	memcpy(sample.value, report.value, sizeof(sample.value));
+	memcpy(sample.flags, report.flags, sizeof(sample.flags));
+	sample.aux = report.levels;
+
+	uint8_t record[CODEC_MAX_RECORD];
+	uint8_t length = keyframe ? SampleCodec::encodeKeyframe(sample, record) : this->codec.encode(sample, record);
+	telemetry.print(F("Z@"));
+	telemetry.print(report.sequence);
+	telemetry.print(',');
+	telemetry.printBase64(record, length);
+	telemetry.println();
+}
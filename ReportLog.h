@@ -0,0 +1,109 @@
+/*********************************************************************
+* ReportLog.h
+*
+* Description: Sequence numbered, acknowledged report frames. Every
+* report frame ends with "#SEQ@n", n counts up from 1 after each reset.
+* The receiver acknowledges cumulatively with "ACK n" once it holds
+* every frame up to n. The last REPORT_UNACKED frames that were not
+* acknowledged are kept and "RESEND n" sends them again from n on, one
+* frame per loop pass, with their original sequence numbers. Frames
+* that were pushed out before they were acknowledged are reported as
+* "GAP@first,last" in place of the frames.
+*
+* With a card (REPORT_SPOOL) every frame is also written to REPORTS.BIN,
+* frame n into slot (n - 1) % REPORT_SPOOL, so a RESEND after an outage
+* of up to REPORT_SPOOL frames reads the frames that left RAM from the
+* card. The file is truncated at boot like the sequence starts over,
+* and stays open.
+*
+* A receiver detects a lost frame by a jump in the sequence, a duplicate
+* by a sequence it already holds, and a reset of the node by the
+* sequence starting over at 1.
+*
+* "COMPACT 1" switches to "Z@n,<base64>" frames that carry the report
+* as a SampleCodec record with the sequence as stamp, "COMPACT 0" back
+* to text. After a lost frame the receiver waits for the next keyframe
+* or asks with RESEND, resent frames are always keyframes.
+*
+* version :  V1.0
+* date    :  2026-10-19
+**********************************************************************/
+
+#pragma once
+#include <Arduino.h>
+#include "config.h"
+#include "GravitySensorHub.h"
+#include "SampleCodec.h"
+#if REPORT_SPOOL
+#include <SD.h>
+#endif
+
+struct Report
+{
+	unsigned long sequence;
+	float value[SNAPSHOT_CHANNELS];
+	uint8_t flags[SNAPSHOT_CHANNELS];
+	uint8_t levels; // water levels, bit i for switch i
+};
+
+class ReportLog
+{
+public:
+	// counters since boot
+	unsigned long framesResent;	 // frames sent again on RESEND
+	unsigned long framesEvicted; // frames pushed out before they were acknowledged
+
+public:
+	ReportLog();
+	~ReportLog();
+
+#if REPORT_SPOOL
+	// start REPORTS.BIN in directory, NULL without a card
+	void setup(SdFile *directory);
+#endif
+
+	// number, keep and print a report frame, call after telemetry.beginFrame(TELEMETRY_REPORT_RESERVE)
+	void send(const SensorSnapshot &snapshot);
+
+	// send the next frame of a running RESEND
+	void update();
+
+	// every frame up to sequence arrived
+	void acknowledge(unsigned long sequence);
+
+	// send the kept frames again from sequence on
+	void resend(unsigned long sequence);
+
+	// a RESEND is being streamed
+	bool resending();
+
+	// switch between text and Z@ frames
+	void setCompact(bool compact);
+
+	// print SEQ@next,acknowledged,kept,resent,evicted
+	void printCounters();
+
+private:
+	Report reports[REPORT_UNACKED]; // sequence n is kept at n % REPORT_UNACKED
+	unsigned long nextSequence;
+	unsigned long ackedSequence;
+	bool resendActive;
+	unsigned long resendSequence;
+	bool compact;
+	SampleCodec codec; // delta chain of the Z@ frames
+#if REPORT_SPOOL
+	SdFile spool; // REPORTS.BIN, open while a card is present
+#endif
+
+	// frames kept, in RAM and on the card
+	unsigned long capacity();
+	// oldest sequence still kept
+	unsigned long oldestKept();
+	// a kept frame from RAM or from the card, false if the card does not have it
+	bool findReport(unsigned long sequence, Report &report);
+	// a resent frame does not depend on the frames before it
+	void print(const Report &report, bool resent);
+	void printCompact(const Report &report, bool keyframe);
+};
+
+extern ReportLog reportLog;
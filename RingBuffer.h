@@ -0,0 +1,189 @@
+/*********************************************************************
+* RingBuffer.h
+*
+* Description: Lock-free single-producer/single-consumer ring buffer
+* for handing data from an interrupt to loop() or back.
+*
+* One side only calls push()/space()/unpush(), the other only pop()/
+* peek()/available()/clear(). Head and tail run freely and are masked with
+* the power-of-two capacity, so all slots are usable. Up to 128
+* entries the indices are single bytes, which the AVR reads and writes
+* atomically. Larger buffers use 16-bit indices that are accessed with
+* interrupts disabled on the AVR. Other targets use acquire/release
+* atomics, so both sides may run on different threads.
+*
+* version :  V1.0
+* date    :  2026-10-19
+**********************************************************************/
+
+#pragma once
+#include <Arduino.h>
+#if defined(__AVR__)
+#include <avr/interrupt.h>
+#endif
+
+template <bool Small>
+struct RingBufferIndex
+{
+	typedef uint8_t type;
+};
+
+template <>
+struct RingBufferIndex<false>
+{
+	typedef uint16_t type;
+};
+
+template <typename T, uint16_t Capacity>
+class RingBuffer
+{
+	static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "RingBuffer capacity must be a power of two");
+	static_assert(Capacity <= 32768, "RingBuffer capacity too large");
+
+public:
+	typedef typename RingBufferIndex<(Capacity <= 128)>::type index_t;
+
+	RingBuffer() : head(0), tail(0) {}
+
+	//********************************************************************************************
+	// function name: push ()
+	// Function Description: Producer side, appends an item
+	// Return Value: false if the buffer is full
+	//********************************************************************************************
+	bool push(const T &item)
+	{
+		index_t h = head;
+		if ((index_t)(h - load(tail)) >= Capacity)
+			return false;
+		buffer[h & (Capacity - 1)] = item;
+		store(head, h + 1);
+		return true;
+	}
+
+	//********************************************************************************************
+	// function name: space ()
+	// Function Description: Producer side, number of items that can be pushed
+	//********************************************************************************************
+	index_t space() const
+	{
+		return Capacity - (index_t)(head - load(tail));
+	}
+
+	//********************************************************************************************
+	// function name: unpush ()
+	// Function Description: Producer side, takes back the newest count items. Only for a buffer
+	// whose consumer cannot run in between, e.g. when both sides are called from loop().
+	// Return Value: false if fewer than count items are waiting, nothing is taken back then
+	//********************************************************************************************
+	bool unpush(index_t count)
+	{
+		index_t h = head;
+		if ((index_t)(h - load(tail)) < count)
+			return false;
+		store(head, h - count);
+		return true;
+	}
+
+	//********************************************************************************************
+	// function name: pop ()
+	// Function Description: Consumer side, removes the oldest item
+	// Return Value: false if the buffer is empty
+	//********************************************************************************************
+	bool pop(T &item)
+	{
+		index_t t = tail;
+		if (t == load(head))
+			return false;
+		item = buffer[t & (Capacity - 1)];
+		store(tail, t + 1);
+		return true;
+	}
+
+	//********************************************************************************************
+	// function name: peek ()
+	// Function Description: Consumer side, reads the oldest item without removing it
+	//********************************************************************************************
+	bool peek(T &item) const
+	{
+		index_t t = tail;
+		if (t == load(head))
+			return false;
+		item = buffer[t & (Capacity - 1)];
+		return true;
+	}
+
+	//********************************************************************************************
+	// function name: available ()
+	// Function Description: Consumer side, number of items waiting
+	//********************************************************************************************
+	index_t available() const
+	{
+		return (index_t)(load(head) - tail);
+	}
+
+	bool empty() const
+	{
+		return available() == 0;
+	}
+
+	//********************************************************************************************
+	// function name: clear ()
+	// Function Description: Consumer side, drops every waiting item
+	//********************************************************************************************
+	void clear()
+	{
+		store(tail, load(head));
+	}
+
+	static uint16_t capacity()
+	{
+		return Capacity;
+	}
+
+private:
+	T buffer[Capacity];
+	volatile index_t head; // written by the producer only
+	volatile index_t tail; // written by the consumer only
+
+	static index_t load(const volatile index_t &index)
+	{
+#if defined(__AVR__)
+		index_t value;
+		if (sizeof(index_t) == 1)
+		{
+			value = index;
+		}
+		else
+		{
+			uint8_t sreg = SREG;
+			cli();
+			value = index;
+			SREG = sreg;
+		}
+		__asm__ __volatile__("" ::: "memory"); // read the index before the slot it guards
+		return value;
+#else
+		return __atomic_load_n(&index, __ATOMIC_ACQUIRE);
+#endif
+	}
+
+	static void store(volatile index_t &index, index_t value)
+	{
+#if defined(__AVR__)
+		__asm__ __volatile__("" ::: "memory"); // finish the slot before publishing the index
+		if (sizeof(index_t) == 1)
+		{
+			index = value;
+		}
+		else
+		{
+			uint8_t sreg = SREG;
+			cli();
+			index = value;
+			SREG = sreg;
+		}
+#else
+		__atomic_store_n(&index, value, __ATOMIC_RELEASE);
+#endif
+	}
+};
@@ -0,0 +1,181 @@
+/*********************************************************************
+* RollupLog.cpp
+*
+* Description: Minute, 15 minute and hour summaries on the SD card
+*
+* version :  V1.0
+* date    :  2026-10-19
+**********************************************************************/
+
+#include "RollupLog.h"
+
+#if ENABLE_ROLLUPS
+
+#include "GravityRtc.h"
+
+// seconds per record and file extension of each tier
+static const unsigned int rollupPeriod[ROLLUP_TIERS] PROGMEM = {60, 900, 3600};
+static const char rollupExtension[ROLLUP_TIERS][4] PROGMEM = {"M01", "M15", "H01"};
+
+static void addValue(RollupChannel &channel, float value)
+{
+	if (channel.count == 0xFFFF)
+		return;
+	if (channel.count++ == 0)
+	{
+		channel.minimum = value;
+		channel.maximum = value;
+		channel.mean = value;
+		return;
+	}
+	if (value < channel.minimum)
+		channel.minimum = value;
+	if (value > channel.maximum)
+		channel.maximum = value;
+	channel.mean += (value - channel.mean) / channel.count;
+}
+
+// fold the values of from into into, the mean is weighted by the counts
+static void mergeChannel(RollupChannel &into, const RollupChannel &from)
+{
+	if (from.count == 0)
+		return;
+	if (into.count == 0)
+	{
+		into = from;
+		return;
+	}
+	if (from.minimum < into.minimum)
+		into.minimum = from.minimum;
+	if (from.maximum > into.maximum)
+		into.maximum = from.maximum;
+	unsigned long count = (unsigned long)into.count + from.count;
+	into.mean += (from.mean - into.mean) * from.count / count;
+	into.count = count > 0xFFFF ? 0xFFFF : count;
+}
+
+RollupLog::RollupLog(GravitySensorHub *hub) : sensorHub(hub), directory(NULL), snapshotSequence(0), minuteOpen(false) {}
+
+RollupLog::~RollupLog() {}
+
+void RollupLog::setup(SdFile *directory)
+{
+	this->directory = directory;
+}
+
+//********************************************************************************************
+// function name: update ()
+// Function Description: Adds every new snapshot to the minute, the first snapshot of the next
+// minute closes it
+//********************************************************************************************
+void RollupLog::update()
+{
+	const SensorSnapshot &snapshot = this->sensorHub->snapshot();
+	if (snapshot.sequence == this->snapshotSequence)
+		return;
+	this->snapshotSequence = snapshot.sequence;
+
+	unsigned long start = snapshot.time - snapshot.time % pgm_read_word(&rollupPeriod[0]);
+	if (this->minuteOpen && this->minute.time != start)
+		closeMinute();
+	if (!this->minuteOpen)
+	{
+		memset(&this->minute, 0, sizeof(this->minute));
+		this->minute.time = start;
+		this->minuteOpen = true;
+	}
+	for (byte i = 0; i < SNAPSHOT_CHANNELS; i++)
+	{
+		this->minute.flags |= snapshot.flags[i];
+		if (!(snapshot.flags[i] & READING_MISSING))
+			addValue(this->minute.channel[i], snapshot.value[i]);
+	}
+}
+
+void RollupLog::closeMinute()
+{
+	this->minuteOpen = false;
+	if (this->directory == NULL)
+		return;
+	// YYMM, the name of the 15 minute file without its extension
+	char name[13];
+	SdFile month;
+	tierName(1, this->minute.time, name);
+	name[4] = '\0';
+	if (month.open(this->directory, name, O_READ) || month.makeDir(this->directory, name))
+	{
+		store(0, &month);
+		store(1, &month);
+	}
+	store(2, this->directory);
+}
+
+//********************************************************************************************
+// function name: store ()
+// Function Description: Merges the minute into the record of its period, which is the last
+// one of the tier file unless the period just began. A torn record at the end of the file is
+// overwritten.
+//********************************************************************************************
+void RollupLog::store(uint8_t tier, SdFile *folder)
+{
+	unsigned long start = this->minute.time - this->minute.time % pgm_read_word(&rollupPeriod[tier]);
+	char name[13];
+	SdFile file;
+	tierName(tier, start, name);
+	if (!file.open(folder, name, O_RDWR | O_CREAT))
+		return;
+
+	unsigned long records = file.fileSize() / sizeof(RollupRecord);
+	RollupRecord record;
+	if (records > 0 && file.seekSet((records - 1) * sizeof(RollupRecord)) &&
+		file.read(&record, sizeof(record)) == sizeof(record) && record.time == start)
+	{
+		records--;
+		record.flags |= this->minute.flags;
+		for (byte i = 0; i < SNAPSHOT_CHANNELS; i++)
+		{
+			mergeChannel(record.channel[i], this->minute.channel[i]);
+		}
+	}
+	else
+	{
+		record = this->minute;
+		record.time = start;
+	}
+	file.seekSet(records * sizeof(RollupRecord));
+	file.write((const uint8_t *)&record, sizeof(record));
+	file.close();
+}
+
+// YYMMDD.M01, YYMM.M15 or YYYY.H01 of the period starting at time
+void RollupLog::tierName(uint8_t tier, unsigned long time, char *name)
+{
+	RtcTime date;
+	GravityRtc::fromEpoch(time, date);
+	unsigned long digits;
+	int8_t length;
+	if (tier == 0)
+	{
+		digits = (date.year % 100) * 10000UL + date.month * 100 + date.day;
+		length = 6;
+	}
+	else if (tier == 1)
+	{
+		digits = (date.year % 100) * 100 + date.month;
+		length = 4;
+	}
+	else
+	{
+		digits = date.year;
+		length = 4;
+	}
+	for (int8_t i = length - 1; i >= 0; i--)
+	{
+		name[i] = '0' + digits % 10;
+		digits /= 10;
+	}
+	name[length] = '.';
+	strcpy_P(name + length + 1, rollupExtension[tier]);
+}
+
+#endif // ENABLE_ROLLUPS
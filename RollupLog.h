@@ -0,0 +1,79 @@
+/*********************************************************************
+* RollupLog.h
+*
+* Description: Downsampled summaries of the snapshots on the SD card.
+* Every snapshot goes into a minute accumulator in RAM, each closed
+* minute is merged into three tiers of fixed size records:
+*
+* YYMM/YYMMDD.M01 : one record per minute, one file per day
+* YYMM/YYMM.M15   : one record per 15 minutes, one file per month
+* YYYY.H01        : one record per hour, one file per year
+*
+* The minute and 15 minute files go into the month directory that also
+* holds the logs of SdService, so the root only gains one file a year.
+* A record holds min, max, mean and count of every channel over its
+* period, channels flagged READING_MISSING are left out. The last
+* record of a tier file is the period being built: a minute of the same
+* period is merged into it and written back in place, a minute of a new
+* period appends the next record. The coarse tiers therefore cost no
+* RAM and continue across resets, only the minute in progress is lost.
+* Periods without snapshots have no record. tools/rollup_dump.py prints
+* the files as csv, BULK downloads them.
+*
+* version :  V1.0
+* date    :  2026-10-19
+**********************************************************************/
+
+#pragma once
+#include <Arduino.h>
+#include "config.h"
+#include "GravitySensorHub.h"
+
+#if ENABLE_ROLLUPS
+#include <SD.h>
+
+#define ROLLUP_TIERS 3
+
+struct RollupChannel
+{
+	uint16_t count; // values in the period, 0 leaves the rest undefined
+	float minimum;
+	float maximum;
+	float mean;
+} __attribute__((packed));
+
+struct RollupRecord
+{
+	uint32_t time; // epoch of the start of the period
+	uint8_t flags; // READING_* of all channels or'ed
+	RollupChannel channel[SNAPSHOT_CHANNELS];
+} __attribute__((packed));
+
+class RollupLog
+{
+public:
+	RollupLog(GravitySensorHub *hub);
+	~RollupLog();
+
+	// tier files go into directory and its month directories, NULL without a card
+	void setup(SdFile *directory);
+
+	// take in a new snapshot, a new minute stores the previous one
+	void update();
+
+private:
+	GravitySensorHub *sensorHub;
+	SdFile *directory;
+	unsigned long snapshotSequence; // last snapshot taken in
+	RollupRecord minute;			// minute being accumulated
+	bool minuteOpen;
+
+	void closeMinute();
+	// merge the minute into the last record of a tier file in folder or append it
+	void store(uint8_t tier, SdFile *folder);
+	void tierName(uint8_t tier, unsigned long time, char *name);
+};
+
+extern RollupLog rollupLog;
+
+#endif // ENABLE_ROLLUPS
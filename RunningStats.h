@@ -0,0 +1,73 @@
+/*********************************************************************
+* RunningStats.h
+*
+* Description: Streaming min/max/mean/standard deviation of a channel
+* (Welford's algorithm). add() is O(1) and the memory is fixed, so the
+* hub can keep one per channel and consumer window.
+*
+* version :  V1.0
+* date    :  2026-10-19
+**********************************************************************/
+
+#pragma once
+#include <Arduino.h>
+
+class RunningStats
+{
+public:
+	RunningStats() { reset(); }
+
+	//********************************************************************************************
+	// function name: add ()
+	// Function Description: Adds a value to the window
+	//********************************************************************************************
+	void add(float value)
+	{
+		if (this->n == 0xFFFF)
+			return; // keep the statistics of the first 65535 values
+		this->n++;
+		if (this->n == 1)
+		{
+			this->minimum = value;
+			this->maximum = value;
+		}
+		else
+		{
+			if (value < this->minimum)
+				this->minimum = value;
+			if (value > this->maximum)
+				this->maximum = value;
+		}
+		float delta = value - this->average;
+		this->average += delta / this->n;
+		this->m2 += delta * (value - this->average);
+	}
+
+	// start a new window
+	void reset()
+	{
+		this->n = 0;
+		this->average = 0;
+		this->m2 = 0;
+		this->minimum = 0;
+		this->maximum = 0;
+	}
+
+	uint16_t count() const { return this->n; }
+	float minValue() const { return this->minimum; }
+	float maxValue() const { return this->maximum; }
+	float mean() const { return this->average; }
+
+	// sample standard deviation, 0 below two values
+	float stddev() const
+	{
+		return this->n > 1 ? sqrt(this->m2 / (this->n - 1)) : 0;
+	}
+
+private:
+	uint16_t n;
+	float average;
+	float m2; // sum of squared differences from the mean
+	float minimum;
+	float maximum;
+};
@@ -0,0 +1,209 @@
+/*********************************************************************
+* SampleCodec.cpp
+*
+* Description: Delta/varint codec for sensor samples
+*
+* version :  V1.0
+* date    :  2026-10-19
+**********************************************************************/
+
+#include "SampleCodec.h"
+
+// quantization steps: pH 0.001, temperature 1/16 C (DS18B20 resolution), TDS 1 ppm,
+// EC 0.001 ms/cm, ORP 1 mV
+static const int16_t codecScale[SNAPSHOT_CHANNELS] PROGMEM = {1000, 16, 1, 1000, 1};
+
+SampleCodec::SampleCodec() : stamp(0), aux(0), sinceKeyframe(0)
+{
+	for (byte i = 0; i < SNAPSHOT_CHANNELS; i++)
+	{
+		this->value[i] = 0;
+		this->flags[i] = 0;
+	}
+}
+
+SampleCodec::~SampleCodec() {}
+
+//********************************************************************************************
+// function name: encode ()
+// Function Description: Writes a keyframe or the changes since the previous sample
+// Parameters: out  room for CODEC_MAX_RECORD bytes
+// Return Value: bytes written
+//********************************************************************************************
+uint8_t SampleCodec::encode(const CodecSample &sample, uint8_t *out)
+{
+	long quantized[SNAPSHOT_CHANNELS];
+	for (byte i = 0; i < SNAPSHOT_CHANNELS; i++)
+	{
+		quantized[i] = quantize(sample.value[i], i);
+	}
+
+	uint8_t length;
+	if (this->sinceKeyframe == 0 || this->sinceKeyframe >= CODEC_KEYFRAME_INTERVAL)
+	{
+		length = encodeKeyframe(sample, out);
+		this->sinceKeyframe = 0;
+	}
+	else
+	{
+		uint8_t header = 0;
+		length = 1;
+		length += putVarint(out + length, (long)(sample.stamp - this->stamp));
+		for (byte i = 0; i < SNAPSHOT_CHANNELS; i++)
+		{
+			if (quantized[i] != this->value[i])
+			{
+				header |= 1 << i;
+				length += putVarint(out + length, quantized[i] - this->value[i]);
+			}
+		}
+		if (memcmp(sample.flags, this->flags, SNAPSHOT_CHANNELS) != 0)
+		{
+			header |= CODEC_FLAGS;
+			memcpy(out + length, sample.flags, SNAPSHOT_CHANNELS);
+			length += SNAPSHOT_CHANNELS;
+		}
+		if (sample.aux != this->aux)
+		{
+			header |= CODEC_AUX;
+			out[length++] = sample.aux;
+		}
+		if (header == 0)
+		{
+			header = 1; // nothing changed, a zero delta of channel 0 keeps 0x00 free for padding
+			out[length++] = 0;
+		}
+		out[0] = header;
+	}
+
+	this->stamp = sample.stamp;
+	for (byte i = 0; i < SNAPSHOT_CHANNELS; i++)
+	{
+		this->value[i] = quantized[i];
+		this->flags[i] = sample.flags[i];
+	}
+	this->aux = sample.aux;
+	this->sinceKeyframe++;
+	return length;
+}
+
+void SampleCodec::restart()
+{
+	this->sinceKeyframe = 0;
+}
+
+uint8_t SampleCodec::encodeKeyframe(const CodecSample &sample, uint8_t *out)
+{
+	uint8_t length = 0;
+	out[length++] = CODEC_KEYFRAME;
+	length += putVarint(out + length, (long)sample.stamp);
+	for (byte i = 0; i < SNAPSHOT_CHANNELS; i++)
+	{
+		length += putVarint(out + length, quantize(sample.value[i], i));
+	}
+	memcpy(out + length, sample.flags, SNAPSHOT_CHANNELS);
+	length += SNAPSHOT_CHANNELS;
+	out[length++] = sample.aux;
+	return length;
+}
+
+//********************************************************************************************
+// function name: decode ()
+// Function Description: Rebuilds a sample from a keyframe or from a delta record and the
+// previous sample, the inverse of encode()
+// Parameters: length  bytes of the record
+// Return Value: false if the record is cut short or there is no keyframe to apply a delta to
+//********************************************************************************************
+bool SampleCodec::decode(const uint8_t *in, uint8_t length, CodecSample &sample)
+{
+	if (length == 0)
+		return false;
+	uint8_t header = in[0];
+	uint8_t used = 1, size;
+	long number;
+	bool keyframe = header == CODEC_KEYFRAME;
+	if (!keyframe && this->sinceKeyframe == 0)
+		return false;
+
+	if ((size = getVarint(in + used, length - used, number)) == 0)
+		return false;
+	used += size;
+	this->stamp = keyframe ? (unsigned long)number : this->stamp + number;
+	for (byte i = 0; i < SNAPSHOT_CHANNELS; i++)
+	{
+		if (!keyframe && !(header & (1 << i)))
+			continue;
+		if ((size = getVarint(in + used, length - used, number)) == 0)
+			return false;
+		used += size;
+		this->value[i] = keyframe ? number : this->value[i] + number;
+	}
+	if (keyframe || (header & CODEC_FLAGS))
+	{
+		if (used + SNAPSHOT_CHANNELS > length)
+			return false;
+		memcpy(this->flags, in + used, SNAPSHOT_CHANNELS);
+		used += SNAPSHOT_CHANNELS;
+	}
+	if (keyframe || (header & CODEC_AUX))
+	{
+		if (used >= length)
+			return false;
+		this->aux = in[used++];
+	}
+	if (keyframe)
+		this->sinceKeyframe = 1; // deltas can be applied from here on
+
+	sample.stamp = this->stamp;
+	for (byte i = 0; i < SNAPSHOT_CHANNELS; i++)
+	{
+		sample.value[i] = (float)this->value[i] / (int16_t)pgm_read_word(&codecScale[i]);
+		sample.flags[i] = this->flags[i];
+	}
+	sample.aux = this->aux;
+	return true;
+}
+
+long SampleCodec::quantize(float value, byte channel)
+{
+	float scaled = value * (int16_t)pgm_read_word(&codecScale[channel]);
+	if (scaled > 1e9f)
+		return 1000000000L;
+	if (scaled < -1e9f)
+		return -1000000000L;
+	return (long)(scaled < 0 ? scaled - 0.5f : scaled + 0.5f);
+}
+
+//********************************************************************************************
+// function name: putVarint ()
+// Function Description: Writes a zigzag coded signed varint
+// Return Value: bytes written, 1 to 5
+//********************************************************************************************
+uint8_t SampleCodec::putVarint(uint8_t *out, long value)
+{
+	unsigned long zigzag = ((unsigned long)value << 1) ^ (unsigned long)(value >> 31);
+	uint8_t length = 0;
+	while (zigzag >= 0x80)
+	{
+		out[length++] = (uint8_t)zigzag | 0x80;
+		zigzag >>= 7;
+	}
+	out[length++] = (uint8_t)zigzag;
+	return length;
+}
+
+// Return Value: bytes read, 0 if the varint runs past length
+uint8_t SampleCodec::getVarint(const uint8_t *in, uint8_t length, long &value)
+{
+	unsigned long zigzag = 0;
+	for (uint8_t i = 0; i < length && i < 5; i++)
+	{
+		zigzag |= (unsigned long)(in[i] & 0x7F) << (7 * i);
+		if (!(in[i] & 0x80))
+		{
+			value = (long)(zigzag >> 1) ^ -(long)(zigzag & 1);
+			return i + 1;
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,79 @@
+/*********************************************************************
+* SampleCodec.h
+*
+* Description: Delta/varint codec for sensor samples, used for the SD
+* log and for compact report frames. tools/sample_codec.py decodes it.
+*
+* Every value is quantized to an integer with a fixed scale per channel
+* (codecScale), so the decoder rebuilds exactly what was encoded.
+* A keyframe carries every field in full, the following records only
+* what changed since the previous one:
+*
+* keyframe : 0x80, stamp, value[0..4], flags[0..4], aux
+* delta    : header, stamp - previous stamp, then the value deltas of
+*            the channels in header bits 0..4, flags[0..4] if header
+*            bit 6 and aux if header bit 5 is set, a record without
+*            any change carries a zero delta for channel 0, so the
+*            header is never 0x00
+* padding  : 0x00 or 0xFF, the rest of the sector is unused (erased
+*            SD blocks read as either)
+*
+* stamp and values are zigzag coded signed varints (7 bits per byte,
+* least significant group first, bit 7 set on all but the last byte),
+* flags and aux are plain bytes. A keyframe is sent every
+* CODEC_KEYFRAME_INTERVAL records and after restart(), so a decoder can
+* pick a stream up again after a lost or skipped part.
+*
+* version :  V1.0
+* date    :  2026-10-19
+**********************************************************************/
+
+#pragma once
+#include <Arduino.h>
+#include "config.h"
+#include "GravitySensorHub.h"
+
+#define CODEC_KEYFRAME 0x80
+#define CODEC_PADDING 0xFF
+#define CODEC_ERASED 0x00
+#define CODEC_FLAGS 0x40
+#define CODEC_AUX 0x20
+#define CODEC_MAX_RECORD (1 + 5 + SNAPSHOT_CHANNELS * 5 + SNAPSHOT_CHANNELS + 1) // worst case bytes of one record
+
+struct CodecSample
+{
+	unsigned long stamp; // epoch on the SD card, sequence in report frames
+	float value[SNAPSHOT_CHANNELS];
+	uint8_t flags[SNAPSHOT_CHANNELS];
+	uint8_t aux; // water levels
+};
+
+class SampleCodec
+{
+public:
+	SampleCodec();
+	~SampleCodec();
+
+	// encode a sample against the previous one, returns the number of bytes written to out
+	uint8_t encode(const CodecSample &sample, uint8_t *out);
+
+	// the next sample becomes a keyframe
+	void restart();
+
+	// encode a sample as a keyframe without touching the delta chain of a codec
+	static uint8_t encodeKeyframe(const CodecSample &sample, uint8_t *out);
+
+	// decode one record against the previous one, false for a delta without a keyframe before it
+	bool decode(const uint8_t *in, uint8_t length, CodecSample &sample);
+
+private:
+	unsigned long stamp;
+	long value[SNAPSHOT_CHANNELS]; // quantized values of the previous sample
+	uint8_t flags[SNAPSHOT_CHANNELS];
+	uint8_t aux;
+	uint8_t sinceKeyframe; // records since the last keyframe, 0 forces a keyframe
+
+	static long quantize(float value, byte channel);
+	static uint8_t putVarint(uint8_t *out, long value);
+	static uint8_t getVarint(const uint8_t *in, uint8_t length, long &value);
+};
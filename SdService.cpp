@@ -9,7 +9,48 @@
 * (at your option) any later version.
 *
 * Description:SD card datalogger,Data write format:
-* "Year,Month,Day,Hour,Minues,Second,pH,temp(C),DO(mg/l0,ec(s/m),orp(mv)"
+* "Year,Month,Day,Hour,Minues,Second,pH,temp(C),DO(mg/l0,ec(s/m),orp(mv),flags"
+* flags are the READING_* flags of each channel in hex, e.g. "0/4/0/2/0",
+* followed by min,max,mean,sd of every channel since the previous row (ENABLE_STATS)
+* and the CRC16 of the row before it as 4 hex digits. A row only counts once
+* its newline, the commit marker, is on the card and the CRC matches.
+*
+* With SD_COMPRESSED the snapshots are SampleCodec records instead, stamped
+* with the epoch and the water levels as aux. Each record is written as a
+* frame: length, record, CRC16 of length and record (little endian), the CRC
+* commits the frame. Frames never cross a 512 byte sector, the rest of a
+* sector is padding and every sector starts with a keyframe, so each sector
+* decodes on its own. tools/sample_codec.py turns them back into csv.
+*
+* Every day gets its own log YYMMDDPP.BIN (.CSV without SD_COMPRESSED), PP
+* counts the parts of a day. The logs of a month go into the directory YYMM,
+* so the root, which FAT16 limits to 512 entries, only gains one directory
+* a month and opening a log by name reads at most one month of entries.
+* A log is created as one contiguous extent of
+* SD_LOG_FILE_SIZE bytes that is erased up front and then stays open, so a
+* write is a sequential sector write whose cost does not depend on how long
+* the node has been running. When the day changes or the log is full it is
+* cut to the written length and closed. Rows only go into blocks the log
+* already owns, so its directory entry is not written between creation and
+* closing. After a reset the log of the day is continued: used sectors start
+* with a frame or row, erased ones with 0x00 or 0xFF, a binary search finds
+* the first erased one and only the last used sector is scanned for the last
+* valid frame or row, everything after it is overwritten. Recovery takes the
+* FAT sectors of the cluster chain, which must still be one extent, and at
+* most log2(SD_LOG_FILE_SIZE / 512) + 3 sector reads. LOGS.TXT in the root
+* lists the logs: "YYMM/name,OPEN,epoch" when created and
+* "YYMM/name,CLOSED,epoch,bytes" when closed.
+*
+* Next to every log YYMMDDPP.IDX is a sparse index of 8 byte entries, epoch
+* and offset of a record (uint32_t, little endian), kept open with the log. .BIN logs get an entry
+* for the first frame of every sector, which is a keyframe, .CSV logs one
+* every SD_INDEX_ROWS rows. "RANGE from to" (epochs) looks up the last entry
+* at or before from and streams the records up to to, one frame per update():
+* "REC@epoch,pH,temp,tds,ec,orp,flags,levels", levels only from .BIN logs,
+* and "RANGEEND@records" at the end.
+*
+* With SD_RAW_LOG the rows go into a reserved block range instead, see
+* RawLog.h, and the card carries no files for this node.
 *
 * Product Links:http://www.dfrobot.com.cn/goods-1142.html
 *
@@ -37,19 +78,65 @@ const int CsPin = 4;
 
 #endif
 
-#define SDUPDATEDATATIME 30000
+// ms between two rows, SET SDLOG changes it
+#define SDUPDATEDATATIME (calibrationStore.intervals.value[INTERVAL_SD_LOG] * 1000UL)
 
 #include "SdService.h"
 #include <SPI.h>
 #include "Debug.h"
 #include "GravityRtc.h"
+#include "CalibrationStore.h"
+#include "IdleManager.h"
+#include "WaterLevelMonitor.h"
+#include "Telemetry.h"
+#include "Crc.h"
+
+#if ENABLE_SD_LOG
+
+#if SD_COMPRESSED
+#define SD_LOG_EXTENSION "BIN"
+#define SD_FRAME_OVERHEAD 3 // length and CRC16 around a record
+#define SD_LOG_RECORD (SD_SECTOR_SIZE + CODEC_MAX_RECORD + SD_FRAME_OVERHEAD) // padding to the next sector and a frame
+#else
+#define SD_LOG_EXTENSION "CSV"
+#endif
+#define SD_MANIFEST_FILE "LOGS.TXT"
+#if ENABLE_RANGE
+#define SD_INDEX_EXTENSION "IDX"
+#endif
+#define SD_SECTOR_SIZE 512
 
-extern GravityRtc rtc;
+#if !SD_COMPRESSED && !SD_RAW_LOG
 String dataString = "";
+#endif
+
+#if !SD_RAW_LOG
+// yyyymmdd of an epoch time
+static unsigned long dayOf(unsigned long epoch)
+{
+	RtcTime time;
+	GravityRtc::fromEpoch(epoch, time);
+	return time.year * 10000UL + time.month * 100 + time.day;
+}
+#endif
+
+#if ENABLE_RANGE && SD_COMPRESSED
+// decimals of the REC frame values, enough for the codec scale of each channel
+static const uint8_t rangeDecimals[SNAPSHOT_CHANNELS] PROGMEM = {3, 4, 0, 3, 0};
+#endif
 
-SdService ::SdService(ISensor *gravitySensor[]) : chipSelect(CsPin), sdDataUpdateTime(0)
+#if SD_RAW_LOG
+SdService ::SdService(GravitySensorHub *hub) : chipSelect(CsPin), sdDataUpdateTime(0)
+#elif !ENABLE_RANGE
+SdService ::SdService(GravitySensorHub *hub) : chipSelect(CsPin), sdDataUpdateTime(0), logOpen(false), logDay(0),
+											   logPart(0), logEnd(0), logTime(0)
+#else
+SdService ::SdService(GravitySensorHub *hub) : chipSelect(CsPin), sdDataUpdateTime(0), logOpen(false), logDay(0),
+											   logPart(0), logEnd(0), logTime(0), rangeActive(false), rangeFrom(0),
+											   rangeTo(0), rangeDay(0), rangeLastDay(0), rangePart(0), rangeCount(0)
+#endif
 {
-	this->gravitySensor = gravitySensor;
+	this->sensorHub = hub;
 }
 
 SdService ::~SdService() {}
@@ -64,7 +151,11 @@ void SdService::setup()
 
 	pinMode(SS, OUTPUT);
 
-	if (!SD.begin(chipSelect))
+#if SD_RAW_LOG
+	if (!card.init(SPI_HALF_SPEED, chipSelect) || !rawLog.begin(&card))
+#else
+	if (!card.init(SPI_HALF_SPEED, chipSelect) || !volume.init(&card) || !root.openRoot(&volume))
+#endif
 	{
 		Debug::println(F("Card failed, or not present"));
 		// don't do anything more:
@@ -72,15 +163,7 @@ void SdService::setup()
 	}
 	sdReady = true;
 	Debug::println(F("card initialized."));
-
-	// write the file header
-	dataFile = SD.open("sensor.csv", FILE_WRITE);
-	if (dataFile && dataFile.position() == 0)
-	{
-		//dataFile.println(F("Year,Month,Day,Hour,Minues,Second,pH,temp(C),DO(mg/l),ec(s/m),orp(mv)"));
-		dataFile.println(F("date,pH,temp(C),DO(mg/l),ec(s/m),orp(mv)"));
-		dataFile.close();
-	}
+	// the log of the day is opened by the first update(), once the clock has a date
 }
 
 //********************************************************************************************
@@ -92,83 +175,768 @@ void SdService::update()
 	if (sdReady && millis() - sdDataUpdateTime > SDUPDATEDATATIME)
 	{
 		//Serial.println(F("Write Sd card"));
-		dataString = "";
-		// Year Month Day Hours Minute Seconds
-		dataString += String(rtc.year, 10);
-		dataString += "/";
-		dataString += String(rtc.month, 10);
-		dataString += "/";
-		dataString += String(rtc.day, 10);
-		dataString += "/";
-		dataString += String(rtc.hour, 10);
-		dataString += "/";
-		dataString += String(rtc.minute, 10);
-		dataString += "/";
-		dataString += String(rtc.second, 10);
+		// time and values of one row come from the same snapshot
+		const SensorSnapshot &snapshot = this->sensorHub->snapshot();
+#if SD_RAW_LOG
+		writeRaw(snapshot);
+#else
+		unsigned long day = dayOf(snapshot.time);
+		this->logTime = snapshot.time;
+#if SD_COMPRESSED
+		writeSample(snapshot, day);
+#else
+		writeRow(snapshot, day);
+#endif
+#endif
+		sdDataUpdateTime = millis();
+	}
+#if ENABLE_RANGE
+	if (rangeActive)
+		streamRange();
+#endif
+}
+
+//********************************************************************************************
+// function name: idleTime ()
+// Function Description: Returns the ms until the next record is written
+//********************************************************************************************
+unsigned long SdService::idleTime()
+{
+	if (!sdReady)
+		return IDLE_FOREVER;
+#if ENABLE_RANGE
+	if (rangeActive)
+		return 0;
+#endif
+	return timeUntil(sdDataUpdateTime, SDUPDATEDATATIME + 1);
+}
+
+SdFile *SdService::directory()
+{
+#if SD_RAW_LOG
+	return NULL;
+#else
+	return sdReady ? &root : NULL;
+#endif
+}
+
+#if SD_RAW_LOG
+//********************************************************************************************
+// function name: writeRaw ()
+// Function Description: Appends the snapshot to the raw log
+//********************************************************************************************
+void SdService::writeRaw(const SensorSnapshot &snapshot)
+{
+	RawRecord record;
+	record.time = snapshot.time;
+	memcpy(record.value, snapshot.value, sizeof(record.value));
+	memcpy(record.flags, snapshot.flags, sizeof(record.flags));
+	record.levels = 0;
+	for (byte i = 0; i < WATER_LEVEL_PIN_COUNT; i++)
+	{
+		if (waterLevel.level(i))
+			record.levels |= 1 << i;
+	}
+	if (!rawLog.append(record))
+		Debug::println(F("raw log write failed"));
+}
+#elif SD_COMPRESSED
+//********************************************************************************************
+// function name: writeSample ()
+// Function Description: Appends one SampleCodec record as a frame, a frame that does not fit
+// into the current sector starts the next one as a keyframe
+//********************************************************************************************
+void SdService::writeSample(const SensorSnapshot &snapshot, unsigned long day)
+{
+	CodecSample sample;
+	sample.stamp = snapshot.time;
+	memcpy(sample.value, snapshot.value, sizeof(sample.value));
+	memcpy(sample.flags, snapshot.flags, sizeof(sample.flags));
+	sample.aux = 0;
+	for (byte i = 0; i < WATER_LEVEL_PIN_COUNT; i++)
+	{
+		if (waterLevel.level(i))
+			sample.aux |= 1 << i;
+	}
+
+	if (!openLog(day, SD_LOG_RECORD))
+		return;
+
+	uint16_t room = SD_SECTOR_SIZE - logEnd % SD_SECTOR_SIZE;
+	uint8_t frame[CODEC_MAX_RECORD + SD_FRAME_OVERHEAD];
+	uint8_t length = this->codec.encode(sample, frame + 1) + SD_FRAME_OVERHEAD;
+	if (length > room)
+	{
+		while (room--)
+		{
+			logFile.write(CODEC_PADDING);
+		}
+		this->codec.restart();
+		length = this->codec.encode(sample, frame + 1) + SD_FRAME_OVERHEAD;
+		room = SD_SECTOR_SIZE;
+	}
+	frame[0] = length - SD_FRAME_OVERHEAD;
+	uint16_t crc = crc16(frame, length - 2);
+	frame[length - 2] = crc & 0xFF;
+	frame[length - 1] = crc >> 8;
+	unsigned long start = logFile.curPosition();
+	logFile.write(frame, length);
+	logFile.sync();
+	logEnd = logFile.curPosition();
+#if ENABLE_RANGE
+	if (start % SD_SECTOR_SIZE == 0)
+		appendIndex(sample.stamp, start);
+#endif
+	if (length == room)
+		this->codec.restart(); // the sector is full, the next one starts with a keyframe
+}
+#else
+//********************************************************************************************
+// function name: writeRow ()
+// Function Description: Appends one csv row, the header goes first into a new log
+//********************************************************************************************
+void SdService::writeRow(const SensorSnapshot &snapshot, unsigned long day)
+{
+	RtcTime time;
+	GravityRtc::fromEpoch(snapshot.time, time);
+
+	dataString = "";
+	// Year Month Day Hours Minute Seconds
+	dataString += String(time.year, 10);
+	dataString += "/";
+	dataString += String(time.month, 10);
+	dataString += "/";
+	dataString += String(time.day, 10);
+	dataString += "/";
+	dataString += String(time.hour, 10);
+	dataString += "/";
+	dataString += String(time.minute, 10);
+	dataString += "/";
+	dataString += String(time.second, 10);
+	dataString += ",";
+
+	// ph, temperature, DO (TDS), EC, Orp, missing sensors are published as 0
+	for (byte i = 0; i < SNAPSHOT_CHANNELS; i++)
+	{
+		connectString(snapshot.value[i]);
+	}
+	// READING_* flags per channel in hex, same order as the values
+	for (byte i = 0; i < SNAPSHOT_CHANNELS; i++)
+	{
+		if (i > 0)
+			dataString += "/";
+		dataString += String(snapshot.flags[i], HEX);
+	}
+#if ENABLE_STATS
+	// min, max, mean and standard deviation of the snapshot values since the previous row
+	for (byte i = 0; i < SNAPSHOT_CHANNELS; i++)
+	{
+		RunningStats &stats = this->sensorHub->windowStats(STATS_LOG, i);
+		dataString += ",";
+		dataString += String(stats.minValue(), 3);
 		dataString += ",";
+		dataString += String(stats.maxValue(), 3);
+		dataString += ",";
+		dataString += String(stats.mean(), 3);
+		dataString += ",";
+		dataString += String(stats.stddev(), 3);
+		stats.reset();
+	}
+#endif
+	uint16_t crc = crc16(dataString.c_str(), dataString.length());
+	dataString += ",";
+	for (int8_t shift = 12; shift >= 0; shift -= 4)
+	{
+		dataString += "0123456789ABCDEF"[(crc >> shift) & 0xF];
+	}
+
+	// the header row is at most as long as a row with statistics
+	if (!openLog(day, dataString.length() + 2 + (logEnd == 0 ? SD_SECTOR_SIZE : 0)))
+		return;
+	if (logEnd == 0)
+	{
+		// write the file header
+		//logFile.println(F("Year,Month,Day,Hour,Minues,Second,pH,temp(C),DO(mg/l),ec(s/m),orp(mv)"));
+#if ENABLE_STATS
+		logFile.println(F("date,pH,temp(C),DO(mg/l),ec(s/m),orp(mv),flags,"
+						  "pH min,pH max,pH mean,pH sd,temp min,temp max,temp mean,temp sd,"
+						  "DO min,DO max,DO mean,DO sd,ec min,ec max,ec mean,ec sd,"
+						  "orp min,orp max,orp mean,orp sd,crc"));
+#else
+		logFile.println(F("date,pH,temp(C),DO(mg/l),ec(s/m),orp(mv),flags,crc"));
+#endif
+	}
+	unsigned long start = logFile.curPosition();
+	logFile.println(dataString);
+	logFile.sync();
+	logEnd = logFile.curPosition();
+#if ENABLE_RANGE
+	if (indexRows == 0)
+		appendIndex(snapshot.time, start);
+	if (++indexRows >= SD_INDEX_ROWS)
+		indexRows = 0;
+#endif
+	Debug::println(dataString);
+}
+#endif
 
-		// write SD card, write data twice, to prevent a single write data caused by the loss of too large
-		dataFile = SD.open("sensor.csv", FILE_WRITE);
-		if (dataFile)
+#if !SD_RAW_LOG
+//********************************************************************************************
+// function name: openLog ()
+// Function Description: Keeps the log of the day open, moves on to the next part when it is
+// full and to a new log when the day changes. After a reset the last part of the day is
+// continued if it was not closed.
+// Parameters: day     yyyymmdd of the record to write
+// Parameters: needed  bytes the next write may take
+// Return Value: false if no log could be opened
+//********************************************************************************************
+bool SdService::openLog(unsigned long day, uint16_t needed)
+{
+	if (logOpen)
+	{
+		if (day == logDay && logEnd + needed <= SD_LOG_FILE_SIZE)
+			return true;
+		closeLog();
+		if (day == logDay)
+			logPart++;
+	}
+	if (day != logDay)
+	{
+		logDay = day;
+		logPart = 0;
+	}
+
+	char name[13];
+	uint32_t firstBlock, lastBlock;
+	SdFile month;
+	if (!openMonth(month, logDay, true))
+	{
+		Debug::println(F("error opening month"));
+		return false;
+	}
+	for (; logPart < SD_LOG_PARTS; logPart++)
+	{
+		logName(name, logDay, logPart);
+		if (!logFile.open(&month, name, O_RDWR))
+			return createLog(&month, name);
+		// a closed log was cut to its length, only a full size contiguous one can still take rows
+		if (logFile.fileSize() == SD_LOG_FILE_SIZE && logFile.contiguousRange(&firstBlock, &lastBlock) &&
+			lastBlock - firstBlock + 1 == SD_LOG_FILE_SIZE / SD_SECTOR_SIZE && resumeLog() &&
+#if ENABLE_RANGE
+			logEnd + needed <= SD_LOG_FILE_SIZE && openIndex(&month, name, O_WRITE | O_CREAT | O_APPEND))
+#else
+			logEnd + needed <= SD_LOG_FILE_SIZE)
+#endif
 		{
-			dataFile.print(dataString);
-			dataFile.close();
-			Debug::print(dataString);
+			logOpen = true;
+			return true;
 		}
+		logFile.close();
+	}
+	Debug::println(F("no free log name"));
+	return false;
+}
+
+//********************************************************************************************
+// function name: openMonth ()
+// Function Description: Opens the directory YYMM that holds the logs of the month of day. A
+// directory is only read through the handle, it needs no close().
+//********************************************************************************************
+bool SdService::openMonth(SdFile &month, unsigned long day, bool create)
+{
+	char name[5];
+	monthName(name, day);
+	if (month.open(&root, name, O_READ))
+		return true;
+	return create && month.makeDir(&root, name);
+}
 
-		dataString = "";
-		//ph
-		if (this->gravitySensor[0] != NULL)
+//********************************************************************************************
+// function name: createLog ()
+// Function Description: Creates a contiguous log and erases its blocks. A card that cannot
+// erase gets a log that grows with every write instead.
+//********************************************************************************************
+bool SdService::createLog(SdFile *month, const char *name)
+{
+	uint32_t firstBlock, lastBlock;
+#if ENABLE_RANGE
+	// an index left behind by an earlier log of this name would point into the old rows
+	if (!openIndex(month, name, O_WRITE | O_CREAT | O_TRUNC))
+	{
+		Debug::println(F("error opening index"));
+		return false;
+	}
+#endif
+	if (logFile.createContiguous(month, name, SD_LOG_FILE_SIZE))
+	{
+		if (!logFile.contiguousRange(&firstBlock, &lastBlock) || !card.erase(firstBlock, lastBlock))
 		{
-			connectString(this->gravitySensor[0]->getValue());
+			Debug::println(F("erase failed"));
+			logFile.truncate(0);
 		}
+	}
+	else if (!logFile.open(month, name, O_RDWR | O_CREAT))
+	{
+		Debug::println(F("error opening log"));
+#if ENABLE_RANGE
+		indexFile.close();
+#endif
+		return false;
+	}
+	logFile.seekSet(0);
+	logOpen = true;
+	logEnd = 0;
+#if SD_COMPRESSED
+	this->codec.restart();
+#elif ENABLE_RANGE
+	indexRows = 0;
+#endif
+	appendManifest(name, F("OPEN"));
+	return true;
+}
+
+//********************************************************************************************
+// function name: resumeLog ()
+// Function Description: Finds the end of the rows of a preallocated log. Used sectors start with
+// a record, erased ones read as 0x00 or 0xFF, so the first erased sector is found by a binary
+// search. Records continue in the next sector, csv rows after the last complete row.
+//********************************************************************************************
+bool SdService::resumeLog()
+{
+	unsigned long low = 0, high = SD_LOG_FILE_SIZE / SD_SECTOR_SIZE;
+	while (low < high)
+	{
+		unsigned long middle = (low + high) / 2;
+		int16_t first = logFile.seekSet(middle * SD_SECTOR_SIZE) ? logFile.read() : -1;
+		if (first < 0)
+			return false;
+		if (first != 0x00 && first != 0xFF)
+			low = middle + 1;
 		else
-			connectString(0);
+			high = middle;
+	}
+	logEnd = low > 0 ? tailEnd((low - 1) * SD_SECTOR_SIZE) : 0;
+#if SD_COMPRESSED
+	this->codec.restart();
+#elif ENABLE_RANGE
+	indexRows = 0;
+#endif
+	return logFile.seekSet(logEnd);
+}
 
-		// temperature
-		if (this->gravitySensor[1] != NULL)
+#if SD_COMPRESSED
+//********************************************************************************************
+// function name: tailEnd ()
+// Function Description: Walks the frames of the last used sector, the log ends behind the last
+// frame whose CRC matches
+//********************************************************************************************
+unsigned long SdService::tailEnd(unsigned long sector)
+{
+	uint16_t end = 0;
+	while (end + SD_FRAME_OVERHEAD < SD_SECTOR_SIZE && logFile.seekSet(sector + end))
+	{
+		int16_t length = logFile.read();
+		if (length <= 0 || length > CODEC_MAX_RECORD || end + length + SD_FRAME_OVERHEAD > SD_SECTOR_SIZE)
+			break; // padding, erased or torn
+		uint16_t crc = crc16Update(CRC16_INIT, length);
+		for (uint8_t i = 0; i < length; i++)
 		{
-			connectString(this->gravitySensor[1]->getValue());
+			crc = crc16Update(crc, logFile.read());
 		}
-		else
-			connectString(0);
+		uint16_t stored = logFile.read();
+		stored |= logFile.read() << 8;
+		if (crc != stored)
+			break;
+		end += length + SD_FRAME_OVERHEAD;
+	}
+	return sector + end;
+}
+#else
+//********************************************************************************************
+// function name: tailEnd ()
+// Function Description: Finds the last complete row whose CRC matches, rows are shorter than a
+// sector so only the last used sector and the one before it are read
+//********************************************************************************************
+unsigned long SdService::tailEnd(unsigned long sector)
+{
+	unsigned long end = sector + SD_SECTOR_SIZE;
+	unsigned long limit = sector > SD_SECTOR_SIZE ? sector - SD_SECTOR_SIZE : 0;
+	// newline of the last row
+	while (end > limit)
+	{
+		logFile.seekSet(end - 1);
+		if (logFile.read() == '\n')
+			break;
+		end--;
+	}
+	while (end > limit)
+	{
+		unsigned long start = end - 1;
+		while (start > limit)
+		{
+			logFile.seekSet(start - 1);
+			if (logFile.read() == '\n')
+				break;
+			start--;
+		}
+		if (start == 0 || validRow(start, end))
+			return end; // the header row has no CRC
+		end = start;
+	}
+	return end;
+}
 
-		//DO
-		if (this->gravitySensor[2] != NULL)
+// the text before the last comma of a row matches the CRC behind it
+bool SdService::validRow(unsigned long start, unsigned long end)
+{
+	uint16_t crc = CRC16_INIT, crcBeforeComma = 0, stored = 0;
+	logFile.seekSet(start);
+	for (unsigned long i = start; i < end - 1; i++)
+	{
+		int16_t c = logFile.read();
+		if (c < 0)
+			return false;
+		if (c == ',')
 		{
-			connectString(this->gravitySensor[2]->getValue());
+			crcBeforeComma = crc;
+			stored = 0;
 		}
-		else
-			connectString(0);
+		else if (c != '\r')
+		{
+			stored = stored << 4 | (c <= '9' ? c - '0' : c - 'A' + 10);
+		}
+		crc = crc16Update(crc, c);
+	}
+	return stored == crcBeforeComma;
+}
+#endif
 
-		//EC
-		if (this->gravitySensor[3] != NULL)
+void SdService::closeLog()
+{
+	logFile.truncate(logEnd);
+	logFile.close();
+#if ENABLE_RANGE
+	indexFile.close();
+#endif
+	logOpen = false;
+	char name[13];
+	logName(name, logDay, logPart);
+	appendManifest(name, F("CLOSED"));
+}
+
+// YYMMDDPP.BIN from day and part
+void SdService::logName(char *name, unsigned long day, uint8_t part)
+{
+	unsigned long digits = (day % 1000000UL) * 100 + part;
+	for (int8_t i = 7; i >= 0; i--)
+	{
+		name[i] = '0' + digits % 10;
+		digits /= 10;
+	}
+	strcpy(name + 8, "." SD_LOG_EXTENSION);
+}
+
+// YYMM, the directory of the logs of a month
+void SdService::monthName(char *name, unsigned long day)
+{
+	unsigned long digits = day / 100 % 10000;
+	for (int8_t i = 3; i >= 0; i--)
+	{
+		name[i] = '0' + digits % 10;
+		digits /= 10;
+	}
+	name[4] = '\0';
+}
+
+#if ENABLE_RANGE
+bool SdService::openIndex(SdFile *month, const char *name, uint8_t flags)
+{
+	char indexName[13];
+	strcpy(indexName, name);
+	strcpy(indexName + 9, SD_INDEX_EXTENSION);
+	return indexFile.open(month, indexName, flags);
+}
+#endif
+
+void SdService::appendManifest(const char *name, const __FlashStringHelper *state)
+{
+	SdFile manifest;
+	char month[5];
+	if (!manifest.open(&root, SD_MANIFEST_FILE, O_WRITE | O_CREAT | O_APPEND))
+		return;
+	monthName(month, logDay);
+	manifest.print(month);
+	manifest.print('/');
+	manifest.print(name);
+	manifest.print(',');
+	manifest.print(state);
+	manifest.print(',');
+	manifest.print(logTime);
+	if (!logOpen)
+	{
+		manifest.print(',');
+		manifest.print(logEnd);
+	}
+	manifest.println();
+	manifest.close();
+}
+
+#if ENABLE_RANGE
+void SdService::appendIndex(unsigned long time, unsigned long offset)
+{
+	uint32_t entry[2] = {(uint32_t)time, (uint32_t)offset};
+	indexFile.write((const uint8_t *)entry, sizeof(entry));
+	indexFile.sync();
+}
+
+//********************************************************************************************
+// function name: indexOffset ()
+// Function Description: Binary search of the index of a log for the last entry at or before
+// time, its record is where a range from time starts reading
+// Return Value: offset of that record, 0 without an index or an entry before time
+//********************************************************************************************
+unsigned long SdService::indexOffset(SdFile *month, const char *name, unsigned long time)
+{
+	char indexName[13];
+	SdFile index;
+	strcpy(indexName, name);
+	strcpy(indexName + 9, SD_INDEX_EXTENSION);
+	if (!index.open(month, indexName, O_READ))
+		return 0;
+	uint32_t entry[2];
+	unsigned long offset = 0, low = 0, high = index.fileSize() / sizeof(entry);
+	while (low < high)
+	{
+		unsigned long middle = (low + high) / 2;
+		if (!index.seekSet(middle * sizeof(entry)) || index.read(entry, sizeof(entry)) != sizeof(entry))
+			break;
+		if (entry[0] <= time)
 		{
-			connectString(this->gravitySensor[3]->getValue());
+			offset = entry[1];
+			low = middle + 1;
 		}
 		else
-			connectString(0);
+		{
+			high = middle;
+		}
+	}
+	index.close();
+	return offset;
+}
+
+//********************************************************************************************
+// function name: range ()
+// Function Description: Starts streaming the records logged from epoch from to epoch to, a
+// range that is still running starts over
+//********************************************************************************************
+void SdService::range(unsigned long from, unsigned long to)
+{
+	if (rangeFile.isOpen())
+		rangeFile.close();
+	unsigned long now = this->sensorHub->snapshot().time;
+	rangeFrom = from;
+	rangeTo = to;
+	rangeDay = dayOf(from);
+	rangeLastDay = dayOf(to < now ? to : now); // no logs to look for after today
+	rangePart = 0;
+	rangeCount = 0;
+	rangeActive = true;
+}
+
+bool SdService::ranging()
+{
+	return rangeActive;
+}
+
+//********************************************************************************************
+// function name: streamRange ()
+// Function Description: Sends the next REC frame of the range. Records before the range and
+// missing logs are skipped, at most SD_RANGE_SCAN of them per call so a pass stays short.
+//********************************************************************************************
+void SdService::streamRange()
+{
+	if (!telemetry.beginFrame(TELEMETRY_REPORT_RESERVE))
+		return;
+	for (uint8_t scanned = 0; scanned < SD_RANGE_SCAN; scanned++)
+	{
+		int8_t result = -2;
+		if (rangeFile.isOpen())
+			result = rangeRecord();
+		else if (openRange())
+			continue;
+
+		if (result == 1)
+			return;
+		if (result == -1)
+		{
+			rangeFile.close();
+			rangePart++;
+		}
+		else if (result == -2)
+		{
+			if (rangeFile.isOpen())
+				rangeFile.close();
+			rangeActive = false;
+			telemetry.print(F("RANGEEND@"));
+			telemetry.println(rangeCount);
+			return;
+		}
+	}
+}
 
-		//Orp
-		if (this->gravitySensor[4] != NULL)
+bool SdService::openRange()
+{
+	if (!sdReady || rangeDay > rangeLastDay)
+		return false;
+	char name[13];
+	SdFile month;
+	if (!openMonth(month, rangeDay, false))
+	{
+		// no directory, no logs that month, go on with the first day of the next one
+		unsigned long yearMonth = rangeDay / 100;
+		rangeDay = (yearMonth % 100 == 12 ? yearMonth + 89 : yearMonth + 1) * 100 + 1;
+		rangePart = 0;
+		return true;
+	}
+	if (rangePart < SD_LOG_PARTS)
+	{
+		logName(name, rangeDay, rangePart);
+		if (rangeFile.open(&month, name, O_READ))
 		{
-			connectString(this->gravitySensor[4]->getValue());
+			rangeFile.seekSet(indexOffset(&month, name, rangeFrom));
+#if SD_COMPRESSED
+			rangeCodec.restart();
+#endif
+			return true;
 		}
+	}
+	// parts of a day are numbered without gaps, go on with the next day
+	rangeDay = dayOf(GravityRtc::toEpoch(rangeDay / 10000, rangeDay / 100 % 100, rangeDay % 100, 12, 0, 0) + 86400UL);
+	rangePart = 0;
+	return true;
+}
+
+#if SD_COMPRESSED
+//********************************************************************************************
+// function name: rangeRecord ()
+// Function Description: Reads the next frame of rangeFile. A frame that does not check out
+// ends its sector, the next sector starts with a keyframe again.
+//********************************************************************************************
+int8_t SdService::rangeRecord()
+{
+	// the log being written ends at logEnd, the rest of it is erased
+	unsigned long end = logOpen && rangeDay == logDay && rangePart == logPart ? logEnd : rangeFile.fileSize();
+	unsigned long position = rangeFile.curPosition();
+	uint16_t room = SD_SECTOR_SIZE - position % SD_SECTOR_SIZE;
+	if (position + SD_FRAME_OVERHEAD > end)
+		return -1;
+
+	uint8_t frame[CODEC_MAX_RECORD + SD_FRAME_OVERHEAD];
+	int16_t length = rangeFile.read();
+	bool valid = length > 0 && length <= CODEC_MAX_RECORD && length + SD_FRAME_OVERHEAD <= room &&
+				 position + length + SD_FRAME_OVERHEAD <= end;
+	if (valid)
+	{
+		frame[0] = length;
+		valid = rangeFile.read(frame + 1, length + 2) == length + 2 &&
+				crc16(frame, length + 1) == (frame[length + 1] | frame[length + 2] << 8);
+	}
+	if (!valid)
+	{
+		if (position % SD_SECTOR_SIZE == 0)
+			return -1; // an erased sector, the rows end here
+		rangeFile.seekSet(position + room);
+		rangeCodec.restart();
+		return 0;
+	}
+
+	CodecSample sample;
+	if (!rangeCodec.decode(frame + 1, length, sample))
+		return 0;
+	if (sample.stamp > rangeTo)
+		return -2;
+	if (sample.stamp < rangeFrom)
+		return 0;
+
+	telemetry.print(F("REC@"));
+	telemetry.print(sample.stamp);
+	for (byte i = 0; i < SNAPSHOT_CHANNELS; i++)
+	{
+		telemetry.print(',');
+		telemetry.print(sample.value[i], pgm_read_byte(&rangeDecimals[i]));
+	}
+	telemetry.print(',');
+	for (byte i = 0; i < SNAPSHOT_CHANNELS; i++)
+	{
+		if (i > 0)
+			telemetry.print('/');
+		telemetry.print(sample.flags[i], HEX);
+	}
+	telemetry.print(',');
+	telemetry.println(sample.aux);
+	rangeCount++;
+	return 1;
+}
+#else
+//********************************************************************************************
+// function name: rangeRecord ()
+// Function Description: Reads the next row of rangeFile, the date is turned back into an epoch
+// and the values and flags are copied into the frame, the statistics and the CRC are left out
+//********************************************************************************************
+int8_t SdService::rangeRecord()
+{
+	unsigned long end = logOpen && rangeDay == logDay && rangePart == logPart ? logEnd : rangeFile.fileSize();
+	if (rangeFile.curPosition() >= end)
+		return -1;
+	int16_t c = rangeFile.read();
+	if (c < 0 || c == 0x00 || c == 0xFF)
+		return -1; // erased, the rows end here
+
+	// year/month/day/hour/minute/second
+	unsigned int field[6] = {0, 0, 0, 0, 0, 0};
+	uint8_t fields = 0;
+	for (; c >= 0 && c != ',' && c != '\n'; c = rangeFile.read())
+	{
+		if (c == '/')
+			fields++;
+		else if (c >= '0' && c <= '9' && fields < 6)
+			field[fields] = field[fields] * 10 + c - '0';
 		else
-			connectString(0);
+			fields = 6; // the header row
+	}
+	unsigned long time = 0;
+	if (fields == 5 && c == ',')
+		time = GravityRtc::toEpoch(field[0], field[1], field[2], field[3], field[4], field[5]);
+	if (time > rangeTo)
+		return -2;
 
-		// write SD card
-		dataFile = SD.open("sensor.csv", FILE_WRITE);
-		if (dataFile)
+	bool send = time != 0 && time >= rangeFrom;
+	if (send)
+	{
+		telemetry.print(F("REC@"));
+		telemetry.print(time);
+		telemetry.print(',');
+		uint8_t commas = 0;
+		while ((c = rangeFile.read()) >= 0 && c != '\n' && c != '\r')
 		{
-			dataFile.println(dataString);
-			dataFile.close();
-			Debug::println(dataString);
+			if (c == ',' && ++commas > SNAPSHOT_CHANNELS)
+				break; // after the flags
+			telemetry.print((char)c);
 		}
-		sdDataUpdateTime = millis();
+		telemetry.println();
+		rangeCount++;
+	}
+	while (c >= 0 && c != '\n')
+	{
+		c = rangeFile.read();
 	}
+	return send ? 1 : 0;
 }
+#endif
+#endif // ENABLE_RANGE
+#endif
 
+#if !SD_COMPRESSED && !SD_RAW_LOG
 //********************************************************************************************
 // function name: connectString ()
 // Function Description: Connects the string data
@@ -178,3 +946,6 @@ void SdService::connectString(double value)
 	dataString += String(value, 10);
 	dataString += ",";
 }
+#endif
+
+#endif // ENABLE_SD_LOG
@@ -10,6 +10,7 @@
 *
 * Description:SD card datalogger,Data write format:
 * "Year,Month,Day,Hour,Minues,Second,pH,temp(C),DO(mg/l0,ec(s/m),orp(mv)"
+* or SampleCodec records (SD_COMPRESSED), one log per day, see SdService.cpp
 *
 * Product Links:http://www.dfrobot.com.cn/goods-1142.html
 *
@@ -27,10 +28,14 @@
 
 #pragma once
 
-#include "ISensor.h"
-#include <SD.h>
+#include "GravitySensorHub.h"
+#include "SampleCodec.h"
+#include "RawLog.h"
 #include "string.h"
 
+#if ENABLE_SD_LOG
+#include <SD.h>
+
 class SdService
 {
 
@@ -38,7 +43,7 @@ public:
 	int chipSelect;
 
 public:
-	SdService(ISensor *gravitySensor[]);
+	SdService(GravitySensorHub *hub);
 	~SdService();
 
 	// initialization
@@ -46,18 +51,119 @@ public:
 
 	// Update write SD card data
 	void update();
+	// ms until update() writes the next record
+	unsigned long idleTime();
+	// root directory of the card, NULL without a card
+	SdFile *directory();
+
+#if ENABLE_RANGE
+	// stream the logged records from epoch from to epoch to, one frame per update()
+	void range(unsigned long from, unsigned long to);
+	// a range is being streamed
+	bool ranging();
+#endif
 
 private:
-	// points to the pointer to the array of sensors
-	ISensor **gravitySensor;
+	// the rows are written from the hub snapshot
+	GravitySensorHub *sensorHub;
 	//String dataString ;
 
 	bool sdReady = false;
 
-	// file handle
-	File dataFile;
 	unsigned long sdDataUpdateTime;
 
+	Sd2Card card;
+#if SD_RAW_LOG
+	RawLog rawLog;
+#else
+	SdVolume volume;
+	SdFile root;
+
+	// log of the current day and its index, kept open between writes
+	SdFile logFile;
+#if ENABLE_RANGE
+	SdFile indexFile;
+#endif
+	bool logOpen;
+	unsigned long logDay;  // yyyymmdd of logFile
+	uint8_t logPart;	   // part of the day, the next part starts when a log is full
+	unsigned long logEnd;  // bytes written, the rest of a preallocated log is erased
+	unsigned long logTime; // epoch of the row being written, for the manifest
+#if ENABLE_RANGE && !SD_COMPRESSED
+	uint8_t indexRows; // rows since the last index entry
+#endif
+
+#if ENABLE_RANGE
+	// range being streamed, see range()
+	SdFile rangeFile;
+	bool rangeActive;
+	unsigned long rangeFrom;
+	unsigned long rangeTo;
+	unsigned long rangeDay;		// yyyymmdd of rangeFile
+	unsigned long rangeLastDay; // yyyymmdd of the last log to read
+	uint8_t rangePart;
+	unsigned long rangeCount; // records sent
+#if SD_COMPRESSED
+	SampleCodec rangeCodec;
+#endif
+#endif
+
+	// make sure the log of the day has room for needed more bytes
+	bool openLog(unsigned long day, uint16_t needed);
+	// open the directory of the month of day, create it if asked to
+	bool openMonth(SdFile &month, unsigned long day, bool create);
+	// preallocate and erase a new log in month
+	bool createLog(SdFile *month, const char *name);
+#if ENABLE_RANGE
+	// open the index of the log name in month as indexFile
+	bool openIndex(SdFile *month, const char *name, uint8_t flags);
+#endif
+	// find the end of the rows in a log that was not closed
+	bool resumeLog();
+	// end of the last valid frame or row in the sector at this offset or before
+	unsigned long tailEnd(unsigned long sector);
+#if !SD_COMPRESSED
+	bool validRow(unsigned long start, unsigned long end);
+#endif
+	// cut the log to its rows and close it
+	void closeLog();
+	void logName(char *name, unsigned long day, uint8_t part);
+	void monthName(char *name, unsigned long day);
+	void appendManifest(const char *name, const __FlashStringHelper *state);
+#if ENABLE_RANGE
+	// add an entry for the record at offset to the index of the open log
+	void appendIndex(unsigned long time, unsigned long offset);
+	// offset of the last indexed record at or before time in the named log of month
+	unsigned long indexOffset(SdFile *month, const char *name, unsigned long time);
+
+	// send the next record of the range
+	void streamRange();
+	// try the next log of the range and open it at the indexed offset
+	// Return Value: false once the range has no more logs
+	bool openRange();
+	// read the next record of rangeFile and send it if it is in the range
+	// Return Value: 1 sent, 0 skipped, -1 end of the log, -2 past the range
+	int8_t rangeRecord();
+#endif
+#endif
+
+#if SD_RAW_LOG
+	// append a snapshot to the raw log
+	void writeRaw(const SensorSnapshot &snapshot);
+#elif SD_COMPRESSED
+	SampleCodec codec;
+
+	// append a snapshot as a SampleCodec record
+	void writeSample(const SensorSnapshot &snapshot, unsigned long day);
+#else
+	// append a snapshot as a csv row
+	void writeRow(const SensorSnapshot &snapshot, unsigned long day);
+
 	// Connect the string data
 	void connectString(double value);
+#endif
 };
+
+extern SdService sdService;
+
+#endif // ENABLE_SD_LOG
@@ -0,0 +1,158 @@
+/*********************************************************************
+* Telemetry.cpp
+*
+* Description: Non-blocking serial output stage
+*
+* version :  V1.0
+* date    :  2026-10-19
+**********************************************************************/
+
+#include "Telemetry.h"
+#include "IdleManager.h"
+
+Telemetry::Telemetry() : bytesQueued(0), bytesDropped(0), framesCoalesced(0), stalledTime(0),
+						 lineQueued(0), lineDropped(false), stallStart(0), stalled(false) {}
+
+Telemetry::~Telemetry() {}
+
+//********************************************************************************************
+// function name: update ()
+// Function Description: Copies as many queued bytes as the UART TX buffer has room for
+//********************************************************************************************
+void Telemetry::update()
+{
+	int room = Serial.availableForWrite();
+	uint8_t data;
+	while (room > 0 && this->queue.pop(data))
+	{
+		Serial.write(data);
+		room--;
+	}
+
+	// account the time the link could not keep up
+	bool waiting = !this->queue.empty();
+	if (waiting && !this->stalled)
+	{
+		this->stallStart = millis();
+	}
+	else if (!waiting && this->stalled)
+	{
+		this->stalledTime += millis() - this->stallStart;
+	}
+	this->stalled = waiting;
+}
+
+//********************************************************************************************
+// function name: idleTime ()
+// Function Description: Returns 0 while queued bytes fit into the UART, 1 ms (about one byte at
+// 9600 baud) while they wait for room, and IDLE_FOREVER when the queue is empty
+//********************************************************************************************
+unsigned long Telemetry::idleTime()
+{
+	if (this->queue.empty())
+		return IDLE_FOREVER;
+	return Serial.availableForWrite() > 0 ? 0 : 1;
+}
+
+//********************************************************************************************
+// function name: beginFrame ()
+// Function Description: Checks that a whole frame fits before the caller prints it
+// Parameters: length  worst case length of the frame in bytes
+// Return Value: true if the frame can be printed now
+//********************************************************************************************
+bool Telemetry::beginFrame(size_t length)
+{
+	return this->queue.space() >= length;
+}
+
+void Telemetry::coalesceFrame()
+{
+	this->framesCoalesced++;
+}
+
+//********************************************************************************************
+// function name: printCounters ()
+// Function Description: LINK@queued,dropped,coalesced,stalled ms
+//********************************************************************************************
+void Telemetry::printCounters()
+{
+	unsigned long stalledNow = this->stalledTime;
+	if (this->stalled)
+		stalledNow += millis() - this->stallStart;
+	print(F("LINK@"));
+	print(this->bytesQueued);
+	print(',');
+	print(this->bytesDropped);
+	print(',');
+	print(this->framesCoalesced);
+	print(',');
+	println(stalledNow);
+}
+
+//********************************************************************************************
+// function name: printBase64 ()
+// Function Description: Prints 4 characters for every 3 bytes, the '=' padding is left out
+//********************************************************************************************
+void Telemetry::printBase64(const uint8_t *data, size_t length)
+{
+	static const char alphabet[] PROGMEM = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+	for (size_t i = 0; i < length; i += 3)
+	{
+		unsigned long group = (unsigned long)data[i] << 16;
+		if (i + 1 < length)
+			group |= (unsigned long)data[i + 1] << 8;
+		if (i + 2 < length)
+			group |= data[i + 2];
+		byte characters = length - i >= 3 ? 4 : length - i + 1;
+		for (byte j = 0; j < characters; j++)
+		{
+			write(pgm_read_byte(&alphabet[(group >> (18 - 6 * j)) & 0x3F]));
+		}
+	}
+}
+
+//********************************************************************************************
+// function name: setBaud ()
+// Function Description: Blocks until the queue and the UART are empty, at most
+// TELEMETRY_QUEUE_SIZE + 64 bytes at the old rate, and restarts the UART at the new one
+//********************************************************************************************
+void Telemetry::setBaud(unsigned long baud)
+{
+	uint8_t data;
+	while (this->queue.pop(data))
+	{
+		Serial.write(data);
+	}
+	Serial.flush();
+	Serial.begin(baud);
+}
+
+//********************************************************************************************
+// function name: write ()
+// Function Description: Queues a byte. When a line does not fit, its start is taken back out of
+// the queue, which update() cannot have sent yet as lines are printed within one loop() task,
+// and the rest of it is dropped up to and including the newline.
+//********************************************************************************************
+size_t Telemetry::write(uint8_t data)
+{
+	if (!this->lineDropped && this->queue.push(data))
+	{
+		this->bytesQueued++;
+		this->lineQueued = data == '\n' ? 0 : this->lineQueued + 1;
+		return 1;
+	}
+	if (!this->lineDropped && this->queue.unpush(this->lineQueued))
+	{
+		this->bytesQueued -= this->lineQueued;
+		this->bytesDropped += this->lineQueued;
+	}
+	this->lineQueued = 0;
+	this->lineDropped = data != '\n';
+	this->bytesDropped++;
+	return 0;
+}
+
+int Telemetry::availableForWrite()
+{
+	return this->queue.space();
+}
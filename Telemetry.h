@@ -0,0 +1,69 @@
+/*********************************************************************
+* Telemetry.h
+*
+* Description: Non-blocking serial output stage. Everything sent to the
+* Raspberry Pi is queued here and moved into the HardwareSerial TX buffer
+* only as fast as the UART drains it, so loop() never waits on the link.
+*
+* Report frames reserve their whole length with beginFrame() before they
+* are printed. A frame that does not fit stays pending in the caller and
+* is rebuilt with fresh values on a later pass (coalesced). A line printed
+* outside a frame that does not fit is dropped whole: the part already
+* queued is taken back and the rest is discarded up to its newline, so the
+* host never receives a cut line.
+*
+* version :  V1.0
+* date    :  2026-10-19
+**********************************************************************/
+
+#pragma once
+#include <Arduino.h>
+#include "config.h"
+#include "RingBuffer.h"
+
+class Telemetry : public Print
+{
+public:
+	// counters since boot
+	unsigned long bytesQueued;	   // bytes accepted into the queue
+	unsigned long bytesDropped;	   // bytes of the lines lost because the queue was full
+	unsigned long framesCoalesced; // report frames replaced by a newer one before they fitted
+	unsigned long stalledTime;	   // ms during which queued data waited for room in the UART
+
+public:
+	Telemetry();
+	~Telemetry();
+
+	// move queued bytes into the UART without blocking
+	void update();
+	// ms until update() can move queued bytes again
+	unsigned long idleTime();
+
+	// reserve room for a frame of up to length bytes, false if it does not fit yet
+	bool beginFrame(size_t length);
+
+	// count a report frame that was superseded while waiting for room
+	void coalesceFrame();
+
+	// print the counters as a LINK frame
+	void printCounters();
+
+	// print binary data as base64 without padding
+	void printBase64(const uint8_t *data, size_t length);
+
+	// send everything queued at the old rate, then switch the UART to baud
+	void setBaud(unsigned long baud);
+
+	size_t write(uint8_t data);
+	using Print::write;
+	int availableForWrite();
+
+private:
+	RingBuffer<uint8_t, TELEMETRY_QUEUE_SIZE> queue;
+	uint16_t lineQueued; // bytes of the current line in the queue
+	bool lineDropped;	 // the current line did not fit, drop it up to its newline
+	unsigned long stallStart;
+	bool stalled;
+};
+
+extern Telemetry telemetry;
@@ -0,0 +1,152 @@
+/*********************************************************************
+* Watchdog.cpp
+*
+* Description: Watchdog supervised loop with crash breadcrumbs
+*
+* version :  V1.0
+* date    :  2026-10-19
+**********************************************************************/
+
+#include "Watchdog.h"
+
+#if ENABLE_WATCHDOG
+
+#include "Telemetry.h"
+#if defined(__AVR__)
+#include <avr/io.h>
+#include <avr/wdt.h>
+#endif
+
+#define WATCHDOG_MAGIC 0xB0C4
+
+// survives the watchdog reset, not touched by the C runtime start up
+static WatchdogBreadcrumbs breadcrumbs __attribute__((section(".noinit")));
+
+#if defined(__AVR__)
+static uint8_t bootResetCause __attribute__((section(".noinit")));
+
+//********************************************************************************************
+// function name: captureResetCause ()
+// Function Description: Runs from .init3, before the C runtime start up. Saves the reset
+// cause and stops the watchdog, which stays enabled with the shortest timeout after a
+// watchdog reset. Optiboot clears MCUSR itself and hands the flags over in r2.
+//********************************************************************************************
+extern "C" void captureResetCause() __attribute__((naked, used, section(".init3")));
+void captureResetCause()
+{
+	uint8_t flags;
+	__asm__ __volatile__("mov %0, r2" : "=r"(flags));
+	if (MCUSR)
+		flags = MCUSR;
+	bootResetCause = flags;
+	MCUSR = 0;
+	wdt_disable();
+}
+
+extern char __heap_start;
+extern char *__brkval;
+#endif
+
+Watchdog::Watchdog() : resetCause(0), checkedIn(0) {}
+
+Watchdog::~Watchdog() {}
+
+//********************************************************************************************
+// function name: setup ()
+// Function Description: Takes over the breadcrumbs of the previous run, queues the BOOT
+// frame and starts the watchdog
+//********************************************************************************************
+void Watchdog::setup()
+{
+	bool powerOn = true;
+#if defined(__AVR__)
+	this->resetCause = bootResetCause;
+	powerOn = this->resetCause & bit(PORF);
+#endif
+	if (breadcrumbs.magic == WATCHDOG_MAGIC && !powerOn)
+	{
+		this->previous = breadcrumbs;
+	}
+	else
+	{
+		// power on, the RAM content is random
+		this->previous.task = WATCHDOG_UNKNOWN;
+		this->previous.step = WATCHDOG_UNKNOWN;
+		this->previous.loops = 0;
+		this->previous.minFree = 0;
+	}
+
+	breadcrumbs.magic = WATCHDOG_MAGIC;
+	breadcrumbs.task = WATCHDOG_UNKNOWN;
+	breadcrumbs.step = WATCHDOG_UNKNOWN;
+	breadcrumbs.loops = 0;
+	breadcrumbs.minFree = freeMemory();
+
+	if (telemetry.beginFrame(WATCHDOG_FRAME_RESERVE))
+	{
+		telemetry.print(F("BOOT@"));
+		telemetry.print(this->resetCause);
+		telemetry.print(',');
+		telemetry.print(this->previous.task);
+		telemetry.print(',');
+		telemetry.print(this->previous.step);
+		telemetry.print(',');
+		telemetry.print(this->previous.loops);
+		telemetry.print(',');
+		telemetry.print(this->previous.minFree);
+		telemetry.print(',');
+		telemetry.println(breadcrumbs.minFree);
+	}
+
+#if defined(__AVR__)
+	wdt_enable(WATCHDOG_TIMEOUT);
+#endif
+}
+
+//********************************************************************************************
+// function name: enter ()
+// Function Description: Records the task in progress and the stack depth
+//********************************************************************************************
+void Watchdog::enter(byte task)
+{
+	breadcrumbs.task = task;
+	breadcrumbs.step = WATCHDOG_UNKNOWN;
+	uint16_t freeRam = freeMemory();
+	if (freeRam < breadcrumbs.minFree)
+		breadcrumbs.minFree = freeRam;
+}
+
+void Watchdog::step(byte step)
+{
+	breadcrumbs.step = step;
+}
+
+//********************************************************************************************
+// function name: checkIn ()
+// Function Description: Marks a task as alive, the watchdog is fed once every required task
+// checked in
+//********************************************************************************************
+void Watchdog::checkIn(byte task)
+{
+	this->checkedIn |= bit(task);
+	if ((this->checkedIn & WATCHDOG_REQUIRED) == WATCHDOG_REQUIRED)
+	{
+		this->checkedIn = 0;
+		breadcrumbs.loops++;
+#if defined(__AVR__)
+		wdt_reset();
+#endif
+	}
+}
+
+uint16_t Watchdog::freeMemory()
+{
+#if defined(__AVR__)
+	char *heapEnd = __brkval ? __brkval : &__heap_start;
+	return SP - (uint16_t)heapEnd;
+#else
+	return 0;
+#endif
+}
+
+#endif // ENABLE_WATCHDOG
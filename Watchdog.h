@@ -0,0 +1,100 @@
+/*********************************************************************
+* Watchdog.h
+*
+* Description: Watchdog supervised loop with crash breadcrumbs.
+* Every loop() task is announced with WATCHDOG_ENTER(task) and checks
+* in with WATCHDOG_CHECKIN(task) when it returns. The watchdog is only
+* fed once all required tasks checked in, so a task that blocks (I2C,
+* SD card, ...) resets the board after WATCHDOG_TIMEOUT.
+*
+* The breadcrumbs (task and step in progress, loop passes, lowest free
+* RAM between heap and stack) live in .noinit RAM and survive the reset.
+* setup() reports them with the reset cause at the next boot:
+* "BOOT@cause,task,step,loops,minFree,free"
+* cause is MCUSR (1 power on, 2 external, 4 brown out, 8 watchdog),
+* task and step are 255 when unknown. free is the RAM left for the
+* stack once setup() allocated the sensors, minFree the lowest the
+* previous run saw.
+*
+* version :  V1.0
+* date    :  2026-10-19
+**********************************************************************/
+
+#pragma once
+#include <Arduino.h>
+#include "config.h"
+
+// "BOOT@" cause "," task "," step "," loops "," minFree "," free "\r\n"
+#define WATCHDOG_FRAME_RESERVE (5 + 3 + 1 + 3 + 1 + 3 + 1 + 10 + 1 + 5 + 1 + 5 + 2)
+#define WATCHDOG_UNKNOWN 0xFF
+#define WATCHDOG_IDLE_LIMIT 1000 // longest sleep in ms, well inside WATCHDOG_TIMEOUT
+
+enum WatchdogTask
+{
+	TASK_RTC = 0,
+	TASK_SENSORS,
+	TASK_WATER_LEVEL,
+	TASK_SD,
+	TASK_REPORT,
+	TASK_CALIBRATE,
+	TASK_TELEMETRY,
+	TASK_SLEEP, // breadcrumb only, does not have to check in
+	TASK_COUNT
+};
+
+#if ENABLE_WATCHDOG
+
+#define WATCHDOG_REQUIRED ((1 << TASK_SLEEP) - 1) // tasks that check in on every pass
+
+struct WatchdogBreadcrumbs
+{
+	uint16_t magic;		  // WATCHDOG_MAGIC when the rest is valid
+	uint8_t task;		  // task in progress
+	uint8_t step;		  // step inside the task, e.g. the sensor index
+	unsigned long loops;  // loop passes since boot
+	uint16_t minFree;	  // lowest free RAM between heap and stack seen
+};
+
+class Watchdog
+{
+public:
+	// breadcrumbs left by the previous run, valid after setup()
+	uint8_t resetCause;
+	WatchdogBreadcrumbs previous;
+
+public:
+	Watchdog();
+	~Watchdog();
+
+	// report the previous run and start the watchdog
+	void setup();
+
+	// a task starts
+	void enter(byte task);
+
+	// a step inside the current task starts
+	void step(byte step);
+
+	// a task returned, feeds the watchdog once all required tasks did
+	void checkIn(byte task);
+
+private:
+	uint8_t checkedIn; // bit per task since the last feed
+
+	// free RAM between the heap and the stack pointer
+	uint16_t freeMemory();
+};
+
+extern Watchdog watchdog;
+
+#define WATCHDOG_ENTER(task) watchdog.enter(task)
+#define WATCHDOG_STEP(n) watchdog.step(n)
+#define WATCHDOG_CHECKIN(task) watchdog.checkIn(task)
+
+#else
+
+#define WATCHDOG_ENTER(task)
+#define WATCHDOG_STEP(n)
+#define WATCHDOG_CHECKIN(task)
+
+#endif // ENABLE_WATCHDOG
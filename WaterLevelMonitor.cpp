@@ -0,0 +1,212 @@
+/*********************************************************************
+* WaterLevelMonitor.cpp
+*
+* Description: Interrupt driven, debounced water level monitoring
+*
+* Sensor driver pin: D8, D9 (WATER_LEVEL_PINS in config.h)
+*
+* version :  V1.0
+* date    :  2026-10-19
+**********************************************************************/
+
+#include "WaterLevelMonitor.h"
+#include "GravityRtc.h"
+#include "IdleManager.h"
+#if defined(__AVR__)
+#include <avr/interrupt.h>
+#endif
+
+extern GravityRtc rtc;
+
+WaterLevelMonitor::WaterLevelMonitor() : edgesDropped(0), eventsDropped(0), levels(0), candidates(0), edgesLost(0)
+{
+	static const uint8_t waterLevelPins[WATER_LEVEL_PIN_COUNT] = WATER_LEVEL_PINS;
+	for (byte i = 0; i < WATER_LEVEL_PIN_COUNT; i++)
+	{
+		this->pins[i] = waterLevelPins[i];
+#if defined(__AVR__)
+		this->masks[i] = digitalPinToBitMask(waterLevelPins[i]);
+#else
+		this->masks[i] = 1 << i;
+#endif
+		this->candidateTime[i] = 0;
+		this->transitionCount[i] = 0;
+	}
+}
+
+WaterLevelMonitor::~WaterLevelMonitor() {}
+
+//********************************************************************************************
+// function name: setup ()
+// Function Description: Reads the initial levels and enables the pin change interrupt
+//********************************************************************************************
+void WaterLevelMonitor::setup()
+{
+	for (byte i = 0; i < WATER_LEVEL_PIN_COUNT; i++)
+	{
+		pinMode(this->pins[i], INPUT);
+	}
+
+	uint8_t port = readPort();
+	for (byte i = 0; i < WATER_LEVEL_PIN_COUNT; i++)
+	{
+		if (port & this->masks[i])
+			this->levels |= (1 << i);
+	}
+	this->candidates = this->levels;
+
+#if defined(__AVR__)
+	for (byte i = 0; i < WATER_LEVEL_PIN_COUNT; i++)
+	{
+		*digitalPinToPCMSK(this->pins[i]) |= bit(digitalPinToPCMSKbit(this->pins[i]));
+	}
+	PCIFR |= bit(PCIF0);
+	PCICR |= bit(PCIE0);
+#endif
+}
+
+//********************************************************************************************
+// function name: update ()
+// Function Description: Applies the queued edges and accepts every level that stayed stable
+// for WATER_LEVEL_DEBOUNCE ms
+//********************************************************************************************
+void WaterLevelMonitor::update()
+{
+	Edge edge;
+	while (this->edges.pop(edge))
+	{
+		applyPort(edge.port, edge.time);
+	}
+
+#if !defined(__AVR__)
+	applyPort(readPort(), millis()); // no pin change interrupt, sample the pins instead
+#endif
+
+	if (this->edgesLost)
+	{
+		// edges were lost, resynchronise with the pins
+		noInterrupts();
+		uint8_t lost = this->edgesLost;
+		this->edgesLost = 0;
+		interrupts();
+		this->edgesDropped += lost;
+		applyPort(readPort(), millis());
+	}
+
+	unsigned long now = millis();
+	for (byte i = 0; i < WATER_LEVEL_PIN_COUNT; i++)
+	{
+		uint8_t mask = 1 << i;
+		if (!((this->candidates ^ this->levels) & mask) || now - this->candidateTime[i] < WATER_LEVEL_DEBOUNCE)
+			continue;
+
+		this->levels ^= mask;
+		this->transitionCount[i]++;
+
+		WaterLevelEvent event;
+		event.pin = i;
+		event.level = (this->levels & mask) ? HIGH : LOW;
+		event.time = rtc.epochAt(this->candidateTime[i]);
+		event.transitions = this->transitionCount[i];
+		if (!this->events.push(event))
+			this->eventsDropped++;
+	}
+}
+
+//********************************************************************************************
+// function name: idleTime ()
+// Function Description: Returns 0 while edges are queued, else the ms until the first pending
+// level has been stable for WATER_LEVEL_DEBOUNCE
+//********************************************************************************************
+unsigned long WaterLevelMonitor::idleTime()
+{
+#if !defined(__AVR__)
+	return 1; // no pin change interrupt, the pins are polled every ms
+#else
+	if (!this->edges.empty() || this->edgesLost)
+		return 0;
+
+	unsigned long idle = IDLE_FOREVER;
+	for (byte i = 0; i < WATER_LEVEL_PIN_COUNT; i++)
+	{
+		if ((this->candidates ^ this->levels) & (1 << i))
+		{
+			unsigned long pinIdle = timeUntil(this->candidateTime[i], WATER_LEVEL_DEBOUNCE);
+			if (pinIdle < idle)
+				idle = pinIdle;
+		}
+	}
+	return idle;
+#endif
+}
+
+byte WaterLevelMonitor::level(byte index)
+{
+	return (this->levels >> index) & 1;
+}
+
+unsigned int WaterLevelMonitor::transitions(byte index)
+{
+	return this->transitionCount[index];
+}
+
+bool WaterLevelMonitor::popEvent(WaterLevelEvent &event)
+{
+	return this->events.pop(event);
+}
+
+//********************************************************************************************
+// function name: onPinChange ()
+// Function Description: Queues the port state, runs in interrupt context
+//********************************************************************************************
+void WaterLevelMonitor::onPinChange()
+{
+	Edge edge;
+	edge.port = readPort();
+	edge.time = millis();
+	if (!this->edges.push(edge) && this->edgesLost != 0xFF)
+		this->edgesLost++;
+}
+
+//********************************************************************************************
+// function name: applyPort ()
+// Function Description: Restarts the debounce time of every pin whose raw level changed
+//********************************************************************************************
+void WaterLevelMonitor::applyPort(uint8_t port, unsigned long time)
+{
+	for (byte i = 0; i < WATER_LEVEL_PIN_COUNT; i++)
+	{
+		uint8_t mask = 1 << i;
+		bool raw = port & this->masks[i];
+		if (raw != (bool)(this->candidates & mask))
+		{
+			this->candidates ^= mask;
+			this->candidateTime[i] = time;
+		}
+	}
+}
+
+uint8_t WaterLevelMonitor::readPort()
+{
+#if defined(__AVR__)
+	return PINB;
+#else
+	uint8_t port = 0;
+	for (byte i = 0; i < WATER_LEVEL_PIN_COUNT; i++)
+	{
+		if (digitalRead(this->pins[i]))
+			port |= this->masks[i];
+	}
+	return port;
+#endif
+}
+
+#if defined(__AVR__)
+ISR(PCINT0_vect)
+{
+	waterLevel.onPinChange();
+#if ENABLE_SLEEP
+	idle.wake();
+#endif
+}
+#endif
@@ -0,0 +1,83 @@
+/*********************************************************************
+* WaterLevelMonitor.h
+*
+* Description: Interrupt driven water level monitoring. The float
+* switches raise a pin change interrupt, the ISR only queues the port
+* state with a millis() timestamp. update() debounces each pin and turns
+* accepted transitions into events with an epoch timestamp from the RTC,
+* which the sketch sends as WLEVT frames.
+*
+* Sensor driver pin: D8, D9 (WATER_LEVEL_PINS in config.h)
+*
+* version :  V1.0
+* date    :  2026-10-19
+**********************************************************************/
+
+#pragma once
+#include <Arduino.h>
+#include "config.h"
+#include "RingBuffer.h"
+
+struct WaterLevelEvent
+{
+	uint8_t pin;			 // index into WATER_LEVEL_PINS
+	uint8_t level;			 // debounced level after the transition
+	unsigned long time;		 // epoch seconds of the first edge of the new level
+	unsigned int transitions; // transitions of this pin since boot
+};
+
+class WaterLevelMonitor
+{
+public:
+	// counters since boot
+	unsigned long edgesDropped;	 // raw edges lost because update() fell behind
+	unsigned long eventsDropped; // debounced events lost because telemetry fell behind
+
+public:
+	WaterLevelMonitor();
+	~WaterLevelMonitor();
+
+	// configure the pins and enable the pin change interrupt
+	void setup();
+
+	// debounce the queued edges
+	void update();
+
+	// ms until update() has an edge to apply or a level to accept
+	unsigned long idleTime();
+
+	// debounced level of a pin
+	byte level(byte index);
+
+	// transitions of a pin since boot
+	unsigned int transitions(byte index);
+
+	// take the oldest debounced event
+	bool popEvent(WaterLevelEvent &event);
+
+	// called from the pin change interrupt
+	void onPinChange();
+
+private:
+	struct Edge
+	{
+		uint8_t port;		 // input register at the interrupt
+		unsigned long time; // millis()
+	};
+
+	uint8_t pins[WATER_LEVEL_PIN_COUNT];
+	uint8_t masks[WATER_LEVEL_PIN_COUNT];
+	uint8_t levels;		 // debounced level, one bit per pin index
+	uint8_t candidates;	 // last raw level, one bit per pin index
+	unsigned long candidateTime[WATER_LEVEL_PIN_COUNT];
+	unsigned int transitionCount[WATER_LEVEL_PIN_COUNT];
+	volatile uint8_t edgesLost; // edges the ISR could not queue since the last update()
+
+	RingBuffer<Edge, 8> edges;
+	RingBuffer<WaterLevelEvent, WATER_LEVEL_EVENT_QUEUE> events;
+
+	void applyPort(uint8_t port, unsigned long time);
+	uint8_t readPort();
+};
+
+extern WaterLevelMonitor waterLevel;
@@ -1 +1,244 @@
 #pragma once
+
+//********************************************************************************************
+// Board profile, the features below are sized for one of two boards
+// FULL_PROFILE : 1 for the Mega 2560 (8 KB of RAM), every feature is built: ENABLE_SD_LOG,
+//                ENABLE_STATS, ENABLE_HISTORY, ENABLE_RANGE, ENABLE_BULK, ENABLE_ROLLUPS, a
+//                256 byte telemetry queue
+//                0 for the UNO (2 KB of RAM), these features are left out and the telemetry
+//                queue holds 128 bytes, the rest of the sketch is the same. The SD library
+//                alone takes about 600 bytes, an UNO with the card and the rest of the sketch
+//                has no RAM left for the stack.
+// Defaults to the board being built for, the BOOT frame reports the RAM left free at the end
+// of setup(). A feature can still be switched on its own below.
+//********************************************************************************************
+#ifndef FULL_PROFILE
+#if defined(__AVR_ATmega2560__) || defined(__AVR_ATmega1280__)
+#define FULL_PROFILE 1
+#else
+#define FULL_PROFILE 0
+#endif
+#endif
+
+//********************************************************************************************
+// EEPROM calibration store (CalibrationStore)
+// CALIBRATION_EEPROM_BASE : first EEPROM address used by the store. The legacy layout
+//                           (pH 0x00, EC 8, TDS 16) sits below it so old values can be migrated.
+// CALIBRATION_SLOTS       : slots rotated per record for wear levelling, 1 disables rotation
+//********************************************************************************************
+#define CALIBRATION_EEPROM_BASE 0x40
+#define CALIBRATION_SLOTS 4
+
+//********************************************************************************************
+// Telemetry (serial output queue)
+// SERIAL_BAUD              : rate of the serial link
+// TELEMETRY_QUEUE_SIZE     : bytes queued ahead of the 64 byte HardwareSerial buffer, power of two,
+//                            at least TELEMETRY_REPORT_RESERVE
+// TELEMETRY_REPORT_RESERVE : worst case length of one report frame
+// REPORT_UNACKED           : report frames kept in RAM for RESEND until they are acknowledged
+//                            (ReportLog), 30 bytes each
+// REPORT_SPOOL             : report frames also kept in REPORTS.BIN on the card for RESEND, 30
+//                            bytes each, 3600 cover an hour of outage at REPORT_INTERVAL_BURST,
+//                            0 for the RAM frames only. Needs the daily logs (ENABLE_SD_LOG).
+// REPORT_COMPACT           : 1 to start with Z@ frames (SampleCodec), the COMPACT command switches
+// REPORT_INTERVAL*         : defaults of the interval table (CalibrationStore), see SET and CONFIG
+// REPORT_INTERVAL          : ms between report frames
+// REPORT_INTERVAL_BURST    : ms between report frames while a channel sees a change
+// REPORT_INTERVAL_STABLE   : ms between report frames once all channels settled
+//********************************************************************************************
+#define SERIAL_BAUD 9600
+#if FULL_PROFILE
+#define TELEMETRY_QUEUE_SIZE 256
+#else
+#define TELEMETRY_QUEUE_SIZE 128
+#endif
+#define TELEMETRY_REPORT_RESERVE 125
+#define REPORT_UNACKED 4
+#define REPORT_SPOOL 3600
+#define REPORT_COMPACT 0
+#define REPORT_INTERVAL 3000
+#define REPORT_INTERVAL_BURST 1000
+#define REPORT_INTERVAL_STABLE 10000
+
+//********************************************************************************************
+// Adaptive sampling of the analog channels (AdaptiveSampler)
+// *_SAMPLE_MIN        : ms between ADC samples while the signal changes
+// *_SAMPLE_MAX        : ms between ADC samples once the signal is stable
+// ADAPTIVE_THRESHOLD  : ADC counts a window average must move beyond the usual spread to burst
+// ADAPTIVE_HOLD       : windows the minimum interval is kept after a change
+// Setting MIN and MAX to the same value gives the old fixed rate
+// TEMP_SAMPLE_INTERVAL : ms between temperature readings
+// SD_LOG_INTERVAL      : s between SD rows
+// The intervals are defaults of the table in EEPROM, "SET name value" changes them at runtime
+//********************************************************************************************
+#define PH_SAMPLE_MIN 30
+#define PH_SAMPLE_MAX 240
+#define ORP_SAMPLE_MIN 20
+#define ORP_SAMPLE_MAX 160
+#define EC_SAMPLE_MIN 25
+#define EC_SAMPLE_MAX 200
+#define TDS_SAMPLE_MIN 40
+#define TDS_SAMPLE_MAX 320
+#define TEMP_SAMPLE_INTERVAL 850
+#define SD_LOG_INTERVAL 30
+#define ADAPTIVE_THRESHOLD 3
+#define ADAPTIVE_HOLD 8
+
+//********************************************************************************************
+// Sensor readings (ISensor::getReading)
+// SENSOR_STALE_TIME : ms after which a value without a new sample is flagged READING_STALE
+//********************************************************************************************
+#define SENSOR_STALE_TIME 5000
+
+//********************************************************************************************
+// Per-window channel statistics (RunningStats), STAT frames and extra SD columns
+// ENABLE_STATS : 1 to keep min/max/mean/stddev of the snapshot values between two reports / SD
+//                rows, the SD window only exists for csv logs (SD_COMPRESSED 0, SD_RAW_LOG 0),
+//                about 110 bytes of RAM per window
+//********************************************************************************************
+#define ENABLE_STATS FULL_PROFILE
+
+//********************************************************************************************
+// Loop profiler, dumped with the PROFILE command
+// ENABLE_PROFILER : 1 to time every loop() stage and every ISensor::update(), 0 compiles it out,
+//                   the host tests set it
+//********************************************************************************************
+#ifndef ENABLE_PROFILER
+#define ENABLE_PROFILER 0
+#endif
+
+//********************************************************************************************
+// Sleep between scheduled work (IdleManager), counters shown with the POWER command
+// ENABLE_SLEEP : 1 to idle the CPU while every task waits for a deadline, 0 busy-loops
+//********************************************************************************************
+#define ENABLE_SLEEP 1
+
+//********************************************************************************************
+// Watchdog supervised loop (Watchdog), the previous run is reported in the BOOT frame
+// ENABLE_WATCHDOG  : 1 to reset the board when a loop() task stops checking in
+// WATCHDOG_TIMEOUT : WDTO_* constant from avr/wdt.h, must cover the slowest SD card write
+//********************************************************************************************
+#define ENABLE_WATCHDOG 1
+#define WATCHDOG_TIMEOUT WDTO_4S
+
+//********************************************************************************************
+// Water level float switches (WaterLevelMonitor)
+// WATER_LEVEL_PINS         : pins watched with pin change interrupts, must be on port B (D8, D9),
+//                            D10..D13 carry the SPI bus of the SD card
+// WATER_LEVEL_DEBOUNCE     : ms a level must be stable before it is accepted
+// WATER_LEVEL_EVENT_QUEUE  : debounced transitions waiting for telemetry, power of two, 8 bytes each
+//********************************************************************************************
+#define WATER_LEVEL_PINS {8, 9}
+#define WATER_LEVEL_PIN_COUNT 2
+#define WATER_LEVEL_DEBOUNCE 50
+#define WATER_LEVEL_EVENT_QUEUE 8
+#define WATER_LEVEL_FRAME_RESERVE 32
+
+//********************************************************************************************
+// History for replay after a link outage (HistoryLog), started with "REPLAY <sequence>"
+// ENABLE_HISTORY        : 1 to keep per-minute records, 0 compiles it out (about 450 bytes of RAM)
+// HISTORY_MINUTES       : minute records kept in RAM at full resolution, 20 bytes each
+// HISTORY_BLOCKS        : older blocks kept in RAM, 20 bytes each
+// HISTORY_BLOCK_MINUTES : minutes averaged into one block
+// The RAM ring covers HISTORY_MINUTES + HISTORY_BLOCKS * HISTORY_BLOCK_MINUTES minutes without a
+// card, HISTORY.BIN keeps every minute
+//********************************************************************************************
+#define ENABLE_HISTORY FULL_PROFILE
+#define HISTORY_MINUTES 8
+#define HISTORY_BLOCKS 8
+#define HISTORY_BLOCK_MINUTES 15
+
+//********************************************************************************************
+// Sample codec (SampleCodec) for the SD log and Z@ report frames, see tools/sample_codec.py
+// CODEC_KEYFRAME_INTERVAL : records between two keyframes
+// SD_COMPRESSED           : 1 to log SampleCodec records (.BIN), 0 for csv rows (.CSV), the host
+//                           tests build both
+//********************************************************************************************
+#define CODEC_KEYFRAME_INTERVAL 32
+#ifndef SD_COMPRESSED
+#define SD_COMPRESSED 1
+#endif
+
+//********************************************************************************************
+// Daily SD logs (SdService)
+// ENABLE_SD_LOG    : 1 to log to the SD card, 0 leaves the card and the SD library out (about
+//                    750 bytes of RAM), RANGE, BULK, the rollups, the raw log and HISTORY.BIN
+//                    need it
+// SD_LOG_FILE_SIZE : bytes preallocated and erased for each log, a full log continues in the
+//                    next part of the day, erasing it must fit into WATCHDOG_TIMEOUT, the host
+//                    tests shrink it to reach the next part quickly
+// SD_LOG_PARTS     : parts per day, at most 100
+// SD_INDEX_ROWS    : csv rows per index entry, .BIN logs index every sector
+// ENABLE_RANGE     : 1 to index the logs and serve RANGE, 0 compiles both out (about 140 bytes
+//                    of RAM), not available with SD_RAW_LOG
+// SD_RANGE_SCAN    : records or logs a RANGE may skip per loop pass
+//********************************************************************************************
+#ifndef SD_LOG_FILE_SIZE
+#if SD_COMPRESSED
+#define SD_LOG_FILE_SIZE 131072UL
+#else
+#define SD_LOG_FILE_SIZE 1048576UL
+#endif
+#endif
+#define ENABLE_SD_LOG FULL_PROFILE
+#define SD_LOG_PARTS 100
+#define SD_INDEX_ROWS 120
+#define ENABLE_RANGE FULL_PROFILE
+#define SD_RANGE_SCAN 16
+
+//********************************************************************************************
+// Raw block log (RawLog), replaces the files on the card, see tools/raw_extract.py
+// SD_RAW_LOG         : 1 to log into a reserved block range without FAT, 0 for the daily logs
+// SD_RAW_FIRST_BLOCK : first block of the range, the MBR is block 0
+// SD_RAW_BLOCKS      : blocks in the range, 16 rows each, it must end before the first partition
+//                      (block 2048 with fdisk, 8192 with the SD Association formatter)
+//********************************************************************************************
+#ifndef SD_RAW_LOG
+#define SD_RAW_LOG 0
+#endif
+#define SD_RAW_FIRST_BLOCK 1
+#define SD_RAW_BLOCKS 2047
+
+//********************************************************************************************
+// Bulk download of SD files (BulkTransfer), see tools/bulk_download.py
+// ENABLE_BULK  : 1 to serve BULK, 0 compiles it out (about 85 bytes of RAM), not available with
+//                SD_RAW_LOG
+// BULK_BAUD    : rate while a download runs, 250000 and 500000 are exact on a 16 MHz UNO
+// BULK_BLOCK   : bytes per BLK frame, the frame must fit into TELEMETRY_QUEUE_SIZE
+// BULK_WINDOW  : blocks sent ahead of the acknowledged offset
+// BULK_NAKS    : BNAK requests kept, more are recovered by BULK_RETRY
+// BULK_RETRY   : ms without progress before the window is sent again
+// BULK_TIMEOUT : ms without a command from the receiver before the link goes back to SERIAL_BAUD
+//********************************************************************************************
+#define ENABLE_BULK FULL_PROFILE
+#define BULK_BAUD 115200
+#define BULK_BLOCK 64
+#define BULK_WINDOW 8
+#define BULK_NAKS 4
+#define BULK_RETRY 1000
+#define BULK_TIMEOUT 5000
+
+//********************************************************************************************
+// Rollups on the SD card (RollupLog), see tools/rollup_dump.py
+// ENABLE_ROLLUPS : 1 to keep min/max/mean/count per minute, 15 minutes and hour, 0 to disable
+//                  (about 90 bytes of RAM)
+//********************************************************************************************
+#define ENABLE_ROLLUPS FULL_PROFILE
+
+//********************************************************************************************
+// Features that need the files on the card
+//********************************************************************************************
+#if !ENABLE_SD_LOG
+#undef SD_RAW_LOG
+#define SD_RAW_LOG 0
+#undef ENABLE_ROLLUPS
+#define ENABLE_ROLLUPS 0
+#endif
+#if !ENABLE_SD_LOG || SD_RAW_LOG
+#undef REPORT_SPOOL
+#define REPORT_SPOOL 0
+#undef ENABLE_RANGE
+#define ENABLE_RANGE 0
+#undef ENABLE_BULK
+#define ENABLE_BULK 0
+#endif
@@ -40,34 +40,106 @@
    date    :  2017-04-06
  **********************************************************************/
 
+#include "config.h"
 #include <SPI.h>
+#if ENABLE_SD_LOG
 #include <SD.h>
+#endif
 #include <Wire.h>
 #include "GravitySensorHub.h"
 #include "GravityRtc.h"
 #include "OneWire.h"
 #include "SdService.h"
+#include "CalibrationStore.h"
+#include "Telemetry.h"
+#include "Profiler.h"
+#include "WaterLevelMonitor.h"
+#include "IdleManager.h"
+#include "Watchdog.h"
+#include "HistoryLog.h"
+#include "ReportLog.h"
+#include "BulkTransfer.h"
+#include "RollupLog.h"
 #include "Debug.h"
-#include <SoftwareSerial.h>
 
 // clock module
 GravityRtc rtc;
 
+// calibration values kept in EEPROM
+CalibrationStore calibrationStore;
+
+// serial output queue
+Telemetry telemetry;
+
+// numbered report frames kept until acknowledged, see the ACK and RESEND commands
+ReportLog reportLog;
+
+#if ENABLE_PROFILER
+// loop stage timing, see the PROFILE command
+Profiler profiler;
+#endif
+
+#if ENABLE_SLEEP
+// sleep between scheduled work, see the POWER command
+IdleManager idle;
+#endif
+
+#if ENABLE_WATCHDOG
+// resets a hung loop, reports the previous run at boot
+Watchdog watchdog;
+#endif
+
 // sensor monitor
 GravitySensorHub sensorHub;
-SdService sdService = SdService(sensorHub.sensors);
-int WATER_LEVEL_PIN1 = 8;  //Digital pin 8
-int WATER_LEVEL_PIN2 = 9;  //Digital pin 9
-int WATER_LEVEL_PIN3 = 10; //Digital pin 9
+#if ENABLE_SD_LOG
+SdService sdService = SdService(&sensorHub);
+#endif
+
+#if ENABLE_HISTORY
+// per-minute history, see the REPLAY command
+HistoryLog history(&sensorHub);
+#endif
+
+#if ENABLE_ROLLUPS
+// minute, 15 minute and hour summaries on the card
+RollupLog rollupLog(&sensorHub);
+#endif
+
+#if ENABLE_BULK
+// file download at BULK_BAUD, see the BULK command
+BulkTransfer bulkTransfer;
+#endif
+
+// water level float switches, pins in config.h
+WaterLevelMonitor waterLevel;
+
 void setup()
 {
-  Serial.begin(9600);
-  pinMode(WATER_LEVEL_PIN1, INPUT);
-  pinMode(WATER_LEVEL_PIN2, INPUT);
-  pinMode(WATER_LEVEL_PIN3, INPUT);
+  Serial.begin(SERIAL_BAUD);
+  waterLevel.setup();
   rtc.setup();
+  calibrationStore.setup();
   sensorHub.setup();
+#if ENABLE_SD_LOG
   sdService.setup();
+#endif
+#if ENABLE_HISTORY && ENABLE_SD_LOG
+  history.setup(sdService.directory());
+#elif ENABLE_HISTORY
+  history.setup(NULL);
+#endif
+#if ENABLE_BULK
+  bulkTransfer.setup(sdService.directory());
+#endif
+#if ENABLE_ROLLUPS
+  rollupLog.setup(sdService.directory());
+#endif
+#if REPORT_SPOOL
+  reportLog.setup(sdService.directory());
+#endif
+#if ENABLE_WATCHDOG
+  watchdog.setup();
+#endif
 }
 
 //********************************************************************************************
@@ -82,33 +154,183 @@ void setup()
 //********************************************************************************************
 
 unsigned long updateTime = 0;
+bool reportPending = false;
+#if ENABLE_STATS
+byte statChannel = SNAPSHOT_CHANNELS; // next STAT frame to send after a report
+#endif
+
+//********************************************************************************************
+// function name: reportInterval ()
+// Function Description: Reports follow the sampling activity, faster while a channel sees a
+// change and slower once all of them settled
+//********************************************************************************************
+unsigned long reportInterval()
+{
+  switch (sensorHub.samplingState())
+  {
+  case SAMPLING_BURST:
+    return calibrationStore.intervals.value[INTERVAL_REPORT_BURST];
+  case SAMPLING_STABLE:
+    return calibrationStore.intervals.value[INTERVAL_REPORT_STABLE];
+  default:
+    return calibrationStore.intervals.value[INTERVAL_REPORT];
+  }
+}
+
+#if ENABLE_SLEEP
+//********************************************************************************************
+// function name: idleTime ()
+// Function Description: Returns the ms until the first task has work to do again
+//********************************************************************************************
+unsigned long idleTime()
+{
+  if (reportPending)
+    return 0;
+#if ENABLE_STATS
+  if (statChannel < SNAPSHOT_CHANNELS)
+    return 0;
+#endif
+#if ENABLE_PROFILER
+  if (profiler.reporting())
+    return 0;
+#endif
+  if (reportLog.resending())
+    return 0;
+#if ENABLE_BULK
+  if (bulkTransfer.active())
+    return 0;
+#endif
+#if ENABLE_HISTORY
+  if (history.replaying())
+    return 0;
+#endif
+  unsigned long taskIdle[] = {
+      timeUntil(updateTime, reportInterval() + 1),
+      rtc.idleTime(),
+      sensorHub.idleTime(),
+      waterLevel.idleTime(),
+#if ENABLE_SD_LOG
+      sdService.idleTime(),
+#endif
+      telemetry.idleTime()};
+#if ENABLE_WATCHDOG
+  unsigned long shortest = WATCHDOG_IDLE_LIMIT;
+#else
+  unsigned long shortest = IDLE_FOREVER;
+#endif
+  for (byte i = 0; i < sizeof(taskIdle) / sizeof(taskIdle[0]); i++)
+  {
+    if (taskIdle[i] < shortest)
+      shortest = taskIdle[i];
+  }
+  return shortest;
+}
+#endif
 
 void loop()
 {
+  PROFILE_BEGIN(PROFILE_LOOP);
+  PROFILE_BEGIN(PROFILE_RTC);
+  WATCHDOG_ENTER(TASK_RTC);
   rtc.update();
+  WATCHDOG_CHECKIN(TASK_RTC);
+  PROFILE_END(PROFILE_RTC);
+
+  PROFILE_BEGIN(PROFILE_SENSORS);
+  WATCHDOG_ENTER(TASK_SENSORS);
   sensorHub.update();
+  WATCHDOG_CHECKIN(TASK_SENSORS);
+  WATCHDOG_ENTER(TASK_WATER_LEVEL);
+  waterLevel.update();
+  WATCHDOG_CHECKIN(TASK_WATER_LEVEL);
+  PROFILE_END(PROFILE_SENSORS);
+
+  PROFILE_BEGIN(PROFILE_SD);
+  WATCHDOG_ENTER(TASK_SD);
+#if ENABLE_SD_LOG
   sdService.update();
+#endif
+#if ENABLE_ROLLUPS
+  rollupLog.update();
+#endif
+  WATCHDOG_CHECKIN(TASK_SD);
+  PROFILE_END(PROFILE_SD);
 
   // ************************* Serial debugging ******************
-  if (millis() - updateTime > 3000)
+  if (millis() - updateTime > reportInterval())
   {
     updateTime = millis();
-    Serial.print(F("PH@"));
-    Serial.print(sensorHub.getValueBySensorNumber(0));
-    Serial.print(F("#TEMP@"));
-    Serial.print(sensorHub.getValueBySensorNumber(1));
-    Serial.print(F("#TDS@"));
-    Serial.print(sensorHub.getValueBySensorNumber(2));
-    Serial.print(F("#EC@"));
-    Serial.print(sensorHub.getValueBySensorNumber(3));
-    Serial.print(F("#ORP@"));
-    Serial.print(sensorHub.getValueBySensorNumber(4));
-    Serial.print(F("#WLVL1@"));
-    Serial.print(digitalRead(WATER_LEVEL_PIN1));
-    Serial.print(F("#WLVL2@"));
-    Serial.println(digitalRead(WATER_LEVEL_PIN2));
+    if (reportPending)
+      telemetry.coalesceFrame(); // the previous report never fitted, send this one instead
+    reportPending = true;
+  }
+  WATCHDOG_ENTER(TASK_REPORT);
+  if (reportPending && telemetry.beginFrame(TELEMETRY_REPORT_RESERVE))
+  {
+    PROFILE_BEGIN(PROFILE_REPORT);
+    reportPending = false;
+    reportLog.send(sensorHub.snapshot());
+#if ENABLE_STATS
+    statChannel = 0;
+#endif
+    PROFILE_END(PROFILE_REPORT);
+  }
+
+  // frames asked for again with RESEND
+  reportLog.update();
+
+#if ENABLE_BULK
+  // blocks of a BULK download
+  bulkTransfer.update();
+#endif
+
+#if ENABLE_STATS
+  // statistics of the values behind the report, one STAT frame per channel
+  while (statChannel < SNAPSHOT_CHANNELS && telemetry.beginFrame(STATS_FRAME_RESERVE))
+  {
+    sensorHub.printStats(STATS_REPORT, statChannel++);
+  }
+#endif
+
+  // water level transitions go out as soon as they are debounced
+  // WLEVT@pin,level,epoch,transitions
+  WaterLevelEvent event;
+  while (telemetry.beginFrame(WATER_LEVEL_FRAME_RESERVE) && waterLevel.popEvent(event))
+  {
+    telemetry.print(F("WLEVT@"));
+    telemetry.print(event.pin + 1);
+    telemetry.print(',');
+    telemetry.print(event.level);
+    telemetry.print(',');
+    telemetry.print(event.time);
+    telemetry.print(',');
+    telemetry.println(event.transitions);
   }
+
+#if ENABLE_HISTORY
+  // minute records, and one HIST frame per pass while a replay runs
+  history.update();
+#endif
+  WATCHDOG_CHECKIN(TASK_REPORT);
+
+  PROFILE_BEGIN(PROFILE_CALIBRATE);
+  WATCHDOG_ENTER(TASK_CALIBRATE);
   sensorHub.calibrate();
+  WATCHDOG_CHECKIN(TASK_CALIBRATE);
+  PROFILE_END(PROFILE_CALIBRATE);
+
+  WATCHDOG_ENTER(TASK_TELEMETRY);
+#if ENABLE_PROFILER
+  profiler.update();
+#endif
+  telemetry.update();
+  WATCHDOG_CHECKIN(TASK_TELEMETRY);
+  PROFILE_END(PROFILE_LOOP);
+
+#if ENABLE_SLEEP
+  WATCHDOG_ENTER(TASK_SLEEP);
+  idle.sleep(idleTime());
+#endif
 }
 
 //* ***************************** Print the relevant debugging information ************** ************ * /
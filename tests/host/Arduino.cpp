@@ -0,0 +1,341 @@
+/*********************************************************************
+* Arduino.cpp
+*
+* Description: Host stand-in for the Arduino core, see Arduino.h. The
+* number formatting follows Print.cpp and WString.cpp of the AVR core.
+*
+* version :  V1.0
+* date    :  2026-10-19
+**********************************************************************/
+
+#include "Arduino.h"
+#include "EEPROM.h"
+#include "Wire.h"
+#include <stdio.h>
+
+unsigned long hostMicros = 0;
+unsigned long hostMicrosPerCall = 0;
+HardwareSerial Serial;
+TwoWire Wire;
+EEPROMClass EEPROM;
+
+unsigned long micros()
+{
+	unsigned long now = hostMicros;
+	hostMicros += hostMicrosPerCall;
+	return now;
+}
+
+unsigned long millis()
+{
+	return micros() / 1000;
+}
+
+void delay(unsigned long ms)
+{
+	hostMicros += ms * 1000;
+}
+
+void delayMicroseconds(unsigned int us)
+{
+	hostMicros += us;
+}
+
+void pinMode(uint8_t, uint8_t) {}
+
+int digitalRead(uint8_t)
+{
+	return HIGH;
+}
+
+void digitalWrite(uint8_t, uint8_t) {}
+
+int analogRead(uint8_t)
+{
+	return 0;
+}
+
+void noInterrupts() {}
+
+void interrupts() {}
+
+// digits of value in base, most significant first
+static std::string formatNumber(unsigned long value, int base)
+{
+	if (base < 2)
+		base = 10;
+	char digits[8 * sizeof(long) + 1];
+	char *end = &digits[sizeof(digits) - 1];
+	*end = '\0';
+	do
+	{
+		unsigned long digit = value % base;
+		*--end = digit < 10 ? '0' + digit : 'A' + digit - 10;
+		value /= base;
+	} while (value);
+	return end;
+}
+
+static std::string formatSigned(long value, int base)
+{
+	if (base == DEC && value < 0)
+		return "-" + formatNumber(-(unsigned long)value, base);
+	return formatNumber(value, base);
+}
+
+// Print::printFloat(), nan, inf and ovf instead of digits
+static std::string formatFloat(double value, int digits)
+{
+	if (isnan(value))
+		return "nan";
+	if (isinf(value))
+		return "inf";
+	if (value > 4294967040.0 || value < -4294967040.0)
+		return "ovf";
+	char text[48];
+	snprintf(text, sizeof(text), "%.*f", digits, value);
+	return text;
+}
+
+//********************************************************************************************
+// String
+//********************************************************************************************
+String::String(const char *text) : text(text ? text : "") {}
+
+String::String(const __FlashStringHelper *text) : text(reinterpret_cast<const char *>(text)) {}
+
+String::String(char c) : text(1, c) {}
+
+String::String(unsigned char value, unsigned char base) : text(formatNumber(value, base)) {}
+
+String::String(int value, unsigned char base) : text(formatSigned(value, base)) {}
+
+String::String(unsigned int value, unsigned char base) : text(formatNumber(value, base)) {}
+
+String::String(long value, unsigned char base) : text(formatSigned(value, base)) {}
+
+String::String(unsigned long value, unsigned char base) : text(formatNumber(value, base)) {}
+
+String::String(double value, unsigned char decimalPlaces)
+{
+	// dtostrf() with a width of decimalPlaces + 2
+	char buffer[48];
+	snprintf(buffer, sizeof(buffer), "%*.*f", decimalPlaces + 2, decimalPlaces, value);
+	this->text = buffer;
+}
+
+String &String::operator+=(const String &other)
+{
+	this->text += other.text;
+	return *this;
+}
+
+String &String::operator+=(const char *text)
+{
+	this->text += text;
+	return *this;
+}
+
+String &String::operator+=(char c)
+{
+	this->text += c;
+	return *this;
+}
+
+bool String::operator==(const char *text) const
+{
+	return this->text == text;
+}
+
+char String::operator[](unsigned int index) const
+{
+	return index < this->text.size() ? this->text[index] : '\0';
+}
+
+unsigned int String::length() const
+{
+	return this->text.size();
+}
+
+const char *String::c_str() const
+{
+	return this->text.c_str();
+}
+
+void String::reserve(unsigned int size)
+{
+	this->text.reserve(size);
+}
+
+float String::toFloat() const
+{
+	return atof(this->text.c_str());
+}
+
+//********************************************************************************************
+// Print
+//********************************************************************************************
+size_t Print::write(const uint8_t *buffer, size_t size)
+{
+	size_t written = 0;
+	while (size--)
+	{
+		if (!write(*buffer++))
+			break;
+		written++;
+	}
+	return written;
+}
+
+size_t Print::write(const char *text)
+{
+	return text ? write((const uint8_t *)text, strlen(text)) : 0;
+}
+
+size_t Print::print(const __FlashStringHelper *text)
+{
+	return write(reinterpret_cast<const char *>(text));
+}
+
+size_t Print::print(const String &text)
+{
+	return write(text.c_str(), text.length());
+}
+
+size_t Print::print(const char *text)
+{
+	return write(text);
+}
+
+size_t Print::print(char c)
+{
+	return write((uint8_t)c);
+}
+
+size_t Print::print(unsigned char value, int base)
+{
+	return print((unsigned long)value, base);
+}
+
+size_t Print::print(int value, int base)
+{
+	return print((long)value, base);
+}
+
+size_t Print::print(unsigned int value, int base)
+{
+	return print((unsigned long)value, base);
+}
+
+size_t Print::print(long value, int base)
+{
+	return write(formatSigned(value, base).c_str());
+}
+
+size_t Print::print(unsigned long value, int base)
+{
+	return write(formatNumber(value, base).c_str());
+}
+
+size_t Print::print(double value, int digits)
+{
+	return write(formatFloat(value, digits).c_str());
+}
+
+size_t Print::println()
+{
+	return write("\r\n");
+}
+
+size_t Print::println(const __FlashStringHelper *text)
+{
+	size_t n = print(text);
+	return n + println();
+}
+
+size_t Print::println(const String &text)
+{
+	size_t n = print(text);
+	return n + println();
+}
+
+size_t Print::println(const char *text)
+{
+	size_t n = print(text);
+	return n + println();
+}
+
+size_t Print::println(char c)
+{
+	size_t n = print(c);
+	return n + println();
+}
+
+size_t Print::println(unsigned char value, int base)
+{
+	size_t n = print(value, base);
+	return n + println();
+}
+
+size_t Print::println(int value, int base)
+{
+	size_t n = print(value, base);
+	return n + println();
+}
+
+size_t Print::println(unsigned int value, int base)
+{
+	size_t n = print(value, base);
+	return n + println();
+}
+
+size_t Print::println(long value, int base)
+{
+	size_t n = print(value, base);
+	return n + println();
+}
+
+size_t Print::println(unsigned long value, int base)
+{
+	size_t n = print(value, base);
+	return n + println();
+}
+
+size_t Print::println(double value, int digits)
+{
+	size_t n = print(value, digits);
+	return n + println();
+}
+
+//********************************************************************************************
+// HardwareSerial
+//********************************************************************************************
+int HardwareSerial::available()
+{
+	if (!this->pending.empty() && hostMicros >= this->pendingAt)
+	{
+		this->input += this->pending;
+		this->pending.clear();
+	}
+	return this->input.size();
+}
+
+int HardwareSerial::read()
+{
+	if (available() == 0)
+		return -1;
+	int c = (uint8_t)this->input[0];
+	this->input.erase(0, 1);
+	return c;
+}
+
+int HardwareSerial::peek()
+{
+	return available() == 0 ? -1 : (uint8_t)this->input[0];
+}
+
+size_t HardwareSerial::write(uint8_t data)
+{
+	this->output += (char)data;
+	return 1;
+}
@@ -0,0 +1,168 @@
+/*********************************************************************
+* Arduino.h
+*
+* Description: Host stand-in for the Arduino core, just enough for the
+* parts of the sketch that the tests build on a PC. Program memory is
+* ordinary memory, the clock is simulated (hostMicros) and Serial keeps
+* what was written in a string.
+*
+* version :  V1.0
+* date    :  2026-10-19
+**********************************************************************/
+
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define PROGMEM
+#define PSTR(s) (s)
+#define F(s) (reinterpret_cast<const __FlashStringHelper *>(s))
+#define pgm_read_byte(address) (*(const uint8_t *)(address))
+#define pgm_read_word(address) (*(const uint16_t *)(address))
+#define pgm_read_dword(address) (*(const uint32_t *)(address))
+#define pgm_read_float(address) (*(const float *)(address))
+#define memcpy_P memcpy
+#define strcmp_P strcmp
+#define strncmp_P strncmp
+#define strcpy_P strcpy
+#define strlen_P strlen
+#define strstr_P strstr
+class __FlashStringHelper;
+
+#define LOW 0
+#define HIGH 1
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+#define SS 10
+
+//********************************************************************************************
+// Simulated clock. micros() returns hostMicros, millis() hostMicros / 1000, and every call of
+// either advances the clock by hostMicrosPerCall so polling loops see time pass.
+//********************************************************************************************
+extern unsigned long hostMicros;
+extern unsigned long hostMicrosPerCall;
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t value);
+int analogRead(uint8_t pin);
+void noInterrupts();
+void interrupts();
+
+class String
+{
+public:
+	String(const char *text = "");
+	String(const __FlashStringHelper *text);
+	String(char c);
+	String(unsigned char value, unsigned char base = DEC);
+	String(int value, unsigned char base = DEC);
+	String(unsigned int value, unsigned char base = DEC);
+	String(long value, unsigned char base = DEC);
+	String(unsigned long value, unsigned char base = DEC);
+	String(double value, unsigned char decimalPlaces = 2);
+
+	String &operator+=(const String &other);
+	String &operator+=(const char *text);
+	String &operator+=(char c);
+	bool operator==(const char *text) const;
+	char operator[](unsigned int index) const;
+
+	unsigned int length() const;
+	const char *c_str() const;
+	void reserve(unsigned int size);
+	float toFloat() const;
+
+private:
+	std::string text;
+};
+
+class Print
+{
+public:
+	virtual ~Print() {}
+	virtual size_t write(uint8_t data) = 0;
+	virtual size_t write(const uint8_t *buffer, size_t size);
+	size_t write(const char *text);
+	size_t write(const char *buffer, size_t size) { return write((const uint8_t *)buffer, size); }
+	virtual int availableForWrite() { return 0; }
+	virtual void flush() {}
+
+	size_t print(const __FlashStringHelper *text);
+	size_t print(const String &text);
+	size_t print(const char *text);
+	size_t print(char c);
+	size_t print(unsigned char value, int base = DEC);
+	size_t print(int value, int base = DEC);
+	size_t print(unsigned int value, int base = DEC);
+	size_t print(long value, int base = DEC);
+	size_t print(unsigned long value, int base = DEC);
+	size_t print(double value, int digits = 2);
+
+	size_t println(const __FlashStringHelper *text);
+	size_t println(const String &text);
+	size_t println(const char *text);
+	size_t println(char c);
+	size_t println(unsigned char value, int base = DEC);
+	size_t println(int value, int base = DEC);
+	size_t println(unsigned int value, int base = DEC);
+	size_t println(long value, int base = DEC);
+	size_t println(unsigned long value, int base = DEC);
+	size_t println(double value, int digits = 2);
+	size_t println();
+};
+
+class Stream : public Print
+{
+public:
+	virtual int available() = 0;
+	virtual int read() = 0;
+	virtual int peek() = 0;
+};
+
+//********************************************************************************************
+// Serial port. write() appends to output, read() takes from input and availableForWrite()
+// reports txRoom, the free space of the 64 byte TX buffer on the board. pending arrives in
+// input once the clock reaches pendingAt.
+//********************************************************************************************
+class HardwareSerial : public Stream
+{
+public:
+	std::string output;
+	std::string input;
+	std::string pending;
+	unsigned long pendingAt;
+	int txRoom;
+	unsigned long baud;
+
+public:
+	HardwareSerial() : pendingAt(0), txRoom(64), baud(0) {}
+	void begin(unsigned long rate) { this->baud = rate; }
+	void end() {}
+	int available();
+	int read();
+	int peek();
+	size_t write(uint8_t data);
+	using Print::write;
+	int availableForWrite() { return this->txRoom; }
+	void flush() {}
+	operator bool() { return true; }
+};
+
+extern HardwareSerial Serial;
@@ -0,0 +1,29 @@
+/*********************************************************************
+* EEPROM.h
+*
+* Description: Host stand-in for the EEPROM library, 1 KB like the
+* ATmega328P, erased cells read as 0xFF
+*
+* version :  V1.0
+* date    :  2026-10-19
+**********************************************************************/
+
+#pragma once
+#include <Arduino.h>
+
+#define HOST_EEPROM_SIZE 1024
+
+class EEPROMClass
+{
+public:
+	uint8_t cells[HOST_EEPROM_SIZE];
+
+public:
+	EEPROMClass() { memset(this->cells, 0xFF, sizeof(this->cells)); }
+	uint8_t read(int address) { return this->cells[address % HOST_EEPROM_SIZE]; }
+	void write(int address, uint8_t value) { this->cells[address % HOST_EEPROM_SIZE] = value; }
+	void update(int address, uint8_t value) { write(address, value); }
+	uint16_t length() { return HOST_EEPROM_SIZE; }
+};
+
+extern EEPROMClass EEPROM;
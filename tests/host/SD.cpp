@@ -0,0 +1,307 @@
+/*********************************************************************
+* SD.cpp
+*
+* Description: Host stand-in for the SD library, see SD.h
+*
+* version :  V1.0
+* date    :  2026-10-19
+**********************************************************************/
+
+#include "SD.h"
+
+HostCard hostCard;
+
+void HostCard::clear()
+{
+	this->present = true;
+	this->eraseWorks = true;
+	this->erasedByte = 0xFF;
+	this->blockCount = 4194304UL; // 2 GB
+	this->blocks.clear();
+	this->files.clear();
+	this->nextBlock = 65536UL;
+}
+
+unsigned long HostCard::entries(const std::string &directory) const
+{
+	unsigned long count = 0;
+	for (std::map<std::string, HostFile>::const_iterator i = this->files.begin(); i != this->files.end(); ++i)
+	{
+		size_t slash = i->first.rfind('/');
+		if ((slash == std::string::npos ? std::string() : i->first.substr(0, slash)) == directory)
+			count++;
+	}
+	return count;
+}
+
+//********************************************************************************************
+// Sd2Card
+//********************************************************************************************
+uint8_t Sd2Card::init(uint8_t, uint8_t)
+{
+	return hostCard.present;
+}
+
+uint32_t Sd2Card::cardSize()
+{
+	return hostCard.present ? hostCard.blockCount : 0;
+}
+
+uint8_t Sd2Card::readBlock(uint32_t block, uint8_t *dst)
+{
+	if (!hostCard.present || block >= hostCard.blockCount)
+		return false;
+	std::map<uint32_t, std::vector<uint8_t> >::const_iterator i = hostCard.blocks.find(block);
+	if (i == hostCard.blocks.end())
+		memset(dst, hostCard.erasedByte, HOST_BLOCK_SIZE);
+	else
+		memcpy(dst, &i->second[0], HOST_BLOCK_SIZE);
+	return true;
+}
+
+uint8_t Sd2Card::writeBlock(uint32_t blockNumber, const uint8_t *src)
+{
+	if (!hostCard.present || blockNumber >= hostCard.blockCount)
+		return false;
+	hostCard.blocks[blockNumber].assign(src, src + HOST_BLOCK_SIZE);
+	return true;
+}
+
+// erases raw blocks and the part of any contiguous file that lies in the range
+uint8_t Sd2Card::erase(uint32_t firstBlock, uint32_t lastBlock)
+{
+	if (!hostCard.present || !hostCard.eraseWorks || lastBlock < firstBlock)
+		return false;
+	for (uint32_t block = firstBlock; block <= lastBlock; block++)
+		hostCard.blocks.erase(block);
+	for (std::map<std::string, HostFile>::iterator i = hostCard.files.begin(); i != hostCard.files.end(); ++i)
+	{
+		HostFile &file = i->second;
+		if (file.firstBlock == 0)
+			continue;
+		for (uint32_t block = file.firstBlock; block < file.firstBlock + file.blocks; block++)
+		{
+			size_t offset = (size_t)(block - file.firstBlock) * HOST_BLOCK_SIZE;
+			if (block < firstBlock || block > lastBlock || offset >= file.data.size())
+				continue;
+			size_t end = offset + HOST_BLOCK_SIZE < file.data.size() ? offset + HOST_BLOCK_SIZE : file.data.size();
+			memset(&file.data[offset], hostCard.erasedByte, end - offset);
+		}
+	}
+	return true;
+}
+
+uint8_t SdVolume::init(Sd2Card *)
+{
+	return hostCard.present;
+}
+
+//********************************************************************************************
+// SdFile
+//********************************************************************************************
+SdFile::SdFile() : position(0), flags(0), opened(false) {}
+
+HostFile *SdFile::file() const
+{
+	if (!this->opened || !hostCard.present)
+		return NULL; // a pulled card fails every access
+	std::map<std::string, HostFile>::iterator i = hostCard.files.find(this->path);
+	return i == hostCard.files.end() ? NULL : &i->second;
+}
+
+std::string SdFile::child(const char *name) const
+{
+	return this->path.empty() ? std::string(name) : this->path + "/" + name;
+}
+
+uint8_t SdFile::openRoot(SdVolume *)
+{
+	if (this->opened || !hostCard.present)
+		return false;
+	this->path = "";
+	this->position = 0;
+	this->flags = O_READ;
+	this->opened = true;
+	return true;
+}
+
+uint8_t SdFile::open(SdFile *dirFile, const char *fileName, uint8_t oflag)
+{
+	// like SdFat, an open handle has to be closed first
+	if (this->opened || dirFile == NULL || !dirFile->opened || !hostCard.present)
+		return false;
+	std::string name = dirFile->child(fileName);
+	std::map<std::string, HostFile>::iterator i = hostCard.files.find(name);
+	if (i == hostCard.files.end())
+	{
+		if (!(oflag & O_CREAT) || !(oflag & O_WRITE))
+			return false;
+		HostFile created;
+		created.directory = false;
+		created.firstBlock = 0;
+		created.blocks = 0;
+		i = hostCard.files.insert(std::make_pair(name, created)).first;
+	}
+	else if ((oflag & O_EXCL) && (oflag & O_CREAT))
+	{
+		return false;
+	}
+	if (i->second.directory && (oflag & O_WRITE))
+		return false;
+	if (oflag & O_TRUNC)
+	{
+		i->second.data.clear();
+		i->second.firstBlock = 0;
+	}
+	this->path = name;
+	this->position = 0;
+	this->flags = oflag;
+	this->opened = true;
+	return true;
+}
+
+uint8_t SdFile::makeDir(SdFile *dir, const char *dirName)
+{
+	if (this->opened || dir == NULL || !dir->opened || !hostCard.present)
+		return false;
+	std::string name = dir->child(dirName);
+	if (hostCard.files.count(name))
+		return false;
+	HostFile &created = hostCard.files[name];
+	created.directory = true;
+	created.firstBlock = 0;
+	created.blocks = 0;
+	this->path = name;
+	this->position = 0;
+	this->flags = O_READ;
+	this->opened = true;
+	return true;
+}
+
+uint8_t SdFile::createContiguous(SdFile *dirFile, const char *fileName, uint32_t size)
+{
+	if (size == 0 || !open(dirFile, fileName, O_CREAT | O_EXCL | O_RDWR))
+		return false;
+	HostFile *created = file();
+	created->data.assign(size, HOST_STALE_BYTE);
+	created->blocks = (size + HOST_BLOCK_SIZE - 1) / HOST_BLOCK_SIZE;
+	created->firstBlock = hostCard.nextBlock;
+	hostCard.nextBlock += created->blocks;
+	return true;
+}
+
+uint8_t SdFile::contiguousRange(uint32_t *bgnBlock, uint32_t *endBlock)
+{
+	HostFile *current = file();
+	if (current == NULL || current->firstBlock == 0 || current->data.empty())
+		return false;
+	*bgnBlock = current->firstBlock;
+	*endBlock = current->firstBlock + (current->data.size() + HOST_BLOCK_SIZE - 1) / HOST_BLOCK_SIZE - 1;
+	return true;
+}
+
+uint8_t SdFile::close()
+{
+	this->opened = false;
+	return true;
+}
+
+uint8_t SdFile::sync()
+{
+	return file() != NULL;
+}
+
+uint8_t SdFile::isOpen() const
+{
+	return this->opened;
+}
+
+uint8_t SdFile::isDir() const
+{
+	HostFile *current = file();
+	return this->opened && (this->path.empty() || (current != NULL && current->directory));
+}
+
+uint32_t SdFile::fileSize() const
+{
+	HostFile *current = file();
+	return current ? current->data.size() : 0;
+}
+
+uint32_t SdFile::curPosition() const
+{
+	return this->position;
+}
+
+uint8_t SdFile::seekSet(uint32_t pos)
+{
+	HostFile *current = file();
+	if (current == NULL || pos > current->data.size())
+		return false;
+	this->position = pos;
+	return true;
+}
+
+uint8_t SdFile::truncate(uint32_t size)
+{
+	HostFile *current = file();
+	if (current == NULL || !(this->flags & O_WRITE) || size > current->data.size())
+		return false;
+	current->data.resize(size);
+	if (this->position > size)
+		this->position = size;
+	return true;
+}
+
+int16_t SdFile::read()
+{
+	HostFile *current = file();
+	if (current == NULL || current->directory || this->position >= current->data.size())
+		return -1;
+	return current->data[this->position++];
+}
+
+int16_t SdFile::read(void *buf, uint16_t nbyte)
+{
+	HostFile *current = file();
+	if (current == NULL || current->directory)
+		return -1;
+	uint16_t count = 0;
+	while (count < nbyte && this->position < current->data.size())
+		((uint8_t *)buf)[count++] = current->data[this->position++];
+	return count;
+}
+
+size_t SdFile::write(uint8_t b)
+{
+	return write(&b, 1);
+}
+
+size_t SdFile::write(const void *buf, uint16_t nbyte)
+{
+	HostFile *current = file();
+	if (current == NULL || current->directory || !(this->flags & O_WRITE))
+		return 0;
+	if (this->flags & O_APPEND)
+		this->position = current->data.size();
+	const uint8_t *bytes = (const uint8_t *)buf;
+	for (uint16_t i = 0; i < nbyte; i++)
+	{
+		if (this->position < current->data.size())
+		{
+			current->data[this->position] = bytes[i];
+		}
+		else
+		{
+			current->data.push_back(bytes[i]);
+			current->firstBlock = 0; // grown past its extent, no longer contiguous
+		}
+		this->position++;
+	}
+	return nbyte;
+}
+
+size_t SdFile::write(const char *str)
+{
+	return write(str, strlen(str));
+}
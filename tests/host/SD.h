@@ -0,0 +1,119 @@
+/*********************************************************************
+* SD.h
+*
+* Description: Host stand-in for the SD library bundled with the
+* Arduino IDE: Sd2Card, SdVolume and SdFile of its utility/SdFat.h with
+* the same signatures. The card lives in memory (hostCard): raw blocks
+* for Sd2Card and a tree of files for SdFile, the FAT itself is not
+* modelled. createContiguous() leaves stale bytes in a new file like a
+* real card, only erase() clears them.
+*
+* version :  V1.0
+* date    :  2026-10-19
+**********************************************************************/
+
+#pragma once
+#include <Arduino.h>
+#include <map>
+#include <string>
+#include <vector>
+
+#define SPI_FULL_SPEED 0
+#define SPI_HALF_SPEED 1
+#define SPI_QUARTER_SPEED 2
+
+#define O_READ 0x01
+#define O_RDONLY O_READ
+#define O_WRITE 0x02
+#define O_WRONLY O_WRITE
+#define O_RDWR (O_READ | O_WRITE)
+#define O_ACCMODE (O_READ | O_WRITE)
+#define O_APPEND 0x04
+#define O_SYNC 0x08
+#define O_CREAT 0x10
+#define O_EXCL 0x20
+#define O_TRUNC 0x40
+
+#define HOST_BLOCK_SIZE 512
+#define HOST_STALE_BYTE 0x5A // content of the clusters of a new contiguous file
+
+struct HostFile
+{
+	std::vector<uint8_t> data;
+	bool directory;
+	uint32_t firstBlock; // first block of a contiguous file, 0 for one that grew by writes
+	uint32_t blocks;	 // blocks of the contiguous extent
+};
+
+//********************************************************************************************
+// The card in the slot. Tests fill or damage it directly and keep it across the resets they
+// simulate by constructing the service under test again.
+//********************************************************************************************
+struct HostCard
+{
+	bool present;
+	bool eraseWorks;	// erase() is supported by the card
+	uint8_t erasedByte; // 0x00 or 0xFF after erase(), depends on the card
+	uint32_t blockCount;
+	std::map<uint32_t, std::vector<uint8_t> > blocks; // raw blocks, unwritten ones read as erasedByte
+	std::map<std::string, HostFile> files;			  // by path, "2610/26101900.BIN", root entries without '/'
+	uint32_t nextBlock;								  // where the next contiguous file goes
+
+	HostCard() { clear(); }
+	// an empty, present card
+	void clear();
+	// entries of a directory, "" for the root
+	unsigned long entries(const std::string &directory) const;
+};
+
+extern HostCard hostCard;
+
+class Sd2Card
+{
+public:
+	uint8_t init(uint8_t sckRateID, uint8_t chipSelectPin);
+	uint32_t cardSize();
+	uint8_t readBlock(uint32_t block, uint8_t *dst);
+	uint8_t writeBlock(uint32_t blockNumber, const uint8_t *src);
+	uint8_t erase(uint32_t firstBlock, uint32_t lastBlock);
+};
+
+class SdVolume
+{
+public:
+	uint8_t init(Sd2Card *dev);
+};
+
+class SdFile : public Print
+{
+public:
+	SdFile();
+
+	uint8_t openRoot(SdVolume *vol);
+	uint8_t open(SdFile *dirFile, const char *fileName, uint8_t oflag);
+	uint8_t makeDir(SdFile *dir, const char *dirName);
+	uint8_t createContiguous(SdFile *dirFile, const char *fileName, uint32_t size);
+	uint8_t contiguousRange(uint32_t *bgnBlock, uint32_t *endBlock);
+	uint8_t close();
+	uint8_t sync();
+	uint8_t isOpen() const;
+	uint8_t isDir() const;
+	uint32_t fileSize() const;
+	uint32_t curPosition() const;
+	uint8_t seekSet(uint32_t pos);
+	uint8_t truncate(uint32_t size);
+	int16_t read();
+	int16_t read(void *buf, uint16_t nbyte);
+	size_t write(uint8_t b);
+	size_t write(const void *buf, uint16_t nbyte);
+	size_t write(const char *str);
+
+private:
+	std::string path;
+	uint32_t position;
+	uint8_t flags;
+	bool opened;
+
+	HostFile *file() const;
+	std::string child(const char *name) const;
+};
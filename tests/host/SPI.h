@@ -0,0 +1,2 @@
+// Host stand-in for the SPI library, the SD stand-in needs no bus
+#pragma once
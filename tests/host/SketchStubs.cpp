@@ -0,0 +1,75 @@
+/*********************************************************************
+* SketchStubs.cpp
+*
+* Description: Stand-ins for the sketch objects, see SketchStubs.h
+*
+* version :  V1.0
+* date    :  2026-10-19
+**********************************************************************/
+
+#include "SketchStubs.h"
+#include "CalibrationStore.h"
+#include "Telemetry.h"
+#include "WaterLevelMonitor.h"
+
+SensorSnapshot hostSnapshot;
+uint8_t hostWaterLevels = 0;
+
+Telemetry telemetry;
+CalibrationStore calibrationStore;
+WaterLevelMonitor waterLevel;
+
+void hostPublish(unsigned long time, float value, uint8_t flags)
+{
+	hostSnapshot.sequence++;
+	hostSnapshot.time = time;
+	for (byte i = 0; i < SNAPSHOT_CHANNELS; i++)
+	{
+		hostSnapshot.value[i] = value + i;
+		hostSnapshot.age[i] = 0;
+		hostSnapshot.samples[i] = 1;
+		hostSnapshot.flags[i] = flags;
+	}
+}
+
+std::string hostTelemetry()
+{
+	int room = Serial.txRoom;
+	Serial.txRoom = 1 << 14;
+	telemetry.update();
+	Serial.txRoom = room;
+	std::string output = Serial.output;
+	Serial.output.clear();
+	return output;
+}
+
+//********************************************************************************************
+// GravitySensorHub, only the snapshot and the statistics windows
+//********************************************************************************************
+GravitySensorHub::GravitySensorHub() {}
+
+GravitySensorHub::~GravitySensorHub() {}
+
+const SensorSnapshot &GravitySensorHub::snapshot()
+{
+	return hostSnapshot;
+}
+
+#if ENABLE_STATS
+RunningStats &GravitySensorHub::windowStats(byte window, byte channel)
+{
+	return this->stats[window][channel];
+}
+#endif
+
+//********************************************************************************************
+// WaterLevelMonitor, only the levels
+//********************************************************************************************
+WaterLevelMonitor::WaterLevelMonitor() {}
+
+WaterLevelMonitor::~WaterLevelMonitor() {}
+
+byte WaterLevelMonitor::level(byte index)
+{
+	return hostWaterLevels >> index & 1;
+}
@@ -0,0 +1,26 @@
+/*********************************************************************
+* SketchStubs.h
+*
+* Description: Stand-ins for the sketch objects that the classes under
+* test reach through globals: the hub publishes hostSnapshot and the
+* water level switches read hostWaterLevels. Telemetry and the
+* calibration store are the real ones, see SketchStubs.cpp.
+*
+* version :  V1.0
+* date    :  2026-10-19
+**********************************************************************/
+
+#pragma once
+#include <Arduino.h>
+#include "GravitySensorHub.h"
+
+// returned by GravitySensorHub::snapshot()
+extern SensorSnapshot hostSnapshot;
+// returned by WaterLevelMonitor::level(), bit i for switch i
+extern uint8_t hostWaterLevels;
+
+// publish the next snapshot, channel n reads value + n
+void hostPublish(unsigned long time, float value, uint8_t flags = 0);
+
+// move the queued telemetry into Serial.output and return it, Serial.output starts empty again
+std::string hostTelemetry();
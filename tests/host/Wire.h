@@ -0,0 +1,29 @@
+/*********************************************************************
+* Wire.h
+*
+* Description: Host stand-in for the Wire library, a bus without any
+* device: transmissions go nowhere and requests return no bytes.
+*
+* version :  V1.0
+* date    :  2026-10-19
+**********************************************************************/
+
+#pragma once
+#include <Arduino.h>
+
+class TwoWire : public Stream
+{
+public:
+	void begin() {}
+	void beginTransmission(uint8_t) {}
+	uint8_t endTransmission() { return 2; } // address not acknowledged
+	uint8_t requestFrom(int, int) { return 0; }
+	size_t write(uint8_t) { return 1; }
+	size_t write(int n) { return write((uint8_t)n); }
+	using Print::write;
+	int available() { return 0; }
+	int read() { return -1; }
+	int peek() { return -1; }
+};
+
+extern TwoWire Wire;
@@ -0,0 +1,3 @@
+// Host stand-in for avr/pgmspace.h, Arduino.h maps the _P functions
+#pragma once
+#include <Arduino.h>
@@ -0,0 +1,134 @@
+/*********************************************************************
+* idle_manager_test.cpp
+*
+* Description: Host tests of IdleManager::sleep() with the simulated
+* clock of host/Arduino.h, every clock read costs HOST_CALL_COST us so
+* the wait loop sees time pass: the slept and awake counters, the
+* sleeps count, the early return on serial input and the duty cycle
+* of the POWER frame.
+*
+* version :  V1.0
+* date    :  2026-10-19
+**********************************************************************/
+
+#include "IdleManager.h"
+#include "SketchStubs.h"
+#include <stdio.h>
+
+#define HOST_CALL_COST 10 // us per micros() or millis() call
+
+IdleManager idle;
+
+static int failures = 0;
+
+#define CHECK(condition)                                                      \
+	do                                                                        \
+	{                                                                         \
+		if (!(condition))                                                     \
+		{                                                                     \
+			printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+			failures++;                                                       \
+		}                                                                     \
+	} while (0)
+
+// the POWER frame of the counters, false if it does not parse
+static bool power(unsigned long &slept, unsigned long &awake, unsigned long &sleeps, unsigned long &duty)
+{
+	idle.printCounters();
+	std::string output = hostTelemetry();
+	return sscanf(output.c_str(), "POWER@%lu,%lu,%lu,%lu\r\n", &slept, &awake, &sleeps, &duty) == 4;
+}
+
+//********************************************************************************************
+// function name: dutyCycle ()
+// Function Description: Loop passes of 4 ms work and 16 ms sleep count 20% awake, a pass
+// without time to sleep counts no sleep
+//********************************************************************************************
+static void dutyCycle()
+{
+	unsigned long slept, awake, sleeps, duty;
+	CHECK(power(slept, awake, sleeps, duty) && slept == 0 && awake == 0 && sleeps == 0 && duty == 1000);
+
+	unsigned long start = hostMicros;
+	for (uint8_t i = 0; i < 10; i++)
+	{
+		hostMicros += 4000;
+		idle.sleep(16);
+	}
+	CHECK(idle.sleeps == 10);
+	// a sleep ends on the millis() tick of its deadline, up to 1 ms early
+	CHECK(idle.sleptTime >= 150 && idle.sleptTime <= 161);
+	CHECK(idle.awakeTime == 40);
+	// every ms is counted once, the parts below 1 ms are carried
+	unsigned long elapsed = (hostMicros - start) / 1000;
+	CHECK(idle.sleptTime + idle.awakeTime + 1 >= elapsed && idle.sleptTime + idle.awakeTime <= elapsed);
+
+	// no time to sleep
+	hostMicros += 4000;
+	idle.sleep(0);
+	CHECK(idle.sleeps == 10 && idle.sleptTime <= 161 && idle.awakeTime == 44);
+
+	CHECK(power(slept, awake, sleeps, duty));
+	CHECK(slept == idle.sleptTime && awake == idle.awakeTime && sleeps == 10);
+	CHECK(duty == awake * 1000 / (slept + awake) && duty >= 210 && duty <= 225);
+}
+
+//********************************************************************************************
+// function name: serialInput ()
+// Function Description: A byte that is already waiting skips the sleep, one that arrives
+// during it ends it, IDLE_FOREVER included
+//********************************************************************************************
+static void serialInput()
+{
+	unsigned long sleeps = idle.sleeps, slept = idle.sleptTime;
+	Serial.input = "P";
+	idle.sleep(100);
+	CHECK(idle.sleeps == sleeps && idle.sleptTime == slept);
+	Serial.input.clear();
+
+	Serial.pending = "POWER\n";
+	Serial.pendingAt = hostMicros + 30000;
+	idle.sleep(IDLE_FOREVER);
+	CHECK(Serial.available() == 6);
+	CHECK(idle.sleeps == sleeps + 1);
+	CHECK(idle.sleptTime >= slept + 29 && idle.sleptTime <= slept + 31);
+	Serial.input.clear();
+
+	// a deadline before the byte arrives
+	Serial.pending = "P";
+	Serial.pendingAt = hostMicros + 50000;
+	idle.sleep(10);
+	CHECK(Serial.input.empty() && idle.sleptTime >= slept + 39 && idle.sleptTime <= slept + 42);
+	Serial.pending.clear();
+}
+
+//********************************************************************************************
+// function name: deadlines ()
+// Function Description: timeUntil() counts down to 0 and stays there
+//********************************************************************************************
+static void deadlines()
+{
+	hostMicrosPerCall = 0;
+	hostMicros = 1000000;
+	CHECK(timeUntil(900, 250) == 150);
+	CHECK(timeUntil(700, 250) == 0);
+	CHECK(timeUntil(1000, IDLE_FOREVER) == IDLE_FOREVER);
+	hostMicrosPerCall = HOST_CALL_COST;
+}
+
+int main()
+{
+	hostMicrosPerCall = HOST_CALL_COST;
+
+	dutyCycle();
+	serialInput();
+	deadlines();
+
+	if (failures > 0)
+	{
+		printf("%d checks failed\n", failures);
+		return 1;
+	}
+	printf("all checks passed\n");
+	return 0;
+}
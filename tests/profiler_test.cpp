@@ -0,0 +1,176 @@
+/*********************************************************************
+* profiler_test.cpp
+*
+* Description: Host tests of Profiler with the simulated micros() of
+* host/Arduino.h: the histogram bucket boundaries, min/max/mean and
+* count per stage, the PROFILE frames of a report and the new window
+* that starts after it.
+*
+* version :  V1.0
+* date    :  2026-10-19
+**********************************************************************/
+
+#include "Profiler.h"
+#include "SketchStubs.h"
+#include <stdio.h>
+#include <vector>
+
+Profiler profiler;
+
+static int failures = 0;
+
+#define CHECK(condition)                                                      \
+	do                                                                        \
+	{                                                                         \
+		if (!(condition))                                                     \
+		{                                                                     \
+			printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+			failures++;                                                       \
+		}                                                                     \
+	} while (0)
+
+// one PROFILE frame
+struct StageReport
+{
+	unsigned int stage;
+	unsigned long count, min, max, mean;
+	unsigned int histogram[PROFILE_BUCKETS];
+};
+
+//********************************************************************************************
+// function name: report ()
+// Function Description: Requests a report, streams it one update() and telemetry pass at a
+// time and parses its PROFILE frames
+//********************************************************************************************
+static std::vector<StageReport> report()
+{
+	std::vector<StageReport> stages;
+	std::string output;
+	profiler.requestReport();
+	for (uint8_t passes = 0; profiler.reporting() && passes < 100; passes++)
+	{
+		profiler.update();
+		output += hostTelemetry();
+	}
+	for (size_t line = 0; line < output.size();)
+	{
+		size_t end = output.find('\n', line);
+		if (end == std::string::npos)
+			end = output.size();
+		StageReport stage;
+		int used = 0;
+		if (sscanf(output.c_str() + line, "PROFILE@%u,%lu,%lu,%lu,%lu,%n", &stage.stage, &stage.count, &stage.min,
+				   &stage.max, &stage.mean, &used) == 5 &&
+			used > 0)
+		{
+			const char *histogram = output.c_str() + line + used;
+			for (uint8_t i = 0; i < PROFILE_BUCKETS; i++)
+			{
+				stage.histogram[i] = strtoul(histogram, (char **)&histogram, 10);
+				histogram++; // '/'
+			}
+			stages.push_back(stage);
+		}
+		line = end + 1;
+	}
+	return stages;
+}
+
+// time one stage with the macros of the sketch, the clock only moves by duration
+static void timeStage(unsigned long duration)
+{
+	PROFILE_BEGIN(PROFILE_SD);
+	hostMicros += duration;
+	PROFILE_END(PROFILE_SD);
+}
+
+//********************************************************************************************
+// function name: buckets ()
+// Function Description: Bucket 0 takes durations below 16us, bucket n [2^(n+3), 2^(n+4)) us
+// and the last bucket everything from 2^18 us up
+//********************************************************************************************
+static void buckets()
+{
+	const unsigned long durations[] = {0, 15, 16, 31, 32, 63, 64, 1023, 1024, 262143, 262144, 10000000};
+	const uint8_t expected[] = {0, 0, 1, 1, 2, 2, 3, 6, 7, 14, 15, 15};
+	for (uint8_t i = 0; i < sizeof(durations) / sizeof(durations[0]); i++)
+	{
+		timeStage(durations[i]);
+		std::vector<StageReport> stages = report();
+		CHECK(stages.size() == PROFILE_STAGE_COUNT);
+		if (stages.size() != PROFILE_STAGE_COUNT)
+			continue;
+		const StageReport &sd = stages[PROFILE_SD];
+		CHECK(sd.stage == PROFILE_SD && sd.count == 1 && sd.min == durations[i] && sd.max == durations[i]);
+		for (uint8_t b = 0; b < PROFILE_BUCKETS; b++)
+		{
+			if (sd.histogram[b] != (b == expected[i] ? 1U : 0U))
+			{
+				printf("%lu us counted in bucket %u\n", durations[i], b);
+				failures++;
+			}
+		}
+	}
+}
+
+//********************************************************************************************
+// function name: stageStatistics ()
+// Function Description: Every stage keeps its own count, min, max and mean, a stage that was
+// not timed reports zeros, the histogram saturates at 255 and a report starts a new window
+//********************************************************************************************
+static void stageStatistics()
+{
+	const unsigned long loops[] = {1200, 800, 1000, 3000};
+	for (uint8_t i = 0; i < 4; i++)
+	{
+		PROFILE_BEGIN(PROFILE_LOOP);
+		{
+			PROFILE_SCOPE(PROFILE_RTC);
+			hostMicros += 100 + i;
+		}
+		hostMicros += loops[i] - (100 + i);
+		PROFILE_END(PROFILE_LOOP);
+	}
+	for (unsigned int i = 0; i < 300; i++)
+	{
+		profiler.record(PROFILE_SENSOR0 + 2, 20);
+	}
+	profiler.record(PROFILE_STAGE_COUNT, 5); // no such stage
+
+	std::vector<StageReport> stages = report();
+	CHECK(stages.size() == PROFILE_STAGE_COUNT);
+	if (stages.size() == PROFILE_STAGE_COUNT)
+	{
+		for (uint8_t i = 0; i < PROFILE_STAGE_COUNT; i++)
+		{
+			CHECK(stages[i].stage == i);
+		}
+		const StageReport &loop = stages[PROFILE_LOOP], &rtc = stages[PROFILE_RTC], &sensor = stages[PROFILE_SENSOR0 + 2];
+		CHECK(loop.count == 4 && loop.min == 800 && loop.max == 3000 && loop.mean == 1500);
+		CHECK(loop.histogram[6] == 2 && loop.histogram[7] == 1 && loop.histogram[8] == 1);
+		CHECK(rtc.count == 4 && rtc.min == 100 && rtc.max == 103 && rtc.mean == 101);
+		CHECK(sensor.count == 300 && sensor.min == 20 && sensor.max == 20 && sensor.mean == 20);
+		CHECK(sensor.histogram[1] == 255);
+		CHECK(stages[PROFILE_CALIBRATE].count == 0 && stages[PROFILE_CALIBRATE].min == 0 &&
+			  stages[PROFILE_CALIBRATE].mean == 0);
+	}
+
+	// the report reset the statistics
+	stages = report();
+	CHECK(stages.size() == PROFILE_STAGE_COUNT && stages[PROFILE_LOOP].count == 0 &&
+		  stages[PROFILE_SENSOR0 + 2].histogram[1] == 0);
+}
+
+int main()
+{
+	buckets();
+	stageStatistics();
+
+	if (failures > 0)
+	{
+		printf("%d checks failed\n", failures);
+		return 1;
+	}
+	printf("all checks passed\n");
+	return 0;
+}
@@ -0,0 +1,266 @@
+/*********************************************************************
+* raw_log_test.cpp
+*
+* Description: Host tests of RawLog (SD_RAW_LOG) on the in-memory
+* card of host/SD.h: the partition table check, the binary search of
+* begin() for the head at both ends and in the middle of the ring,
+* before and after it wrapped, a torn head block and the wrap of
+* append(). A reset is a new RawLog on the same card.
+*
+* version :  V1.0
+* date    :  2026-10-19
+**********************************************************************/
+
+#include "RawLog.h"
+#include "Crc.h"
+#include "SketchStubs.h"
+#include <stdio.h>
+
+static int failures = 0;
+
+#define CHECK(condition)                                                      \
+	do                                                                        \
+	{                                                                         \
+		if (!(condition))                                                     \
+		{                                                                     \
+			printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+			failures++;                                                       \
+		}                                                                     \
+	} while (0)
+
+static Sd2Card card;
+
+// an MBR with partition 1 of the given type starting at block start
+static void partitionTable(uint8_t type, uint32_t start)
+{
+	std::vector<uint8_t> mbr(HOST_BLOCK_SIZE, 0);
+	mbr[0x1C2] = type;
+	for (uint8_t i = 0; i < 4; i++)
+	{
+		mbr[0x1C6 + i] = start >> (8 * i);
+	}
+	mbr[510] = 0x55;
+	mbr[511] = 0xAA;
+	hostCard.blocks[0] = mbr;
+}
+
+// a card with a FAT32 partition at 8192, the usual layout of an SD card
+static void newCard()
+{
+	hostCard.clear();
+	partitionTable(0x0C, 8192);
+}
+
+static RawRecord record(uint32_t time)
+{
+	RawRecord raw;
+	memset(&raw, 0, sizeof(raw));
+	raw.time = time;
+	for (uint8_t i = 0; i < SNAPSHOT_CHANNELS; i++)
+	{
+		raw.value[i] = time + i;
+	}
+	return raw;
+}
+
+static RawSector sectorAt(unsigned long index)
+{
+	RawSector sector;
+	card.readBlock(SD_RAW_FIRST_BLOCK + index, (uint8_t *)&sector);
+	return sector;
+}
+
+//********************************************************************************************
+// function name: writeSector ()
+// Function Description: Writes the block at index of the region like append() would have, with
+// count records whose times are sequence * 100 + record
+//********************************************************************************************
+static void writeSector(unsigned long index, uint32_t sequence, uint8_t count)
+{
+	RawSector sector;
+	memset(&sector, 0, sizeof(sector));
+	sector.magic = RAW_MAGIC;
+	sector.version = RAW_VERSION;
+	sector.sequence = sequence;
+	sector.count = count;
+	for (uint8_t i = 0; i < count; i++)
+	{
+		sector.record[i] = record(sequence * 100 + i);
+	}
+	sector.crc = crc16(&sector, offsetof(RawSector, crc));
+	card.writeBlock(SD_RAW_FIRST_BLOCK + index, (const uint8_t *)&sector);
+}
+
+//********************************************************************************************
+// function name: fillRing ()
+// Function Description: The region as it is after the head reached block head with count
+// records in it. Once wrapped, the blocks behind the head hold the previous round.
+//********************************************************************************************
+static void fillRing(unsigned long head, uint8_t count, bool wrapped)
+{
+	newCard();
+	for (unsigned long i = 0; i < SD_RAW_BLOCKS; i++)
+	{
+		if (i < head)
+			writeSector(i, (wrapped ? SD_RAW_BLOCKS : 0) + i + 1, RAW_RECORDS);
+		else if (i == head)
+			writeSector(i, (wrapped ? SD_RAW_BLOCKS : 0) + i + 1, count);
+		else if (wrapped)
+			writeSector(i, i + 1, RAW_RECORDS);
+	}
+}
+
+// the last record of a block is the one appended, the block is otherwise unchanged
+static bool appendedAt(unsigned long index, uint32_t sequence, uint8_t count, uint32_t time)
+{
+	RawSector sector = sectorAt(index);
+	return sector.magic == RAW_MAGIC && sector.sequence == sequence && sector.count == count &&
+		   sector.record[count - 1].time == time && (count == 1 || sector.record[0].time == sequence * 100) &&
+		   crc16(&sector, offsetof(RawSector, crc)) == sector.crc;
+}
+
+//********************************************************************************************
+// function name: partitionCheck ()
+// Function Description: begin() refuses a card without MBR, a superfloppy and a partition
+// that starts inside the region
+//********************************************************************************************
+static void partitionCheck()
+{
+	RawLog raw;
+	hostCard.clear();
+	CHECK(!raw.begin(&card)); // erased block 0, no MBR
+
+	newCard();
+	hostCard.blocks[0][0] = 0xEB; // FAT boot sector, no partition table
+	CHECK(!raw.begin(&card));
+
+	newCard();
+	partitionTable(0x0C, SD_RAW_FIRST_BLOCK + SD_RAW_BLOCKS - 1);
+	CHECK(!raw.begin(&card));
+	partitionTable(0x0C, SD_RAW_FIRST_BLOCK + SD_RAW_BLOCKS);
+	CHECK(raw.begin(&card));
+	partitionTable(0x00, 1); // unused entry
+	CHECK(raw.begin(&card));
+
+	hostCard.present = false;
+	CHECK(!raw.begin(&card));
+}
+
+//********************************************************************************************
+// function name: freshRegion ()
+// Function Description: An empty region starts at its first block with sequence 1, a full
+// block moves the head on
+//********************************************************************************************
+static void freshRegion()
+{
+	newCard();
+	RawLog raw;
+	CHECK(raw.begin(&card));
+	for (uint32_t i = 0; i < RAW_RECORDS + 3; i++)
+	{
+		CHECK(raw.append(record(100 + i)));
+	}
+	RawSector first = sectorAt(0), second = sectorAt(1);
+	CHECK(first.sequence == 1 && first.count == RAW_RECORDS && first.record[RAW_RECORDS - 1].time == 115);
+	CHECK(second.sequence == 2 && second.count == 3 && second.record[2].time == 118);
+	CHECK(sectorAt(2).magic != RAW_MAGIC);
+}
+
+//********************************************************************************************
+// function name: findHead ()
+// Function Description: After a reset the next record goes into the head block, or into the
+// next one when the head is full, for heads all over the ring before and after a wrap
+//********************************************************************************************
+static void findHead()
+{
+	const unsigned long heads[] = {0, 1, 2, 1023, 1024, SD_RAW_BLOCKS - 2, SD_RAW_BLOCKS - 1};
+	for (uint8_t wrapped = 0; wrapped < 2; wrapped++)
+	{
+		for (uint8_t h = 0; h < sizeof(heads) / sizeof(heads[0]); h++)
+		{
+			unsigned long head = heads[h];
+			uint32_t sequence = (wrapped ? SD_RAW_BLOCKS : 0) + head + 1;
+
+			fillRing(head, 5, wrapped);
+			RawLog partial;
+			CHECK(partial.begin(&card) && partial.append(record(7)));
+			CHECK(appendedAt(head, sequence, 6, 7));
+
+			fillRing(head, RAW_RECORDS, wrapped);
+			RawLog full;
+			CHECK(full.begin(&card) && full.append(record(7)));
+			CHECK(appendedAt((head + 1) % SD_RAW_BLOCKS, sequence + 1, 1, 7));
+		}
+	}
+}
+
+//********************************************************************************************
+// function name: tornHead ()
+// Function Description: A head block torn by a reset during its write fails its CRC. The
+// block before it is full, the next record starts the torn block again with the next
+// sequence. Also for block 0 torn right after the ring wrapped, where the search has to look
+// at the last block instead.
+//********************************************************************************************
+static void tornHead()
+{
+	for (uint8_t wrapped = 0; wrapped < 2; wrapped++)
+	{
+		fillRing(500, 9, wrapped);
+		hostCard.blocks[SD_RAW_FIRST_BLOCK + 500][100] ^= 0x01;
+		RawLog raw;
+		CHECK(raw.begin(&card) && raw.append(record(7)));
+		CHECK(appendedAt(500, (wrapped ? SD_RAW_BLOCKS : 0) + 501, 1, 7));
+	}
+
+	fillRing(0, 9, true);
+	hostCard.blocks[SD_RAW_FIRST_BLOCK][100] ^= 0x01;
+	RawLog raw;
+	CHECK(raw.begin(&card) && raw.append(record(7)));
+	CHECK(appendedAt(0, SD_RAW_BLOCKS + 1, 1, 7));
+	CHECK(sectorAt(1).sequence == 2);
+}
+
+//********************************************************************************************
+// function name: wrapAround ()
+// Function Description: append() runs around the whole ring and overwrites the oldest block,
+// a reset after the wrap continues at the new head
+//********************************************************************************************
+static void wrapAround()
+{
+	newCard();
+	const unsigned long total = (unsigned long)SD_RAW_BLOCKS * RAW_RECORDS + 3;
+	{
+		RawLog raw;
+		CHECK(raw.begin(&card));
+		for (unsigned long i = 0; i < total; i++)
+		{
+			raw.append(record(i));
+		}
+	}
+	RawSector head = sectorAt(0);
+	CHECK(head.sequence == SD_RAW_BLOCKS + 1 && head.count == 3 && head.record[2].time == total - 1);
+	CHECK(sectorAt(1).sequence == 2 && sectorAt(SD_RAW_BLOCKS - 1).sequence == SD_RAW_BLOCKS);
+
+	RawLog raw;
+	CHECK(raw.begin(&card) && raw.append(record(total)));
+	head = sectorAt(0);
+	CHECK(head.sequence == SD_RAW_BLOCKS + 1 && head.count == 4 && head.record[3].time == total);
+	CHECK(sectorAt(1).sequence == 2);
+}
+
+int main()
+{
+	partitionCheck();
+	freshRegion();
+	findHead();
+	tornHead();
+	wrapAround();
+
+	if (failures > 0)
+	{
+		printf("%d checks failed\n", failures);
+		return 1;
+	}
+	printf("all checks passed\n");
+	return 0;
+}
@@ -0,0 +1,207 @@
+/*********************************************************************
+* report_log_test.cpp
+*
+* Description: Host tests of the RESEND of ReportLog: the frames kept
+* in RAM without a card, REPORTS.BIN on the in-memory card of
+* host/SD.h for the frames that left RAM, GAP frames for what neither
+* holds, and the spool starting over after a reset.
+*
+* version :  V1.0
+* date    :  2026-10-19
+**********************************************************************/
+
+#include "ReportLog.h"
+#include "SketchStubs.h"
+#include "Telemetry.h"
+#include <stdio.h>
+#include <vector>
+
+ReportLog reportLog;
+
+static int failures = 0;
+
+#define CHECK(condition)                                                      \
+	do                                                                        \
+	{                                                                         \
+		if (!(condition))                                                     \
+		{                                                                     \
+			printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+			failures++;                                                       \
+		}                                                                     \
+	} while (0)
+
+static SdVolume volume;
+static SdFile root;
+
+// one frame of a RESEND, a report or a GAP
+struct Frame
+{
+	bool gap;
+	unsigned long first; // sequence of a report, first sequence of a gap
+	unsigned long last;
+	float ph;
+};
+
+// send count reports, report n reads pH n / 100
+static void sendReports(ReportLog &log, unsigned long first, unsigned long count)
+{
+	for (unsigned long sequence = first; sequence < first + count; sequence++)
+	{
+		hostPublish(sequence, sequence / 100.0f);
+		telemetry.beginFrame(TELEMETRY_REPORT_RESERVE);
+		log.send(hostSnapshot);
+		hostTelemetry();
+	}
+}
+
+//********************************************************************************************
+// function name: resend ()
+// Function Description: Runs a RESEND to its end and parses the frames it sent
+//********************************************************************************************
+static std::vector<Frame> resend(ReportLog &log, unsigned long sequence)
+{
+	std::string output;
+	log.resend(sequence);
+	for (unsigned long passes = 0; log.resending() && passes < 10000; passes++)
+	{
+		log.update();
+		output += hostTelemetry();
+	}
+	std::vector<Frame> frames;
+	for (size_t line = 0; line < output.size();)
+	{
+		size_t end = output.find('\n', line);
+		if (end == std::string::npos)
+			end = output.size();
+		std::string text = output.substr(line, end - line);
+		Frame frame = {false, 0, 0, 0};
+		size_t seq = text.find("#SEQ@");
+		if (sscanf(text.c_str(), "GAP@%lu,%lu", &frame.first, &frame.last) == 2)
+		{
+			frame.gap = true;
+			frames.push_back(frame);
+		}
+		else if (seq != std::string::npos && sscanf(text.c_str(), "PH@%f", &frame.ph) == 1)
+		{
+			frame.first = frame.last = strtoul(text.c_str() + seq + 5, NULL, 10);
+			frames.push_back(frame);
+		}
+		line = end + 1;
+	}
+	return frames;
+}
+
+// frames from on are the reports first..last in order, sent as report sequence + offset
+static bool reports(const std::vector<Frame> &frames, size_t from, unsigned long first, unsigned long last,
+					unsigned long offset = 0)
+{
+	if (frames.size() < from + (last - first + 1))
+		return false;
+	for (unsigned long sequence = first; sequence <= last; sequence++)
+	{
+		const Frame &frame = frames[from + sequence - first];
+		if (frame.gap || frame.first != sequence || fabs(frame.ph - (sequence + offset) / 100.0f) > 0.006f)
+			return false;
+	}
+	return true;
+}
+
+static void newCard()
+{
+	hostCard.clear();
+	hostSnapshot.sequence = 0;
+	root.close();
+	root.openRoot(&volume);
+}
+
+//********************************************************************************************
+// function name: ramOnly ()
+// Function Description: Without a card only the last REPORT_UNACKED frames come back, the
+// ones before them as a GAP
+//********************************************************************************************
+static void ramOnly()
+{
+	ReportLog log;
+	log.setup(NULL);
+	sendReports(log, 1, 20);
+	std::vector<Frame> frames = resend(log, 1);
+	CHECK(frames.size() == REPORT_UNACKED + 1);
+	CHECK(!frames.empty() && frames[0].gap && frames[0].first == 1 && frames[0].last == 20 - REPORT_UNACKED);
+	CHECK(reports(frames, 1, 20 - REPORT_UNACKED + 1, 20));
+	CHECK(log.framesEvicted == 20 - REPORT_UNACKED);
+}
+
+//********************************************************************************************
+// function name: spooled ()
+// Function Description: With a card a RESEND after an outage gets every frame back, the ones
+// that left RAM from REPORTS.BIN. ACK frees them, frames beyond REPORT_SPOOL become a GAP.
+//********************************************************************************************
+static void spooled()
+{
+	newCard();
+	ReportLog log;
+	log.setup(&root);
+	sendReports(log, 1, 100);
+	CHECK(hostCard.files["REPORTS.BIN"].data.size() == 100 * sizeof(Report));
+
+	std::vector<Frame> frames = resend(log, 1);
+	CHECK(frames.size() == 100 && reports(frames, 0, 1, 100));
+	CHECK(log.framesEvicted == 0 && log.framesResent == 100);
+
+	log.acknowledge(60);
+	frames = resend(log, 1);
+	CHECK(frames.size() == 40 && reports(frames, 0, 61, 100));
+
+	// an outage longer than the spool
+	sendReports(log, 101, REPORT_SPOOL + 10);
+	CHECK(hostCard.files["REPORTS.BIN"].data.size() == REPORT_SPOOL * sizeof(Report));
+	frames = resend(log, 61);
+	CHECK(frames.size() == REPORT_SPOOL + 1);
+	CHECK(!frames.empty() && frames[0].gap && frames[0].first == 61 && frames[0].last == 110);
+	CHECK(reports(frames, 1, 111, 110 + REPORT_SPOOL));
+	CHECK(log.framesEvicted == 50);
+}
+
+//********************************************************************************************
+// function name: afterReset ()
+// Function Description: The sequence starts over at 1 after a reset, the frames of the run
+// before are not sent for it
+//********************************************************************************************
+static void afterReset()
+{
+	newCard();
+	{
+		ReportLog log;
+		log.setup(&root);
+		sendReports(log, 1, 50);
+	}
+	ReportLog log;
+	log.setup(&root);
+	CHECK(hostCard.files["REPORTS.BIN"].data.empty());
+	sendReports(log, 1001, 10);
+	std::vector<Frame> frames = resend(log, 1);
+	CHECK(frames.size() == 10 && reports(frames, 0, 1, 10, 1000));
+
+	// a pulled card leaves the frames in RAM
+	hostCard.present = false;
+	sendReports(log, 1011, 10);
+	frames = resend(log, 1);
+	CHECK(frames.size() == REPORT_UNACKED + 1);
+	CHECK(!frames.empty() && frames[0].gap && frames[0].first == 1 && frames[0].last == 20 - REPORT_UNACKED);
+	CHECK(reports(frames, 1, 20 - REPORT_UNACKED + 1, 20, 1000));
+}
+
+int main()
+{
+	ramOnly();
+	spooled();
+	afterReset();
+
+	if (failures > 0)
+	{
+		printf("%d checks failed\n", failures);
+		return 1;
+	}
+	printf("all checks passed\n");
+	return 0;
+}
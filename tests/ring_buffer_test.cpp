@@ -0,0 +1,164 @@
+/*********************************************************************
+* ring_buffer_test.cpp
+*
+* Description: Host tests of RingBuffer.h. A producer and a consumer
+* thread hammer one buffer, the consumer checks that every item arrives
+* once, in order and untorn. Runs with the 8-bit index (capacity up to
+* 128, head and tail wrap at 256) and the 16-bit index, and with
+* single-threaded checks of the wrap-around, space() and unpush().
+*
+* version :  V1.0
+* date    :  2026-10-19
+**********************************************************************/
+
+#include "RingBuffer.h"
+#include <stdio.h>
+#include <thread>
+
+#define STRESS_ITEMS 500000UL
+
+static int failures = 0;
+
+#define CHECK(condition)                                                      \
+	do                                                                        \
+	{                                                                         \
+		if (!(condition))                                                     \
+		{                                                                     \
+			printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+			failures++;                                                       \
+		}                                                                     \
+	} while (0)
+
+// wider than a machine word, a torn read shows up as a check mismatch
+struct Item
+{
+	uint32_t sequence;
+	uint32_t check;
+	uint16_t pad[3];
+};
+
+//********************************************************************************************
+// function name: stress ()
+// Function Description: Pushes STRESS_ITEMS numbered items from a second thread while this
+// thread pops them, both sides yield on a full or empty buffer
+//********************************************************************************************
+template <uint16_t Capacity>
+static void stress()
+{
+	static RingBuffer<Item, Capacity> buffer;
+	unsigned long fullSpins = 0;
+
+	std::thread producer([&fullSpins]() {
+		for (uint32_t i = 0; i < STRESS_ITEMS; i++)
+		{
+			Item item;
+			item.sequence = i;
+			item.check = ~i;
+			for (uint8_t j = 0; j < 3; j++)
+			{
+				item.pad[j] = (uint16_t)(i * (j + 1));
+			}
+			while (!buffer.push(item))
+			{
+				fullSpins++;
+				std::this_thread::yield();
+			}
+		}
+	});
+
+	uint32_t expected = 0, errors = 0;
+	unsigned long emptySpins = 0;
+	while (expected < STRESS_ITEMS)
+	{
+		Item item;
+		if (!buffer.pop(item))
+		{
+			emptySpins++;
+			std::this_thread::yield();
+			continue;
+		}
+		bool torn = item.check != ~item.sequence;
+		for (uint8_t j = 0; j < 3; j++)
+		{
+			torn |= item.pad[j] != (uint16_t)(item.sequence * (j + 1));
+		}
+		if (item.sequence != expected || torn)
+			errors++;
+		expected = item.sequence + 1;
+	}
+	producer.join();
+
+	CHECK(errors == 0);
+	CHECK(buffer.empty());
+	printf("stress capacity %u, %u byte index: %lu items, %lu full and %lu empty spins, %lu errors\n",
+		   Capacity, (unsigned)sizeof(typename RingBuffer<Item, Capacity>::index_t), STRESS_ITEMS, fullSpins,
+		   emptySpins, (unsigned long)errors);
+}
+
+//********************************************************************************************
+// function name: sequential ()
+// Function Description: Fills and drains the buffer past the wrap of its indices, checks
+// space(), available(), peek(), clear() and unpush() at every step
+//********************************************************************************************
+template <uint16_t Capacity>
+static void sequential()
+{
+	RingBuffer<uint16_t, Capacity> buffer;
+	uint16_t next = 0, expected = 0;
+
+	for (unsigned long round = 0; round < 3UL * 65536 / Capacity + 3; round++)
+	{
+		// fill up to a varying level, every slot must be usable
+		uint16_t level = round % 3 == 0 ? Capacity : (uint16_t)(round % Capacity + 1);
+		for (uint16_t i = 0; i < level; i++)
+		{
+			CHECK(buffer.space() == Capacity - i);
+			CHECK(buffer.push(next++));
+		}
+		if (level == Capacity)
+			CHECK(!buffer.push(0));
+		CHECK(buffer.available() == level);
+
+		// take the newest item back and push it again
+		CHECK(buffer.unpush(1));
+		CHECK(buffer.available() == level - 1);
+		CHECK(buffer.push(next - 1));
+		CHECK(!buffer.unpush(level + 1));
+
+		uint16_t item;
+		CHECK(buffer.peek(item) && item == expected);
+		while (buffer.pop(item))
+		{
+			CHECK(item == expected);
+			expected++;
+		}
+		CHECK(buffer.empty() && buffer.space() == Capacity);
+	}
+
+	CHECK(buffer.push(1) && buffer.push(2));
+	buffer.clear();
+	CHECK(buffer.empty() && buffer.space() == Capacity);
+}
+
+int main()
+{
+	sequential<2>();
+	sequential<64>();
+	sequential<128>();
+	sequential<256>();
+	sequential<1024>();
+
+	stress<2>();
+	stress<8>();
+	stress<128>();
+	stress<256>();
+	stress<4096>();
+
+	if (failures > 0)
+	{
+		printf("%d checks failed\n", failures);
+		return 1;
+	}
+	printf("all checks passed\n");
+	return 0;
+}
@@ -0,0 +1,196 @@
+/*********************************************************************
+* rollup_log_test.cpp
+*
+* Description: Host tests of RollupLog on the in-memory card of
+* host/SD.h: the minute, 15 minute and hour records with count, min,
+* max and mean, the merge into the record of the running period, a new
+* period appending the next record, READING_MISSING values left out
+* and the tiers continued after a reset (a new RollupLog).
+*
+* version :  V1.0
+* date    :  2026-10-19
+**********************************************************************/
+
+#include "RollupLog.h"
+#include "ISensor.h"
+#include "SketchStubs.h"
+#include <stdio.h>
+#include <vector>
+
+#define FIVE_OCLOCK 1792386000UL // 2026-10-19 05:00:00
+
+static int failures = 0;
+
+#define CHECK(condition)                                                      \
+	do                                                                        \
+	{                                                                         \
+		if (!(condition))                                                     \
+		{                                                                     \
+			printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+			failures++;                                                       \
+		}                                                                     \
+	} while (0)
+
+static GravitySensorHub hub;
+static SdVolume volume;
+static SdFile root;
+
+static std::vector<RollupRecord> records(const char *path)
+{
+	std::vector<RollupRecord> result;
+	const std::vector<uint8_t> &data = hostCard.files[path].data;
+	for (size_t offset = 0; offset + sizeof(RollupRecord) <= data.size(); offset += sizeof(RollupRecord))
+	{
+		RollupRecord record;
+		memcpy(&record, &data[offset], sizeof(record));
+		result.push_back(record);
+	}
+	return result;
+}
+
+static bool near(float value, float expected)
+{
+	return fabs(value - expected) < 0.0001f;
+}
+
+// a channel of a record, channel n of the snapshots reads value + n
+static bool summary(const RollupRecord &record, uint8_t channel, uint16_t count, float minimum, float maximum,
+					float mean)
+{
+	const RollupChannel &stats = record.channel[channel];
+	return stats.count == count && near(stats.minimum, minimum + channel) && near(stats.maximum, maximum + channel) &&
+		   near(stats.mean, mean + channel);
+}
+
+static void publish(RollupLog &rollup, unsigned long time, float value, uint8_t flags = 0)
+{
+	hostPublish(time, value, flags);
+	rollup.update();
+}
+
+//********************************************************************************************
+// function name: tiers ()
+// Function Description: Snapshots of three minutes over two quarters and two hours end up in
+// the minute, 15 minute and hour files, the running period is merged in place and a reset
+// only loses the minute in progress
+//********************************************************************************************
+static void tiers()
+{
+	hostCard.clear();
+	hostSnapshot.sequence = 0;
+	root.close();
+	CHECK(root.openRoot(&volume));
+	const char *minutes = "2610/261019.M01";
+	const char *quarters = "2610/2610.M15";
+	const char *hours = "2026.H01";
+	{
+		RollupLog rollup(&hub);
+		rollup.setup(&root);
+		publish(rollup, FIVE_OCLOCK, 7);
+		publish(rollup, FIVE_OCLOCK + 10, 8);
+		publish(rollup, FIVE_OCLOCK + 20, 9);
+		publish(rollup, FIVE_OCLOCK + 30, 6);
+		// the minute is stored once the next one begins
+		CHECK(hostCard.files.empty());
+		publish(rollup, FIVE_OCLOCK + 60, 10);
+		CHECK(records(minutes).size() == 1 && records(quarters).size() == 1 && records(hours).size() == 1);
+
+		publish(rollup, FIVE_OCLOCK + 70, 11);
+		publish(rollup, FIVE_OCLOCK + 80, 100, READING_MISSING);
+		// the same snapshot again is not counted twice
+		rollup.update();
+		publish(rollup, FIVE_OCLOCK + 15 * 60, 12);
+		publish(rollup, FIVE_OCLOCK + 16 * 60, 13); // lost with the reset
+	}
+
+	std::vector<RollupRecord> minute = records(minutes);
+	CHECK(minute.size() == 3);
+	CHECK(minute.size() == 3 && minute[0].time == FIVE_OCLOCK && minute[0].flags == 0);
+	CHECK(minute.size() == 3 && summary(minute[0], 0, 4, 6, 9, 7.5f) && summary(minute[0], 4, 4, 6, 9, 7.5f));
+	CHECK(minute.size() == 3 && minute[1].time == FIVE_OCLOCK + 60 && minute[1].flags == READING_MISSING);
+	CHECK(minute.size() == 3 && summary(minute[1], 0, 2, 10, 11, 10.5f) && summary(minute[1], 3, 2, 10, 11, 10.5f));
+	CHECK(minute.size() == 3 && minute[2].time == FIVE_OCLOCK + 15 * 60 && summary(minute[2], 0, 1, 12, 12, 12));
+
+	std::vector<RollupRecord> quarter = records(quarters);
+	CHECK(quarter.size() == 2);
+	CHECK(quarter.size() == 2 && quarter[0].time == FIVE_OCLOCK && quarter[0].flags == READING_MISSING);
+	CHECK(quarter.size() == 2 && summary(quarter[0], 0, 6, 6, 11, 51 / 6.0f) && summary(quarter[0], 1, 6, 6, 11, 51 / 6.0f));
+	CHECK(quarter.size() == 2 && quarter[1].time == FIVE_OCLOCK + 15 * 60 && summary(quarter[1], 0, 1, 12, 12, 12));
+
+	std::vector<RollupRecord> hour = records(hours);
+	CHECK(hour.size() == 1 && hour[0].time == FIVE_OCLOCK && summary(hour[0], 0, 7, 6, 12, 9));
+
+	// after a reset the running quarter and hour go on in the records on the card
+	RollupLog rollup(&hub);
+	rollup.setup(&root);
+	publish(rollup, FIVE_OCLOCK + 20 * 60, 14);
+	publish(rollup, FIVE_OCLOCK + 60 * 60, 15);
+	publish(rollup, FIVE_OCLOCK + 61 * 60, 16);
+
+	CHECK(records(minutes).size() == 5);
+	quarter = records(quarters);
+	CHECK(quarter.size() == 3 && summary(quarter[1], 0, 2, 12, 14, 13));
+	CHECK(quarter.size() == 3 && quarter[2].time == FIVE_OCLOCK + 3600 && summary(quarter[2], 0, 1, 15, 15, 15));
+	hour = records(hours);
+	CHECK(hour.size() == 2 && summary(hour[0], 0, 8, 6, 14, 77 / 8.0f) && summary(hour[0], 2, 8, 6, 14, 77 / 8.0f));
+	CHECK(hour.size() == 2 && hour[1].time == FIVE_OCLOCK + 3600 && summary(hour[1], 0, 1, 15, 15, 15));
+	CHECK(hostCard.files[hours].data.size() == 2 * sizeof(RollupRecord));
+}
+
+//********************************************************************************************
+// function name: tornRecord ()
+// Function Description: A record cut short by a reset at the end of a tier file is
+// overwritten by the next one
+//********************************************************************************************
+static void tornRecord()
+{
+	hostCard.clear();
+	hostSnapshot.sequence = 0;
+	root.close();
+	CHECK(root.openRoot(&volume));
+	const char *hours = "2026.H01";
+	{
+		RollupLog rollup(&hub);
+		rollup.setup(&root);
+		publish(rollup, FIVE_OCLOCK, 7);
+		publish(rollup, FIVE_OCLOCK + 60, 8);
+	}
+	hostCard.files[hours].data.resize(sizeof(RollupRecord) / 2);
+
+	RollupLog rollup(&hub);
+	rollup.setup(&root);
+	publish(rollup, FIVE_OCLOCK + 120, 9);
+	publish(rollup, FIVE_OCLOCK + 180, 10);
+	std::vector<RollupRecord> hour = records(hours);
+	CHECK(hostCard.files[hours].data.size() == sizeof(RollupRecord));
+	CHECK(hour.size() == 1 && hour[0].time == FIVE_OCLOCK && summary(hour[0], 0, 1, 9, 9, 9));
+}
+
+//********************************************************************************************
+// function name: noCard ()
+// Function Description: Without a directory the minutes are dropped
+//********************************************************************************************
+static void noCard()
+{
+	hostCard.clear();
+	RollupLog rollup(&hub);
+	rollup.setup(NULL);
+	publish(rollup, FIVE_OCLOCK, 7);
+	publish(rollup, FIVE_OCLOCK + 60, 8);
+	CHECK(hostCard.files.empty());
+}
+
+int main()
+{
+	tiers();
+	tornRecord();
+	noCard();
+
+	if (failures > 0)
+	{
+		printf("%d checks failed\n", failures);
+		return 1;
+	}
+	printf("all checks passed\n");
+	return 0;
+}
@@ -0,0 +1,18 @@
+# Decodes the .BIN log written by sample_codec_test with tools/sample_codec.py and compares
+# the csv with the one sample_codec_test expects, so the decoder and SampleCodec agree.
+#
+#   cmake -DTEST=sample_codec_test -DPYTHON=python3 -DDECODER=tools/sample_codec.py
+#         -DWORK=build -P sample_codec_py.cmake
+execute_process(COMMAND ${TEST} ${WORK}/codec.BIN ${WORK}/codec.csv RESULT_VARIABLE result)
+if(result)
+	message(FATAL_ERROR "sample_codec_test failed")
+endif()
+execute_process(COMMAND ${PYTHON} ${DECODER} ${WORK}/codec.BIN OUTPUT_VARIABLE decoded RESULT_VARIABLE result)
+if(result)
+	message(FATAL_ERROR "sample_codec.py failed")
+endif()
+file(READ ${WORK}/codec.csv expected)
+if(NOT decoded STREQUAL expected)
+	message(FATAL_ERROR "sample_codec.py does not decode what SampleCodec encoded\nexpected:\n${expected}\ndecoded:\n${decoded}")
+endif()
+message(STATUS "sample_codec.py matches SampleCodec")
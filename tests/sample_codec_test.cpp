@@ -0,0 +1,258 @@
+/*********************************************************************
+* sample_codec_test.cpp
+*
+* Description: Host tests of SampleCodec: round trip of keyframes and
+* deltas, the keyframe interval, restart() and the worst case record
+* size. Run with two paths it also writes a .BIN log in the frame
+* layout of SdService and the csv that tools/sample_codec.py has to
+* print for it, sample_codec_py.cmake compares the two.
+*
+* version :  V1.0
+* date    :  2026-10-19
+**********************************************************************/
+
+#include "SampleCodec.h"
+#include "Crc.h"
+#include <stdio.h>
+#include <time.h>
+#include <string>
+#include <vector>
+
+#define DAY_START 1792368000UL // 2026-10-19 00:00:00
+#define SECTOR_SIZE 512
+
+static int failures = 0;
+
+#define CHECK(condition)                                                      \
+	do                                                                        \
+	{                                                                         \
+		if (!(condition))                                                     \
+		{                                                                     \
+			printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+			failures++;                                                       \
+		}                                                                     \
+	} while (0)
+
+// quantization steps of SampleCodec.cpp and tools/sample_codec.py
+static const int scale[SNAPSHOT_CHANNELS] = {1000, 16, 1, 1000, 1};
+
+// a sample and the quantized values it was made of
+struct TestSample
+{
+	CodecSample sample;
+	long quantized[SNAPSHOT_CHANNELS];
+};
+
+//********************************************************************************************
+// function name: series ()
+// Function Description: Samples every 30 s with small changes on every channel, negative ORP
+// values, a gap in time, flag changes and water level changes
+//********************************************************************************************
+static std::vector<TestSample> series(size_t count)
+{
+	std::vector<TestSample> samples;
+	for (size_t i = 0; i < count; i++)
+	{
+		TestSample test;
+		test.quantized[0] = 7000 + (long)(i * 37 % 200) - 100;
+		test.quantized[1] = 16 * 20 + (long)(i % 7);
+		test.quantized[2] = 500 + (long)(i % 3);
+		test.quantized[3] = 1200 - 3 * (long)i;
+		test.quantized[4] = -150 + (long)(i % 11);
+		test.sample.stamp = DAY_START + i * 30 + (i >= 50 ? 3600 : 0);
+		for (uint8_t c = 0; c < SNAPSHOT_CHANNELS; c++)
+		{
+			test.sample.value[c] = (float)test.quantized[c] / scale[c];
+			test.sample.flags[c] = c == 2 ? i / 25 % 3 : 0;
+		}
+		test.sample.aux = i / 40;
+		samples.push_back(test);
+	}
+	// the same sample twice, a record without any change
+	samples.push_back(samples.back());
+	samples.back().sample.stamp += 30;
+	return samples;
+}
+
+static bool sameSample(const CodecSample &decoded, const TestSample &expected)
+{
+	if (decoded.stamp != expected.sample.stamp || decoded.aux != expected.sample.aux)
+		return false;
+	for (uint8_t c = 0; c < SNAPSHOT_CHANNELS; c++)
+	{
+		if (decoded.value[c] != (float)expected.quantized[c] / scale[c] || decoded.flags[c] != expected.sample.flags[c])
+			return false;
+	}
+	return true;
+}
+
+//********************************************************************************************
+// function name: roundTrip ()
+// Function Description: Every record decodes to the quantized sample. The first record and
+// every CODEC_KEYFRAME_INTERVAL one after it is a keyframe, the rest are shorter deltas.
+//********************************************************************************************
+static void roundTrip()
+{
+	std::vector<TestSample> samples = series(100);
+	SampleCodec encoder, decoder;
+	size_t keyframes = 0, deltaBytes = 0;
+	for (size_t i = 0; i < samples.size(); i++)
+	{
+		uint8_t record[CODEC_MAX_RECORD];
+		uint8_t length = encoder.encode(samples[i].sample, record);
+		CHECK(length > 0 && length <= CODEC_MAX_RECORD);
+		CHECK(record[0] != CODEC_PADDING && record[0] != CODEC_ERASED);
+		CHECK((record[0] == CODEC_KEYFRAME) == (i % CODEC_KEYFRAME_INTERVAL == 0));
+		keyframes += record[0] == CODEC_KEYFRAME;
+		if (record[0] != CODEC_KEYFRAME)
+			deltaBytes += length;
+
+		CodecSample decoded;
+		CHECK(decoder.decode(record, length, decoded));
+		CHECK(sameSample(decoded, samples[i]));
+	}
+	CHECK(keyframes == (samples.size() + CODEC_KEYFRAME_INTERVAL - 1) / CODEC_KEYFRAME_INTERVAL);
+	// a delta of small changes takes a few bytes
+	CHECK(deltaBytes < (samples.size() - keyframes) * 10);
+}
+
+//********************************************************************************************
+// function name: restartAndResync ()
+// Function Description: restart() makes the next record a keyframe. A decoder without a
+// keyframe refuses deltas, and picks the stream up at the next keyframe.
+//********************************************************************************************
+static void restartAndResync()
+{
+	std::vector<TestSample> samples = series(4);
+	SampleCodec encoder;
+	uint8_t record[4][CODEC_MAX_RECORD];
+	uint8_t length[4];
+	length[0] = encoder.encode(samples[0].sample, record[0]);
+	length[1] = encoder.encode(samples[1].sample, record[1]);
+	encoder.restart();
+	length[2] = encoder.encode(samples[2].sample, record[2]);
+	length[3] = encoder.encode(samples[3].sample, record[3]);
+	CHECK(record[1][0] != CODEC_KEYFRAME && record[2][0] == CODEC_KEYFRAME && record[3][0] != CODEC_KEYFRAME);
+
+	SampleCodec decoder;
+	CodecSample decoded;
+	CHECK(!decoder.decode(record[1], length[1], decoded));
+	CHECK(decoder.decode(record[2], length[2], decoded) && sameSample(decoded, samples[2]));
+	CHECK(decoder.decode(record[3], length[3], decoded) && sameSample(decoded, samples[3]));
+
+	// a keyframe on the side leaves the delta chain alone
+	uint8_t keyframe[CODEC_MAX_RECORD];
+	uint8_t keyframeLength = SampleCodec::encodeKeyframe(samples[0].sample, keyframe);
+	SampleCodec other;
+	CHECK(other.decode(keyframe, keyframeLength, decoded) && sameSample(decoded, samples[0]));
+	CHECK(encoder.encode(samples[0].sample, record[0]) > 0 && record[0][0] != CODEC_KEYFRAME);
+	CHECK(decoder.decode(record[0], 0, decoded) == false);
+	// cut short
+	CHECK(!decoder.decode(record[3], length[3] - 1, decoded));
+}
+
+//********************************************************************************************
+// function name: worstCase ()
+// Function Description: Full scale jumps on every channel with new flags and levels still fit
+// CODEC_MAX_RECORD and decode to the clamped values
+//********************************************************************************************
+static void worstCase()
+{
+	SampleCodec encoder, decoder;
+	CodecSample sample, decoded;
+	for (uint8_t i = 0; i < 4; i++)
+	{
+		sample.stamp = i % 2 ? 0 : 0x7FFFFFFFUL;
+		for (uint8_t c = 0; c < SNAPSHOT_CHANNELS; c++)
+		{
+			sample.value[c] = i % 2 ? -1e12f : 1e12f;
+			sample.flags[c] = i;
+		}
+		sample.aux = i;
+		uint8_t record[CODEC_MAX_RECORD];
+		uint8_t length = encoder.encode(sample, record);
+		CHECK(length <= CODEC_MAX_RECORD);
+		CHECK(decoder.decode(record, length, decoded));
+		CHECK(decoded.stamp == sample.stamp && decoded.value[2] == (i % 2 ? -1e9f : 1e9f) && decoded.aux == i);
+	}
+}
+
+//********************************************************************************************
+// function name: writeReference ()
+// Function Description: Writes samples as a .BIN log, frames of length, record and CRC16 that
+// do not cross a sector and a keyframe at the start of every sector, like SdService. The
+// expected output of tools/sample_codec.py goes to csvPath.
+//********************************************************************************************
+static bool writeReference(const char *binPath, const char *csvPath)
+{
+	std::vector<TestSample> samples = series(150);
+	std::vector<uint8_t> log;
+	std::string csv = "date,pH,temp(C),TDS(ppm),ec(ms/cm),orp(mv),flags,levels\n";
+	SampleCodec codec;
+	for (size_t i = 0; i < samples.size(); i++)
+	{
+		uint8_t frame[CODEC_MAX_RECORD + 3];
+		uint8_t length = codec.encode(samples[i].sample, frame + 1);
+		if (log.size() % SECTOR_SIZE + length + 3 > SECTOR_SIZE)
+		{
+			log.resize((log.size() / SECTOR_SIZE + 1) * SECTOR_SIZE, CODEC_PADDING);
+			codec.restart();
+			length = codec.encode(samples[i].sample, frame + 1);
+		}
+		frame[0] = length;
+		uint16_t crc = crc16(frame, length + 1);
+		frame[length + 1] = crc;
+		frame[length + 2] = crc >> 8;
+		log.insert(log.end(), frame, frame + length + 3);
+
+		char text[128];
+		time_t stamp = samples[i].sample.stamp;
+		struct tm date;
+		gmtime_r(&stamp, &date);
+		strftime(text, sizeof(text), "%Y/%m/%d/%H/%M/%S", &date);
+		csv += text;
+		for (uint8_t c = 0; c < SNAPSHOT_CHANNELS; c++)
+		{
+			snprintf(text, sizeof(text), ",%g", (double)samples[i].quantized[c] / scale[c]);
+			csv += text;
+		}
+		for (uint8_t c = 0; c < SNAPSHOT_CHANNELS; c++)
+		{
+			snprintf(text, sizeof(text), "%c%X", c == 0 ? ',' : '/', samples[i].sample.flags[c]);
+			csv += text;
+		}
+		snprintf(text, sizeof(text), ",%u\n", samples[i].sample.aux);
+		csv += text;
+	}
+	// the erased rest of the log
+	log.resize((log.size() / SECTOR_SIZE + 2) * SECTOR_SIZE, CODEC_ERASED);
+	CHECK(log.size() > 2 * SECTOR_SIZE);
+
+	FILE *bin = fopen(binPath, "wb");
+	FILE *text = fopen(csvPath, "wb");
+	bool written = bin && text && fwrite(&log[0], 1, log.size(), bin) == log.size() &&
+				   fwrite(csv.c_str(), 1, csv.size(), text) == csv.size();
+	if (bin)
+		fclose(bin);
+	if (text)
+		fclose(text);
+	CHECK(written);
+	return written;
+}
+
+int main(int argc, char **argv)
+{
+	roundTrip();
+	restartAndResync();
+	worstCase();
+	if (argc == 3)
+		writeReference(argv[1], argv[2]);
+
+	if (failures > 0)
+	{
+		printf("%d checks failed\n", failures);
+		return 1;
+	}
+	printf("all checks passed\n");
+	return 0;
+}
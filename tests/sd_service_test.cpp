@@ -0,0 +1,523 @@
+/*********************************************************************
+* sd_service_test.cpp
+*
+* Description: Host tests of the daily SD logs of SdService on the
+* in-memory card of host/SD.h. Built twice, for SampleCodec frames
+* (SD_COMPRESSED 1) and for csv rows (SD_COMPRESSED 0), both with a
+* small SD_LOG_FILE_SIZE so a day takes several parts. A reset is a new
+* SdService on the same card.
+*
+* version :  V1.0
+* date    :  2026-10-19
+**********************************************************************/
+
+#include "SdService.h"
+#include "CalibrationStore.h"
+#include "GravityRtc.h"
+#include "Crc.h"
+#include "SketchStubs.h"
+#include <stdio.h>
+#include <vector>
+
+#define DAY_START 1792368000UL // 2026-10-19 00:00:00
+#define ROW_INTERVAL 30		   // s between the snapshots logged
+
+#if SD_COMPRESSED
+#define LOG_EXTENSION ".BIN"
+#else
+#define LOG_EXTENSION ".CSV"
+#endif
+
+static int failures = 0;
+
+#define CHECK(condition)                                                      \
+	do                                                                        \
+	{                                                                         \
+		if (!(condition))                                                     \
+		{                                                                     \
+			printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+			failures++;                                                       \
+		}                                                                     \
+	} while (0)
+
+// one record found in a log
+struct LogEntry
+{
+	unsigned long time;
+	float value;		  // channel 0
+	unsigned long offset; // of the frame or row in the file
+	unsigned long end;	  // behind it
+};
+
+static GravitySensorHub hub;
+
+//********************************************************************************************
+// function name: logAt ()
+// Function Description: Publishes a snapshot and lets the SD interval pass, so update()
+// writes it
+//********************************************************************************************
+static void logAt(SdService &sd, unsigned long time, float value)
+{
+	hostPublish(time, value);
+	hostMicros += (calibrationStore.intervals.value[INTERVAL_SD_LOG] * 1000UL + 1) * 1000UL;
+	sd.update();
+}
+
+static bool exists(const char *path)
+{
+	return hostCard.files.count(path) > 0;
+}
+
+static const std::vector<uint8_t> &content(const char *path)
+{
+	return hostCard.files[path].data;
+}
+
+static std::string text(const char *path)
+{
+	const std::vector<uint8_t> &data = content(path);
+	return std::string(data.begin(), data.end());
+}
+
+#if SD_COMPRESSED
+//********************************************************************************************
+// function name: readLog ()
+// Function Description: Decodes the frames of a .BIN log sector by sector like
+// tools/sample_codec.py, a sector ends at padding, erased bytes or a frame that does not
+// check out
+//********************************************************************************************
+static std::vector<LogEntry> readLog(const std::vector<uint8_t> &data)
+{
+	std::vector<LogEntry> entries;
+	for (size_t sector = 0; sector < data.size(); sector += 512)
+	{
+		SampleCodec codec;
+		size_t pos = sector;
+		while (pos + 3 <= sector + 512 && pos < data.size())
+		{
+			uint8_t length = data[pos];
+			if (length == CODEC_PADDING || length == CODEC_ERASED || pos + length + 3 > sector + 512)
+				break;
+			uint16_t crc = crc16(&data[pos], length + 1);
+			if (crc != (data[pos + length + 1] | data[pos + length + 2] << 8))
+				break;
+			CodecSample sample;
+			if (!codec.decode(&data[pos + 1], length, sample))
+				break;
+			LogEntry entry = {sample.stamp, sample.value[0], (unsigned long)pos, (unsigned long)pos + length + 3};
+			entries.push_back(entry);
+			pos += length + 3;
+		}
+	}
+	return entries;
+}
+#else
+//********************************************************************************************
+// function name: readLog ()
+// Function Description: Parses the rows of a .CSV log behind its header, the log ends at the
+// first row without newline or whose CRC does not match
+//********************************************************************************************
+static std::vector<LogEntry> readLog(const std::vector<uint8_t> &data)
+{
+	std::vector<LogEntry> entries;
+	size_t pos = 0;
+	while (pos < data.size())
+	{
+		size_t end = pos;
+		while (end < data.size() && data[end] != '\n')
+			end++;
+		if (end == data.size())
+			break;
+		std::string row(data.begin() + pos, data.begin() + end);
+		if (row.compare(0, 5, "date,") != 0)
+		{
+			size_t comma = row.rfind(',');
+			if (comma == std::string::npos ||
+				strtoul(row.c_str() + comma + 1, NULL, 16) != crc16(row.c_str(), comma))
+				break;
+			unsigned int year, month, day, hour, minute, second;
+			float value;
+			if (sscanf(row.c_str(), "%u/%u/%u/%u/%u/%u,%f", &year, &month, &day, &hour, &minute, &second, &value) != 7)
+				break;
+			LogEntry entry = {GravityRtc::toEpoch(year, month, day, hour, minute, second), value, (unsigned long)pos,
+							  (unsigned long)end + 1};
+			entries.push_back(entry);
+		}
+		pos = end + 1;
+	}
+	return entries;
+}
+#endif
+
+static std::vector<LogEntry> readLog(const char *path)
+{
+	return readLog(content(path));
+}
+
+// the entries are the snapshots from first on, every ROW_INTERVAL
+static bool consecutive(const std::vector<LogEntry> &entries, unsigned long first, size_t count)
+{
+	if (entries.size() != count)
+		return false;
+	for (size_t i = 0; i < count; i++)
+	{
+		if (entries[i].time != first + i * ROW_INTERVAL || fabs(entries[i].value - (7 + i % 100 * 0.01f)) > 0.001f)
+			return false;
+	}
+	return true;
+}
+
+static void fill(SdService &sd, unsigned long first, size_t from, size_t to)
+{
+	for (size_t i = from; i < to; i++)
+		logAt(sd, first + i * ROW_INTERVAL, 7 + i % 100 * 0.01f);
+}
+
+static void newCard()
+{
+	hostCard.clear();
+	hostSnapshot.sequence = 0;
+}
+
+//********************************************************************************************
+// function name: noCard ()
+// Function Description: Without a card setup() gives up and update() writes nothing
+//********************************************************************************************
+static void noCard()
+{
+	newCard();
+	hostCard.present = false;
+	SdService sd(&hub);
+	sd.setup();
+	CHECK(sd.directory() == NULL);
+	logAt(sd, DAY_START, 7);
+	CHECK(hostCard.files.empty());
+}
+
+//********************************************************************************************
+// function name: createLog ()
+// Function Description: The first row creates the month directory and a contiguous, erased
+// log of SD_LOG_FILE_SIZE and lists it in the manifest
+//********************************************************************************************
+static void createLog()
+{
+	newCard();
+	SdService sd(&hub);
+	sd.setup();
+	CHECK(sd.directory() != NULL);
+	logAt(sd, DAY_START, 7);
+
+	const char *path = "2610/26101900" LOG_EXTENSION;
+	CHECK(exists("2610") && hostCard.files["2610"].directory);
+	CHECK(exists(path));
+	CHECK(content(path).size() == SD_LOG_FILE_SIZE);
+	CHECK(hostCard.files[path].firstBlock != 0);
+	// no stale bytes of the clusters are left behind the row
+	CHECK(content(path).back() == hostCard.erasedByte);
+	CHECK(consecutive(readLog(path), DAY_START, 1));
+	CHECK(text("LOGS.TXT") == "2610/26101900" LOG_EXTENSION ",OPEN,1792368000\r\n");
+}
+
+//********************************************************************************************
+// function name: resumeLog ()
+// Function Description: After a reset the open log of the day is continued behind its last
+// record, on cards that erase to 0x00 and to 0xFF
+//********************************************************************************************
+static void resumeLog()
+{
+	const uint8_t erased[] = {0xFF, 0x00};
+	for (uint8_t e = 0; e < 2; e++)
+	{
+		newCard();
+		hostCard.erasedByte = erased[e];
+		const char *path = "2610/26101900" LOG_EXTENSION;
+		{
+			SdService sd(&hub);
+			sd.setup();
+			fill(sd, DAY_START, 0, 30);
+		}
+		SdService sd(&hub);
+		sd.setup();
+		fill(sd, DAY_START, 30, 45);
+
+		CHECK(!exists("2610/26101901" LOG_EXTENSION));
+		CHECK(content(path).size() == SD_LOG_FILE_SIZE);
+		std::vector<LogEntry> entries = readLog(path);
+		CHECK(consecutive(entries, DAY_START, 45));
+		// the first record after the reset follows the last one before it
+		CHECK(entries.size() == 45 && entries[30].offset == entries[29].end);
+		CHECK(text("LOGS.TXT").find("CLOSED") == std::string::npos);
+	}
+}
+
+//********************************************************************************************
+// function name: rotateDay ()
+// Function Description: The first row of a new day closes the log, cut to its length, and
+// opens the log of the day, in the directory of a new month
+//********************************************************************************************
+static void rotateDay()
+{
+	newCard();
+	SdService sd(&hub);
+	sd.setup();
+	unsigned long first = DAY_START + 13 * 86400UL - 3 * ROW_INTERVAL; // 2026-10-31 23:58:30
+	fill(sd, first, 0, 6);
+
+	const char *closed = "2610/26103100" LOG_EXTENSION;
+	const char *opened = "2611/26110100" LOG_EXTENSION;
+	CHECK(exists(closed) && exists(opened));
+	std::vector<LogEntry> before = readLog(closed);
+	CHECK(consecutive(before, first, 3));
+	CHECK(!before.empty() && content(closed).size() < SD_LOG_FILE_SIZE);
+	CHECK(readLog(opened).size() == 3 && readLog(opened)[0].time == DAY_START + 13 * 86400UL);
+
+	char line[64];
+	snprintf(line, sizeof(line), "2610/26103100" LOG_EXTENSION ",CLOSED,%lu,%u\r\n", DAY_START + 13 * 86400UL,
+			 (unsigned int)content(closed).size());
+	CHECK(text("LOGS.TXT").find(line) != std::string::npos);
+}
+
+//********************************************************************************************
+// function name: rotatePart ()
+// Function Description: A full log is closed and the day goes on in the next part
+//********************************************************************************************
+static void rotatePart()
+{
+	newCard();
+	SdService sd(&hub);
+	sd.setup();
+	size_t count = 0;
+	while (!exists("2610/26101902" LOG_EXTENSION) && count < 10000)
+	{
+		fill(sd, DAY_START, count, count + 1);
+		count++;
+	}
+
+	std::vector<LogEntry> entries;
+	for (uint8_t part = 0; part < 3; part++)
+	{
+		char path[24];
+		snprintf(path, sizeof(path), "2610/261019%02u" LOG_EXTENSION, part);
+		std::vector<LogEntry> partEntries = readLog(path);
+		CHECK(!partEntries.empty());
+		CHECK(part == 2 ? content(path).size() == SD_LOG_FILE_SIZE : content(path).size() <= SD_LOG_FILE_SIZE);
+		entries.insert(entries.end(), partEntries.begin(), partEntries.end());
+	}
+	CHECK(consecutive(entries, DAY_START, count));
+}
+
+//********************************************************************************************
+// function name: closedLogNotResumed ()
+// Function Description: A card that cannot erase gets a log that grows with the rows. It is
+// not contiguous, so after a reset the rows go on in the next part.
+//********************************************************************************************
+static void closedLogNotResumed()
+{
+	newCard();
+	hostCard.eraseWorks = false;
+	{
+		SdService sd(&hub);
+		sd.setup();
+		fill(sd, DAY_START, 0, 10);
+	}
+	CHECK(content("2610/26101900" LOG_EXTENSION).size() < SD_LOG_FILE_SIZE);
+	SdService sd(&hub);
+	sd.setup();
+	fill(sd, DAY_START, 10, 15);
+
+	std::vector<LogEntry> entries = readLog("2610/26101900" LOG_EXTENSION);
+	std::vector<LogEntry> next = readLog("2610/26101901" LOG_EXTENSION);
+	entries.insert(entries.end(), next.begin(), next.end());
+	CHECK(consecutive(entries, DAY_START, 15));
+}
+
+//********************************************************************************************
+// function name: tear ()
+// Function Description: Damages a record like a reset in the middle of its write, or with a
+// flipped bit when corrupt is set
+//********************************************************************************************
+static void tear(const char *path, const LogEntry &entry, bool corrupt)
+{
+	std::vector<uint8_t> &data = hostCard.files[path].data;
+	if (corrupt)
+	{
+		data[entry.offset + 2] ^= 0x01;
+		return;
+	}
+#if SD_COMPRESSED
+	// the length made it to the card, the rest of the frame did not
+	for (unsigned long i = entry.offset + 1; i < entry.end; i++)
+#else
+	// the first half of the row made it to the card, its newline did not
+	for (unsigned long i = (entry.offset + entry.end) / 2; i < entry.end; i++)
+#endif
+		data[i] = hostCard.erasedByte;
+}
+
+// the newest record starts a sector, or for csv rows reaches into the next one
+static bool startsSector(const LogEntry &entry)
+{
+#if SD_COMPRESSED
+	return entry.offset > 0 && entry.offset % 512 == 0;
+#else
+	return entry.offset / 512 != (entry.end - 1) / 512;
+#endif
+}
+
+//********************************************************************************************
+// function name: tornTail ()
+// Function Description: A torn or corrupt last record is dropped after a reset, the next
+// record is written in its place and the records before it are kept. Both happen in the
+// middle of a sector and where the last record starts a sector, so the tail scan has to
+// look at the sector before it.
+//********************************************************************************************
+static void tornTail()
+{
+	const char *path = "2610/26101900" LOG_EXTENSION;
+	for (uint8_t kind = 0; kind < 4; kind++)
+	{
+		newCard();
+		size_t count = 40;
+		std::vector<LogEntry> before;
+		{
+			SdService sd(&hub);
+			sd.setup();
+			fill(sd, DAY_START, 0, count);
+			before = readLog(path);
+			while (kind >= 2 && !startsSector(before.back()) && count < 200)
+			{
+				fill(sd, DAY_START, count, count + 1);
+				count++;
+				before = readLog(path);
+			}
+		}
+		CHECK(consecutive(before, DAY_START, count));
+		CHECK(kind < 2 || startsSector(before.back()));
+		tear(path, before.back(), kind % 2 == 1);
+
+		SdService sd(&hub);
+		sd.setup();
+		fill(sd, DAY_START, count, count + 5);
+
+		std::vector<LogEntry> after = readLog(path);
+		CHECK(after.size() == count + 4);
+		if (after.size() != count + 4)
+			continue;
+		CHECK(consecutive(std::vector<LogEntry>(after.begin(), after.begin() + count - 1), DAY_START, count - 1));
+		CHECK(after[count - 1].offset == before.back().offset);
+		CHECK(after[count - 1].time == DAY_START + count * ROW_INTERVAL);
+		CHECK(!exists("2610/26101901" LOG_EXTENSION));
+	}
+}
+
+//********************************************************************************************
+// function name: erasedTail ()
+// Function Description: A log that only holds its header, or nothing, is resumed at its start
+//********************************************************************************************
+static void erasedTail()
+{
+	const char *path = "2610/26101900" LOG_EXTENSION;
+	newCard();
+	{
+		SdService sd(&hub);
+		sd.setup();
+		fill(sd, DAY_START, 0, 1);
+	}
+	std::vector<LogEntry> first = readLog(path);
+	CHECK(first.size() == 1);
+	tear(path, first[0], false);
+
+	SdService sd(&hub);
+	sd.setup();
+	fill(sd, DAY_START, 1, 3);
+	std::vector<LogEntry> after = readLog(path);
+	CHECK(after.size() == 2 && after[0].offset == first[0].offset);
+	CHECK(after.size() == 2 && after[0].time == DAY_START + ROW_INTERVAL);
+}
+
+//********************************************************************************************
+// function name: streamRange ()
+// Function Description: Runs a RANGE to its end, one update() and telemetry pass at a time,
+// and collects the times of the REC frames, the count of RANGEEND and the passes it took
+//********************************************************************************************
+static std::vector<unsigned long> streamRange(SdService &sd, unsigned long from, unsigned long to, long &count,
+											  unsigned int &passes)
+{
+	std::vector<unsigned long> times;
+	std::string output;
+	count = -1;
+	sd.range(from, to);
+	for (passes = 0; sd.ranging() && passes < 5000; passes++)
+	{
+		sd.update();
+		output += hostTelemetry();
+	}
+	for (size_t line = 0; line < output.size();)
+	{
+		size_t end = output.find('\n', line);
+		if (end == std::string::npos)
+			end = output.size();
+		unsigned long time;
+		if (sscanf(output.c_str() + line, "REC@%lu,", &time) == 1)
+			times.push_back(time);
+		sscanf(output.c_str() + line, "RANGEEND@%ld", &count);
+		line = end + 1;
+	}
+	return times;
+}
+
+//********************************************************************************************
+// function name: range ()
+// Function Description: RANGE streams the records of the logs in order, across days and
+// months without logs. From epoch 0 it skips the empty months a directory at a time, so the
+// decades before the first log take a few passes instead of one per day.
+//********************************************************************************************
+static void range()
+{
+	const unsigned long august = DAY_START - 66 * 86400UL; // 2026-08-14 00:00:00
+	newCard();
+	SdService sd(&hub);
+	sd.setup();
+	fill(sd, august, 0, 5);
+	fill(sd, DAY_START, 5, 25);
+
+	long count;
+	unsigned int passes;
+	std::vector<unsigned long> times = streamRange(sd, 0, 0xFFFFFFFFUL, count, passes);
+	CHECK(count == 25 && times.size() == 25);
+	CHECK(times.size() == 25 && times[0] == august && times[4] == august + 4 * ROW_INTERVAL);
+	CHECK(times.size() == 25 && times[5] == DAY_START + 5 * ROW_INTERVAL && times[24] == DAY_START + 24 * ROW_INTERVAL);
+	// 682 months since 1970, 66 days since the first log, 25 records
+	CHECK(passes < 100);
+
+	times = streamRange(sd, DAY_START + 10 * ROW_INTERVAL, DAY_START + 14 * ROW_INTERVAL, count, passes);
+	CHECK(count == 5 && times.size() == 5);
+	CHECK(times.size() == 5 && times[0] == DAY_START + 10 * ROW_INTERVAL && times[4] == DAY_START + 14 * ROW_INTERVAL);
+
+	// September has no directory
+	times = streamRange(sd, august + 86400UL, DAY_START - 1, count, passes);
+	CHECK(count == 0 && times.empty());
+}
+
+int main()
+{
+	calibrationStore.setup();
+
+	noCard();
+	createLog();
+	resumeLog();
+	rotateDay();
+	rotatePart();
+	closedLogNotResumed();
+	tornTail();
+	erasedTail();
+	range();
+
+	if (failures > 0)
+	{
+		printf("%d checks failed\n", failures);
+		return 1;
+	}
+	printf("all checks passed\n");
+	return 0;
+}
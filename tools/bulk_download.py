@@ -0,0 +1,222 @@
+#!/usr/bin/env python3
+"""Download files from the SD card of the node over its serial link with
+the BULK command (BulkTransfer.h) and report the throughput.
+
+    python3 tools/bulk_download.py /dev/ttyUSB0                 # LOGS.TXT and every log in it
+    python3 tools/bulk_download.py /dev/ttyUSB0 2609/26092200.BIN --out logs
+
+A file that is already partly on disk is continued from its size, so an
+interrupted download is resumed by running the same command again. Needs
+pyserial (pip install pyserial).
+"""
+
+import argparse
+import base64
+import os
+import sys
+import time
+
+import serial
+
+# defaults of SERIAL_BAUD and BULK_TIMEOUT in config.h
+SERIAL_BAUD = 9600
+BULK_TIMEOUT = 5.0
+
+ANNOUNCE_TIMEOUT = 3.0  # seconds to wait for BULK@
+NUDGE_TIME = 0.5  # seconds without a block before BACK is sent again
+LINK_TIMEOUT = BULK_TIMEOUT + 1.0  # seconds without a block before the node is given up
+
+
+def crc16(data, crc=0xFFFF):
+    """CRC-16/CCITT-FALSE, as Crc.h"""
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else crc << 1
+            crc &= 0xFFFF
+    return crc
+
+
+class LinkLost(Exception):
+    pass
+
+
+class Session:
+    """the serial link, at SERIAL_BAUD until the first file switches it"""
+
+    def __init__(self, port, baud):
+        self.link = serial.Serial(port, baud, timeout=0.1)
+        self.baud = baud
+        self.fast = False
+        self.buffer = b""
+
+    def command(self, text):
+        self.link.write(text.encode("ascii") + b"\n")
+
+    def line(self):
+        """next line, None when nothing complete arrived within the read timeout"""
+        while b"\n" not in self.buffer:
+            data = self.link.read(self.link.in_waiting or 1)
+            if not data:
+                return None
+            self.buffer += data
+        line, self.buffer = self.buffer.split(b"\n", 1)
+        return line.strip().decode("ascii", "replace")
+
+    def announce(self, name, offset):
+        """BULK@name,size,offset,baud, switches to the announced rate"""
+        self.command("BULK %s %d" % (name, offset))
+        deadline = time.time() + ANNOUNCE_TIMEOUT
+        while time.time() < deadline:
+            line = self.line()
+            if line is None:
+                continue
+            if line.startswith("BULKERR@"):
+                raise FileNotFoundError(name)
+            if line.startswith("BULK@"):
+                _, size, start, baud = line[5:].split(",")
+                if not self.fast:
+                    self.link.flush()
+                    self.link.baudrate = int(baud)
+                    self.buffer = b""
+                    self.fast = True
+                return int(size), int(start)
+        raise LinkLost("no answer to BULK")
+
+    def reset(self):
+        """wait until the node gave the link back and start over at SERIAL_BAUD"""
+        time.sleep(LINK_TIMEOUT)
+        self.link.baudrate = self.baud
+        self.link.reset_input_buffer()
+        self.buffer = b""
+        self.fast = False
+
+    def close(self):
+        if self.fast:
+            self.command("BULK")
+            self.link.flush()
+        self.link.close()
+
+
+def receive(session, name, path, restart):
+    """download one file, returns the bytes received"""
+    offset = 0 if restart or not os.path.exists(path) else os.path.getsize(path)
+    size, acked = session.announce(name, offset)
+    received = 0
+    with open(path, "r+b" if os.path.exists(path) else "wb") as output:
+        output.truncate(acked)
+        output.seek(acked)
+        pending = {}  # blocks that arrived ahead of a gap
+        rejected = set()
+        heard = time.time()
+        nudged = 0
+        session.command("BACK %d" % acked)
+        while True:
+            line = session.line()
+            now = time.time()
+            if line is None:
+                if now - heard > LINK_TIMEOUT:
+                    raise LinkLost("%s stopped at %d of %d" % (name, acked, size))
+                if now - nudged > NUDGE_TIME:
+                    session.command("BACK %d" % acked)
+                    nudged = now
+                continue
+            if line.startswith("BULKEND@"):
+                return received
+            if not line.startswith("BLK@"):
+                continue  # reports and other frames go on during a download
+            heard = now
+            try:
+                offset, text, crc = line[4:].split(",")
+                offset = int(offset)
+                block = base64.b64decode(text + "=" * (-len(text) % 4))
+                valid = crc16(block) == int(crc, 16)
+            except ValueError:
+                continue
+            if not valid:
+                session.command("BNAK %d" % offset)
+                continue
+            if offset > acked:
+                pending[offset] = block
+                if acked not in rejected:
+                    session.command("BNAK %d" % acked)
+                    rejected.add(acked)
+                continue
+            if offset + len(block) <= acked:
+                continue  # a duplicate
+            pending[offset] = block
+            while acked in pending:
+                block = pending.pop(acked)
+                output.write(block)
+                acked += len(block)
+                received += len(block)
+            output.flush()
+            rejected = {r for r in rejected if r >= acked}
+            session.command("BACK %d" % acked)
+
+
+def log_names(path):
+    """logs listed in LOGS.TXT, oldest first"""
+    names = []
+    with open(path) as manifest:
+        for line in manifest:
+            name = line.split(",")[0].strip()
+            if name and name not in names:
+                names.append(name)
+                names.append(name[:-3] + "IDX")
+    return names
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("port", help="serial port of the node")
+    parser.add_argument("names", nargs="*", help="files to download, LOGS.TXT and the logs in it by default")
+    parser.add_argument("--out", default=".", help="directory for the files")
+    parser.add_argument("--baud", type=int, default=SERIAL_BAUD, help="SERIAL_BAUD of the node")
+    parser.add_argument("--retries", type=int, default=5, help="reconnects per file after the link was lost")
+    parser.add_argument("--restart", action="store_true", help="download from the start instead of resuming")
+    args = parser.parse_args()
+
+    os.makedirs(args.out, exist_ok=True)
+    session = Session(args.port, args.baud)
+    names = list(args.names)
+    if not names:
+        # the manifest grows, it is fetched whole every time
+        names = ["LOGS.TXT"]
+    total = 0
+    started = time.time()
+    try:
+        while names:
+            name = names.pop(0)
+            path = os.path.join(args.out, *name.split("/"))
+            os.makedirs(os.path.dirname(path), exist_ok=True)
+            began = time.time()
+            for attempt in range(args.retries + 1):
+                try:
+                    received = receive(session, name, path, args.restart or name == "LOGS.TXT")
+                    break
+                except LinkLost as error:
+                    print("%s, reconnecting" % error, file=sys.stderr)
+                    session.reset()
+                except FileNotFoundError:
+                    print("%s: not on the card" % name, file=sys.stderr)
+                    received = None
+                    break
+            else:
+                print("%s: giving up" % name, file=sys.stderr)
+                continue
+            if received is None:
+                continue
+            elapsed = max(time.time() - began, 1e-3)
+            total += received
+            print("%s: %d bytes in %.1f s, %.0f bytes/s" % (name, received, elapsed, received / elapsed))
+            if name == "LOGS.TXT" and not args.names:
+                names = log_names(path)
+    finally:
+        session.close()
+    elapsed = max(time.time() - started, 1e-3)
+    print("total: %d bytes in %.1f s, %.0f bytes/s" % (total, elapsed, total / elapsed))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,219 @@
+#!/usr/bin/env python3
+"""Generate ConductivityTables.h, the PROGMEM lookup tables used by GravityEc
+and GravityTDS and the temperature compensation tables published by
+GravityTemperature, and report the worst-case error of the table lookup against
+the floating point formulas the drivers used before.
+
+    python3 tools/gen_conductivity_tables.py            # rewrite ConductivityTables.h
+    python3 tools/gen_conductivity_tables.py --check    # only print the error report
+"""
+
+import argparse
+import os
+
+ADC_RANGE = 1024
+AREF_MV = 5000.0
+
+# conductivity curves are tabulated every 2^CODE_STEP_SHIFT ADC codes
+CODE_STEP_SHIFT = 4
+CODE_ENTRIES = (ADC_RANGE >> CODE_STEP_SHIFT) + 1
+
+# temperature compensation is tabulated every 1 C from TEMP_MIN to TEMP_MAX,
+# the drivers interpolate in 1/16 C steps (DS18B20 resolution)
+TEMP_MIN = 0
+TEMP_MAX = 50
+TEMP_FRAC_SHIFT = 4
+
+# compensation factors are stored as Q14 reciprocals of (1 + k * (T - 25))
+COMP_SHIFT = 14
+
+EC_COEFFICIENT = 0.0185
+TDS_COEFFICIENT = 0.02
+# the Nernst slope of the pH probe is proportional to absolute temperature:
+# 298.15 / (T + 273.15) = 1 / (1 + (T - 25) / 298.15)
+NERNST_COEFFICIENT = 1 / 298.15
+
+EC_MIN_MV = 150
+EC_MAX_MV = 3300
+
+
+def ec_curve(mv):
+    """GravityEc piecewise curve, us/cm at 25 C, without range clamping"""
+    if mv <= 448:
+        return 6.84 * mv - 64.32
+    if mv <= 1457:
+        return 6.98 * mv - 127
+    return 5.3 * mv + 2278
+
+
+def tds_curve(code):
+    """GravityTDS cubic, us/cm before temperature compensation and k value"""
+    v = code / ADC_RANGE * AREF_MV / 1000.0
+    return 133.42 * v * v * v - 255.86 * v * v + 857.39 * v
+
+
+def clamp16(value):
+    return max(0, min(0xFFFF, int(round(value))))
+
+
+def ec_table():
+    return [clamp16(max(0.0, ec_curve((i << CODE_STEP_SHIFT) * AREF_MV / ADC_RANGE)))
+            for i in range(CODE_ENTRIES)]
+
+
+def tds_table():
+    return [clamp16(tds_curve(i << CODE_STEP_SHIFT)) for i in range(CODE_ENTRIES)]
+
+
+def comp_table(k):
+    return [clamp16((1 << COMP_SHIFT) / (1.0 + k * (t - 25.0)))
+            for t in range(TEMP_MIN, TEMP_MAX + 1)]
+
+
+# --- integer model of LookupTable.h -------------------------------------------
+
+def lookup(table, x, shift):
+    index = x >> shift
+    if index >= len(table) - 1:
+        return table[-1]
+    a = table[index]
+    b = table[index + 1]
+    frac = x & ((1 << shift) - 1)
+    return a + (((b - a) * frac) >> shift)
+
+
+def compensation(table, temperature):
+    t = int(temperature * (1 << TEMP_FRAC_SHIFT)) - (TEMP_MIN << TEMP_FRAC_SHIFT)
+    t = max(0, t)
+    return lookup(table, t, TEMP_FRAC_SHIFT)
+
+
+def ec_min_input():
+    return int(EC_MIN_MV * ADC_RANGE / AREF_MV * (1 << COMP_SHIFT))
+
+
+def ec_max_input():
+    return int(EC_MAX_MV * ADC_RANGE / AREF_MV * (1 << COMP_SHIFT))
+
+
+def ec_lut(code, temperature, ecs, comps):
+    """GravityEc::calculateEc() with tables, us/cm, None when out of range"""
+    x = code * compensation(comps, temperature)
+    if x < ec_min_input() or x > ec_max_input():
+        return None
+    return lookup(ecs, x, CODE_STEP_SHIFT + COMP_SHIFT)
+
+
+def ec_float(code, temperature):
+    """GravityEc::calculateEc() before the tables, us/cm, None when out of range"""
+    average_mv = int(code * AREF_MV / ADC_RANGE)
+    mv = average_mv / (1.0 + EC_COEFFICIENT * (temperature - 25.0))
+    if mv < EC_MIN_MV or mv > EC_MAX_MV:
+        return None
+    return ec_curve(mv)
+
+
+def tds_lut(code, temperature, tdss, comps):
+    """GravityTDS::update() with tables, ppm for k = 1"""
+    ec25 = (lookup(tdss, code, CODE_STEP_SHIFT) * compensation(comps, temperature)) >> COMP_SHIFT
+    return ec25 * 0.5
+
+
+def tds_float(code, temperature):
+    """GravityTDS::update() before the tables, ppm for k = 1"""
+    return tds_curve(code) / (1.0 + TDS_COEFFICIENT * (temperature - 25.0)) * 0.5
+
+
+def report(ecs, tdss, ec_comps, tds_comps):
+    temperatures = [TEMP_MIN + i / 16.0 for i in range((TEMP_MAX - TEMP_MIN) * 16 + 1)]
+    ec_err = (0.0, 0, 0.0)
+    ec_edge = 0
+    tds_err = (0.0, 0, 0.0)
+    for code in range(ADC_RANGE):
+        for t in temperatures:
+            ref = ec_float(code, t)
+            got = ec_lut(code, t, ecs, ec_comps)
+            if (ref is None) != (got is None):
+                ec_edge += 1
+            elif ref is not None and abs(got - ref) > ec_err[0]:
+                ec_err = (abs(got - ref), code, t)
+            ref = tds_float(code, t)
+            err = abs(tds_lut(code, t, tdss, tds_comps) - ref)
+            if err > tds_err[0]:
+                tds_err = (err, code, t)
+    print("EC : max error %.4f ms/cm (code %d, %.4f C), %d range decisions differ at the 150/3300 mV edges"
+          % (ec_err[0] / 1000.0, ec_err[1], ec_err[2], ec_edge))
+    print("TDS: max error %.3f ppm (code %d, %.4f C)" % tds_err)
+
+
+def c_array(name, values, comment):
+    lines = ["// %s" % comment, "static const uint16_t %s[] PROGMEM = {" % name]
+    for i in range(0, len(values), 10):
+        lines.append("\t" + ", ".join("%d" % v for v in values[i:i + 10]) + ",")
+    lines.append("};")
+    return "\n".join(lines)
+
+
+def header(ecs, tdss, ec_comps, tds_comps, nernst_comps):
+    parts = [
+        "/*********************************************************************",
+        "* ConductivityTables.h",
+        "*",
+        "* Description: Lookup tables for GravityEc and GravityTDS and the",
+        "* temperature compensation tables used by GravityTemperature.",
+        "* Generated by tools/gen_conductivity_tables.py, do not edit.",
+        "**********************************************************************/",
+        "",
+        "#pragma once",
+        "#include <Arduino.h>",
+        "#include <avr/pgmspace.h>",
+        "",
+        "// curves are indexed by ADC code in steps of 2^CONDUCTIVITY_CODE_STEP_SHIFT",
+        "#define CONDUCTIVITY_CODE_STEP_SHIFT %d" % CODE_STEP_SHIFT,
+        "#define CONDUCTIVITY_CODE_ENTRIES %d" % CODE_ENTRIES,
+        "",
+        "// compensation tables start at TEMP_COMP_MIN C, one entry per C, Q%d reciprocals" % COMP_SHIFT,
+        "#define TEMP_COMP_MIN %d" % TEMP_MIN,
+        "#define TEMP_COMP_ENTRIES %d" % (TEMP_MAX - TEMP_MIN + 1),
+        "#define TEMP_COMP_FRAC_SHIFT %d" % TEMP_FRAC_SHIFT,
+        "#define TEMP_COMP_SHIFT %d" % COMP_SHIFT,
+        "",
+        "// valid EC input range (150 mV .. 3300 mV) as compensated ADC code in Q%d" % COMP_SHIFT,
+        "#define EC_LUT_MIN_INPUT %dUL" % ec_min_input(),
+        "#define EC_LUT_MAX_INPUT %dUL" % ec_max_input(),
+        "",
+        c_array("ecCurveTable", ecs, "EC in us/cm at 25 C by ADC code"),
+        "",
+        c_array("tdsCurveTable", tdss, "EC in us/cm before compensation and k value by ADC code"),
+        "",
+        c_array("ecCompensationTable", ec_comps, "1 / (1 + %s * (T - 25)) by temperature" % EC_COEFFICIENT),
+        "",
+        c_array("tdsCompensationTable", tds_comps, "1 / (1 + %s * (T - 25)) by temperature" % TDS_COEFFICIENT),
+        "",
+        c_array("nernstCompensationTable", nernst_comps, "298.15 / (T + 273.15) by temperature"),
+        "",
+    ]
+    return "\r\n".join(parts).replace("\n", "\r\n").replace("\r\r\n", "\r\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--check", action="store_true", help="only print the error report")
+    parser.add_argument("--output", default=os.path.join(os.path.dirname(__file__), "..", "ConductivityTables.h"))
+    args = parser.parse_args()
+
+    ecs = ec_table()
+    tdss = tds_table()
+    ec_comps = comp_table(EC_COEFFICIENT)
+    tds_comps = comp_table(TDS_COEFFICIENT)
+    nernst_comps = comp_table(NERNST_COEFFICIENT)
+
+    if not args.check:
+        with open(args.output, "w", newline="") as f:
+            f.write(header(ecs, tdss, ec_comps, tds_comps, nernst_comps))
+        print("wrote %s" % os.path.normpath(args.output))
+    report(ecs, tdss, ec_comps, tds_comps)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,96 @@
+#!/usr/bin/env python3
+"""Extract the raw block log (RawLog.h, SD_RAW_LOG) from a card image or a
+card device and print it in the csv layout of SdService.
+
+    sudo dd if=/dev/sdX of=card.img bs=512 count=2048
+    python3 tools/raw_extract.py card.img > sensor.csv
+    python3 tools/raw_extract.py /dev/sdX --first 1 --blocks 8191 --levels
+"""
+
+import argparse
+import struct
+import sys
+import time
+
+BLOCK_SIZE = 512
+MAGIC = 0x5752
+VERSION = 1
+RECORDS = 16
+CHANNELS = 5
+
+# must match RawSector and RawRecord in RawLog.h (packed, little endian)
+HEADER = struct.Struct("<HBBI")
+RECORD = struct.Struct("<I5f5BB")
+CRC_OFFSET = BLOCK_SIZE - 2
+
+# defaults of SD_RAW_FIRST_BLOCK and SD_RAW_BLOCKS in config.h
+FIRST_BLOCK = 1
+BLOCKS = 2047
+
+
+def crc16(data, crc=0xFFFF):
+    """CRC-16/CCITT-FALSE, as Crc.h"""
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else crc << 1
+            crc &= 0xFFFF
+    return crc
+
+
+def read_sectors(image, first, blocks):
+    """(sequence, records) of every valid block of the region"""
+    image.seek(first * BLOCK_SIZE)
+    for index in range(blocks):
+        block = image.read(BLOCK_SIZE)
+        if len(block) < BLOCK_SIZE:
+            print("image ends at block %d of the region" % index, file=sys.stderr)
+            break
+        magic, version, count, sequence = HEADER.unpack_from(block)
+        if magic != MAGIC or version != VERSION or count > RECORDS:
+            continue
+        (crc,) = struct.unpack_from("<H", block, CRC_OFFSET)
+        if crc16(block[:CRC_OFFSET]) != crc:
+            print("block %d: crc error" % index, file=sys.stderr)
+            continue
+        records = [RECORD.unpack_from(block, HEADER.size + i * RECORD.size) for i in range(count)]
+        yield sequence, records
+
+
+def csv_row(record, levels):
+    """date,pH,temp(C),DO(mg/l),ec(s/m),orp(mv),flags as SdService writes it"""
+    epoch = record[0]
+    values = record[1:1 + CHANNELS]
+    flags = record[1 + CHANNELS:1 + 2 * CHANNELS]
+    t = time.gmtime(epoch)
+    date = "%d/%d/%d/%d/%d/%d" % (t.tm_year, t.tm_mon, t.tm_mday, t.tm_hour, t.tm_min, t.tm_sec)
+    row = [date] + ["%.10f" % v for v in values] + ["/".join("%x" % f for f in flags)]
+    if levels:
+        row.append(str(record[-1]))
+    return ",".join(row)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("image", help="card image or block device")
+    parser.add_argument("--first", type=int, default=FIRST_BLOCK, help="SD_RAW_FIRST_BLOCK")
+    parser.add_argument("--blocks", type=int, default=BLOCKS, help="SD_RAW_BLOCKS")
+    parser.add_argument("--levels", action="store_true", help="add the water level bits as last column")
+    args = parser.parse_args()
+
+    with open(args.image, "rb") as image:
+        sectors = sorted(read_sectors(image, args.first, args.blocks))
+
+    header = "date,pH,temp(C),DO(mg/l),ec(s/m),orp(mv),flags"
+    print(header + (",levels" if args.levels else ""))
+    previous = None
+    for sequence, records in sectors:
+        if previous is not None and sequence != previous + 1:
+            print("blocks %d to %d are missing" % (previous + 1, sequence - 1), file=sys.stderr)
+        previous = sequence
+        for record in records:
+            print(csv_row(record, args.levels))
+
+
+if __name__ == "__main__":
+    main()
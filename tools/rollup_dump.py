@@ -0,0 +1,60 @@
+#!/usr/bin/env python3
+"""Print the rollup files of RollupLog.h (.M01, .M15, .H01) as csv, one row
+per period with count, min, max and mean of every channel.
+
+    python3 tools/rollup_dump.py logs/2609/2609.M15 > 2609_15min.csv
+    python3 tools/rollup_dump.py logs/*.H01 > hourly.csv
+"""
+
+import argparse
+import struct
+import sys
+import time
+
+CHANNELS = ("pH", "temp(C)", "DO(mg/l)", "ec(s/m)", "orp(mv)")
+
+# must match RollupRecord and RollupChannel in RollupLog.h (packed, little endian)
+HEADER = struct.Struct("<IB")
+CHANNEL = struct.Struct("<Hfff")
+RECORD_SIZE = HEADER.size + len(CHANNELS) * CHANNEL.size
+
+
+def read_records(path):
+    """(epoch, flags, [(count, min, max, mean)] per channel) of every record"""
+    with open(path, "rb") as rollup:
+        data = rollup.read()
+    if len(data) % RECORD_SIZE:
+        print("%s: %d bytes of a torn record at the end" % (path, len(data) % RECORD_SIZE), file=sys.stderr)
+    for offset in range(0, len(data) - RECORD_SIZE + 1, RECORD_SIZE):
+        epoch, flags = HEADER.unpack_from(data, offset)
+        channels = [CHANNEL.unpack_from(data, offset + HEADER.size + i * CHANNEL.size) for i in range(len(CHANNELS))]
+        yield epoch, flags, channels
+
+
+def csv_row(epoch, flags, channels):
+    t = time.gmtime(epoch)
+    row = ["%d/%d/%d/%d/%d/%d" % (t.tm_year, t.tm_mon, t.tm_mday, t.tm_hour, t.tm_min, t.tm_sec), "%x" % flags]
+    for count, minimum, maximum, mean in channels:
+        if count:
+            row += [str(count), "%.3f" % minimum, "%.3f" % maximum, "%.3f" % mean]
+        else:
+            row += ["0", "", "", ""]
+    return ",".join(row)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("files", nargs="+", help="rollup files of one tier, in time order")
+    args = parser.parse_args()
+
+    header = ["date", "flags"]
+    for name in CHANNELS:
+        header += [name + " count", name + " min", name + " max", name + " mean"]
+    print(",".join(header))
+    for path in args.files:
+        for record in read_records(path):
+            print(csv_row(*record))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,202 @@
+#!/usr/bin/env python3
+"""Decode SampleCodec records (SampleCodec.h): the daily .BIN logs written by
+SdService with SD_COMPRESSED and the Z@ report frames sent after COMPACT 1.
+
+    python3 tools/sample_codec.py 26101900.BIN > sensor.csv  # SD log to csv
+    python3 tools/sample_codec.py --frames serial.log        # Z@ frames to csv
+    python3 tools/sample_codec.py --stats SENSOR.BIN         # size against csv rows
+"""
+
+import argparse
+import base64
+import sys
+import time
+
+CHANNELS = ("pH", "temp(C)", "TDS(ppm)", "ec(ms/cm)", "orp(mv)")
+# must match codecScale in SampleCodec.cpp
+SCALE = (1000, 16, 1, 1000, 1)
+
+KEYFRAME = 0x80
+PADDING = (0x00, 0xFF)
+FLAGS = 0x40
+AUX = 0x20
+SECTOR_SIZE = 512
+# SdService frame around a record: length, record, CRC16 (little endian)
+FRAME_OVERHEAD = 3
+
+
+class DecodeError(Exception):
+    pass
+
+
+def read_varint(data, pos):
+    """zigzag coded signed varint, returns (value, next position)"""
+    value = 0
+    shift = 0
+    while True:
+        if pos >= len(data):
+            raise DecodeError("truncated varint")
+        byte = data[pos]
+        pos += 1
+        value |= (byte & 0x7F) << shift
+        if not byte & 0x80:
+            break
+        shift += 7
+    return (value >> 1) ^ -(value & 1), pos
+
+
+class Decoder:
+    """Keeps the state of one delta chain, like SampleCodec on the node"""
+
+    def __init__(self):
+        self.synced = False
+        self.stamp = 0
+        self.value = [0] * len(CHANNELS)
+        self.flags = [0] * len(CHANNELS)
+        self.aux = 0
+
+    def record(self, data, pos):
+        """decode one record at pos, returns (sample or None, next position),
+        padding ends the sector"""
+        header = data[pos]
+        pos += 1
+        if header in PADDING:
+            return None, len(data)
+        if header == KEYFRAME:
+            self.stamp, pos = read_varint(data, pos)
+            for i in range(len(CHANNELS)):
+                self.value[i], pos = read_varint(data, pos)
+            self.flags = list(data[pos:pos + len(CHANNELS)])
+            pos += len(CHANNELS)
+            self.aux = data[pos]
+            pos += 1
+            self.synced = True
+        elif header & KEYFRAME:
+            raise DecodeError("bad header 0x%02X" % header)
+        else:
+            delta, pos = read_varint(data, pos)
+            self.stamp = (self.stamp + delta) & 0xFFFFFFFF
+            for i in range(len(CHANNELS)):
+                if header & (1 << i):
+                    delta, pos = read_varint(data, pos)
+                    self.value[i] += delta
+            if header & FLAGS:
+                self.flags = list(data[pos:pos + len(CHANNELS)])
+                pos += len(CHANNELS)
+            if header & AUX:
+                self.aux = data[pos]
+                pos += 1
+        if pos > len(data):
+            raise DecodeError("truncated record")
+        if not self.synced:
+            return None, pos  # a delta before the first keyframe has nothing to apply to
+        return self.sample(), pos
+
+    def sample(self):
+        return {
+            "stamp": self.stamp,
+            "value": [v / s for v, s in zip(self.value, SCALE)],
+            "flags": list(self.flags),
+            "aux": self.aux,
+        }
+
+
+def crc16(data, crc=0xFFFF):
+    """CRC-16/CCITT-FALSE, as Crc.h"""
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else crc << 1
+            crc &= 0xFFFF
+    return crc
+
+
+def decode_log(data):
+    """every sample of a .BIN log, a sector ends at padding or at the first
+    frame whose CRC does not match"""
+    for start in range(0, len(data), SECTOR_SIZE):
+        sector = data[start:start + SECTOR_SIZE]
+        decoder = Decoder()
+        pos = 0
+        while pos < len(sector):
+            length = sector[pos]
+            if length in PADDING:
+                break
+            frame = sector[pos:pos + length + FRAME_OVERHEAD]
+            if len(frame) < length + FRAME_OVERHEAD or \
+                    crc16(frame[:-2]) != frame[-2] | frame[-1] << 8:
+                print("sector %d: bad frame at %d" % (start // SECTOR_SIZE, pos), file=sys.stderr)
+                break
+            try:
+                sample, _ = decoder.record(frame[1:-2], 0)
+            except DecodeError as error:
+                print("sector %d: %s" % (start // SECTOR_SIZE, error), file=sys.stderr)
+                break
+            if sample:
+                yield sample
+            pos += len(frame)
+
+
+def decode_frames(lines):
+    """every sample of the Z@n,<base64> frames in a serial log, deltas after a
+    lost frame are dropped until the next keyframe"""
+    decoder = Decoder()
+    expected = None
+    for line in lines:
+        line = line.strip()
+        if not line.startswith("Z@"):
+            continue
+        sequence, _, payload = line[2:].partition(",")
+        sequence = int(sequence)
+        data = base64.b64decode(payload + "=" * (-len(payload) % 4))
+        if data and data[0] != KEYFRAME and sequence != expected:
+            decoder.synced = False
+        expected = sequence + 1
+        try:
+            sample, _ = decoder.record(data, 0)
+        except DecodeError as error:
+            print("frame %d: %s" % (sequence, error), file=sys.stderr)
+            decoder.synced = False
+            continue
+        if sample:
+            yield sample
+
+
+def csv_row(sample, stamp_is_epoch):
+    stamp = sample["stamp"]
+    if stamp_is_epoch:
+        stamp = time.strftime("%Y/%m/%d/%H/%M/%S", time.gmtime(stamp))
+    values = ["%g" % v for v in sample["value"]]
+    flags = "/".join("%X" % f for f in sample["flags"])
+    return ",".join([str(stamp)] + values + [flags, str(sample["aux"])])
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("input", help="SENSOR.BIN, or a serial log with --frames")
+    parser.add_argument("--frames", action="store_true", help="decode Z@ frames from a text log")
+    parser.add_argument("--stats", action="store_true", help="compare the size with the csv rows")
+    args = parser.parse_args()
+
+    if args.frames:
+        with open(args.input) as log:
+            samples = list(decode_frames(log))
+    else:
+        with open(args.input, "rb") as log:
+            samples = list(decode_log(log.read()))
+
+    header = ",".join(["sequence" if args.frames else "date"] + list(CHANNELS) + ["flags", "levels"])
+    rows = [csv_row(s, not args.frames) for s in samples]
+    if args.stats:
+        encoded = len(open(args.input, "rb").read())
+        text = sum(len(r) + 1 for r in rows)
+        print("%d samples, %d bytes encoded, %d bytes as csv, %.1fx" %
+              (len(rows), encoded, text, text / max(encoded, 1)))
+        return
+    print(header)
+    for row in rows:
+        print(row)
+
+
+if __name__ == "__main__":
+    main()